@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <crlib/memory.h>
+
+CR_NAMESPACE_BEGIN
+
+// chunked bump allocator, individual allocations are never freed, instead whole arena is rewound
+// to a previously taken mark (or reset), so scratch data dies in O(1) regardless of its size
+class Arena final : public NonCopyable {
+private:
+   struct Chunk {
+      Chunk *next;
+      size_t size;
+   };
+
+public:
+   // position in the arena, that can be rewound to later
+   struct Mark {
+      Chunk *chunk {};
+      size_t used {};
+   };
+
+private:
+   static constexpr size_t kDefaultChunkSize = 64 * 1024;
+   static constexpr size_t kHeaderSize = (sizeof (Chunk) + alignof (max_align_t) - 1) & ~(alignof (max_align_t) - 1);
+
+private:
+   Chunk *chunks_ {}; // chunks in use, newest first
+   Chunk *spare_ {}; // chunks left over after rewind, reused before going to the heap
+   size_t used_ {}; // bytes used in the newest chunk
+   size_t chunkSize_ {};
+
+public:
+   explicit Arena (const size_t chunkSize = kDefaultChunkSize) : chunkSize_ (chunkSize) {}
+
+   Arena (Arena &&rhs) noexcept : chunks_ (rhs.chunks_), spare_ (rhs.spare_), used_ (rhs.used_), chunkSize_ (rhs.chunkSize_) {
+      rhs.chunks_ = nullptr;
+      rhs.spare_ = nullptr;
+      rhs.used_ = 0;
+   }
+
+   ~Arena () {
+      releaseChunks (chunks_);
+      releaseChunks (spare_);
+   }
+
+private:
+   static uint8_t *dataOf (Chunk *chunk) noexcept {
+      return reinterpret_cast <uint8_t *> (chunk) + kHeaderSize;
+   }
+
+   static void releaseChunks (Chunk *chunk) noexcept {
+      while (chunk) {
+         auto next = chunk->next;
+         mem::release (chunk);
+
+         chunk = next;
+      }
+   }
+
+   static size_t alignUp (const size_t offset, const size_t align) noexcept {
+      return (offset + align - 1) & ~(align - 1);
+   }
+
+   // makes chunk, that can hold at least size bytes, the current one
+   void grow (const size_t size) noexcept {
+      Chunk *chunk = nullptr;
+
+      // take first spare chunk, that fits the request
+      for (Chunk **it = &spare_; *it; it = &(*it)->next) {
+         if ((*it)->size >= size) {
+            chunk = *it;
+            *it = chunk->next;
+
+            break;
+         }
+      }
+
+      if (!chunk) {
+         const size_t chunkSize = cr::max (size, chunkSize_);
+
+         chunk = reinterpret_cast <Chunk *> (mem::allocate <uint8_t> (kHeaderSize + chunkSize));
+         chunk->size = chunkSize;
+      }
+      chunk->next = chunks_;
+
+      chunks_ = chunk;
+      used_ = 0;
+   }
+
+public:
+   // allocates size bytes aligned to align (must be a power of two)
+   void *allocate (const size_t size, const size_t align = alignof (max_align_t)) noexcept {
+      if (chunks_) {
+         const auto base = reinterpret_cast <uintptr_t> (dataOf (chunks_));
+         const auto offset = alignUp (base + used_, align) - base;
+
+         if (offset + size <= chunks_->size) {
+            used_ = offset + size;
+            return dataOf (chunks_) + offset;
+         }
+      }
+      grow (size + align - 1);
+
+      const auto base = reinterpret_cast <uintptr_t> (dataOf (chunks_));
+      const auto offset = alignUp (base, align) - base;
+
+      used_ = offset + size;
+      return dataOf (chunks_) + offset;
+   }
+
+   // allocates raw memory for length objects of type T, objects are not constructed
+   template <typename T> T *allocate (const size_t length = 1) noexcept {
+      return reinterpret_cast <T *> (allocate (length * sizeof (T), alignof (T)));
+   }
+
+   Mark mark () const noexcept {
+      return { chunks_, used_ };
+   }
+
+   // drops everything allocated since the mark was taken, destructors are not called
+   void rewind (const Mark &mark) noexcept {
+      while (chunks_ != mark.chunk) {
+         auto chunk = chunks_;
+         chunks_ = chunk->next;
+
+         chunk->next = spare_;
+         spare_ = chunk;
+      }
+      used_ = mark.used;
+   }
+
+   // drops all the allocations, but keeps chunks for reuse
+   void reset () noexcept {
+      rewind ({});
+   }
+
+   // returns chunks kept for reuse back to the heap
+   void trim () noexcept {
+      releaseChunks (spare_);
+      spare_ = nullptr;
+   }
+
+   // bytes handed out since the last reset (including alignment padding)
+   size_t used () const noexcept {
+      if (!chunks_) {
+         return 0;
+      }
+      size_t used = used_;
+
+      for (auto chunk = chunks_->next; chunk; chunk = chunk->next) {
+         used += chunk->size;
+      }
+      return used;
+   }
+};
+
+// container allocation policy, that takes memory from an arena, releasing is a no-op, as the memory
+// goes back when the arena is rewound, so containers using it must not outlive the arena mark
+class ArenaAllocator {
+private:
+   Arena *arena_ {};
+
+public:
+   ArenaAllocator (Arena &arena) noexcept : arena_ (&arena) {}
+
+public:
+   template <typename T> T *allocate (const size_t length) noexcept {
+      return arena_->allocate <T> (length);
+   }
+
+   template <typename T> void release (T *, const size_t) noexcept {}
+
+   Arena &arena () const noexcept {
+      return *arena_;
+   }
+};
+
+CR_NAMESPACE_END
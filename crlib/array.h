@@ -18,8 +18,16 @@ CR_DECLARE_SCOPED_ENUM (ReservePolicy,
 
 CR_NAMESPACE_BEGIN
 
-// simple array class like std::vector
-template <typename T, ReservePolicy R = ReservePolicy::Multiple, size_t S = 0> class Array : public NonCopyable {
+namespace detail {
+   // container, that exposes contiguous storage of T through data ()
+   template <typename U, typename T, typename = void> struct has_data_of : false_type {};
+
+   template <typename U, typename T> struct has_data_of <U, T, void_t <decltype (cr::declval <const U &> ().data ())>>
+      : bool_constant <is_same <remove_cv_t <remove_pointer_t <decltype (cr::declval <const U &> ().data ())>>, T>::value> {};
+}
+
+// simple array class like std::vector, memory comes from allocation policy A (heap by default)
+template <typename T, ReservePolicy R = ReservePolicy::Multiple, size_t S = 0, typename A = mem::Allocator> class Array : public NonCopyable, private A {
 private:
    T *contents_ {};
    size_t capacity_ {};
@@ -32,11 +40,16 @@ public:
       }
    }
 
-   Array (const size_t amount, const T &defaultValue) {
-      size_t left = amount;
+   explicit Array (const A &allocator) : A (allocator) {
+      if constexpr (S > 0) {
+         reserve (S);
+      }
+   }
 
-      while (left--) {
-         emplace (defaultValue);
+   Array (const size_t amount, const T &defaultValue) {
+      if (reserve (amount)) {
+         constructFill (contents_, amount, defaultValue);
+         length_ = amount;
       }
    }
 
@@ -44,7 +57,7 @@ public:
       reserve (amount);
    }
 
-   Array (Array &&rhs) noexcept {
+   Array (Array &&rhs) noexcept : A (cr::move (rhs.allocator ())) {
       contents_ = rhs.contents_;
       length_ = rhs.length_;
       capacity_ = rhs.capacity_;
@@ -53,9 +66,7 @@ public:
    }
 
    Array (std::initializer_list <T> list) {
-      for (const auto &elem : list) {
-         push (elem);
-      }
+      insert (0, list.begin (), list.size ());
    }
 
    ~Array () {
@@ -71,7 +82,7 @@ private:
 
    void destroy () {
       destructElements ();
-      mem::release (contents_);
+      allocator ().release (contents_, capacity_);
    }
 
    void reset () {
@@ -80,6 +91,37 @@ private:
       length_ = 0;
    }
 
+   // source elements of type T can be copied as raw bytes
+   template <typename U> static constexpr bool isBitwise () {
+      return cr::is_trivially_copyable_v <T> && cr::is_same <remove_cv_t <U>, T>::value;
+   }
+
+   // copy-constructs count copies of value, trivially copyable values are copied in doubling blocks
+   static void constructFill (T *dest, size_t count, const T &value) {
+      if (!count) {
+         return;
+      }
+
+      if constexpr (cr::is_trivially_copyable_v <T>) {
+         if constexpr (sizeof (T) == 1) {
+            memset (dest, *reinterpret_cast <const uint8_t *> (&value), count);
+         }
+         else {
+            memcpy (dest, &value, sizeof (T));
+
+            for (size_t filled = 1; filled < count;) {
+               const size_t block = cr::min (filled, count - filled);
+
+               memcpy (dest + filled, dest, block * sizeof (T));
+               filled += block;
+            }
+         }
+      }
+      else {
+         mem::constructArray (dest, count, value);
+      }
+   }
+
 public:
    bool reserve (const size_t amount) {
       constexpr size_t kMaxSize = SIZE_MAX;
@@ -123,7 +165,7 @@ public:
             newCapacity = required;
          }
       }
-      auto newContents = mem::allocate<T> (newCapacity);
+      auto newContents = allocator ().template allocate <T> (newCapacity);
 
       if (!newContents) {
          return false;
@@ -131,7 +173,7 @@ public:
 
       if (contents_) {
          mem::transfer (newContents, contents_, length_);
-         mem::release (contents_);
+         allocator ().release (contents_, capacity_);
       }
 
       contents_ = newContents;
@@ -142,19 +184,22 @@ public:
 
    bool resize (const size_t amount) {
       if (amount < length_) {
-         while (amount < length_) {
-            discard ();
-         }
+         mem::destructArray (contents_ + amount, length_ - amount);
+         length_ = amount;
       }
       else if (amount > length_) {
          if (!ensure (amount)) {
             return false;
          }
-         size_t resizeLength = amount - length_;
 
-         while (resizeLength--) {
-            emplace ();
+         // value-initializing trivial type is zeroing it
+         if constexpr (cr::is_trivially_default_constructible_v <T>) {
+            memset (static_cast <void *> (contents_ + length_), 0, (amount - length_) * sizeof (T));
          }
+         else {
+            mem::constructArray (contents_ + length_, amount - length_);
+         }
+         length_ = amount;
       }
       return true;
    }
@@ -201,11 +246,18 @@ public:
       }
       const size_t capacity = (length_ > index ? length_ : index) + count;
 
-      if (capacity >= capacity_ && !reserve (capacity)) {
+      if (!ensure (capacity)) {
          return false;
       }
 
-      if (index >= length_) {
+      if constexpr (isBitwise <U> ()) {
+         if (index < length_) {
+            memmove (static_cast <void *> (contents_ + index + count), contents_ + index, (length_ - index) * sizeof (T));
+         }
+         memcpy (static_cast <void *> (contents_ + index), objects, count * sizeof (T));
+         length_ = capacity;
+      }
+      else if (index >= length_) {
          for (size_t i = 0; i < count; ++i) {
             mem::construct (&contents_[i + index], cr::forward <U> (objects[i]));
          }
@@ -313,11 +365,13 @@ public:
    }
 
    void fill (const T &value) {
-      size_t oldLength = length_;
-      clear ();
-
-      while (oldLength--) {
-         emplace (value);
+      if constexpr (cr::is_trivially_copyable_v <T>) {
+         constructFill (contents_, length_, value);
+      }
+      else {
+         for (size_t i = 0; i < length_; ++i) {
+            contents_[i] = value;
+         }
       }
    }
 
@@ -346,11 +400,24 @@ public:
    }
 
    template <typename U> bool extend (const U &rhs) {
-      for (size_t i = 0; i < rhs.length (); ++i) {
-         if (!emplace (rhs[i])) {
-            return false;
+      const size_t count = rhs.length ();
+
+      if (!reserve (count)) {
+         return false;
+      }
+
+      if constexpr (cr::is_trivially_copyable_v <T> && detail::has_data_of <U, T>::value) {
+         if (count > 0) {
+            memcpy (static_cast <void *> (contents_ + length_), rhs.data (), count * sizeof (T));
+         }
+      }
+      else {
+         for (size_t i = 0; i < count; ++i) {
+            mem::construct (&contents_[length_ + i], rhs[i]);
          }
       }
+      length_ += count;
+
       return true;
    }
 
@@ -372,10 +439,10 @@ public:
       if (length_ == capacity_ || !length_) {
          return false;
       }
-      auto data = mem::allocate <T> (length_);
+      auto data = allocator ().template allocate <T> (length_);
 
       mem::transfer (data, contents_, length_);
-      mem::release (contents_);
+      allocator ().release (contents_, capacity_);
 
       contents_ = data;
       capacity_ = length_;
@@ -429,10 +496,19 @@ public:
       return contents_;
    }
 
+   A &allocator () noexcept {
+      return *this;
+   }
+
+   const A &allocator () const noexcept {
+      return *this;
+   }
+
 public:
    Array &operator = (Array &&rhs) noexcept {
       if (this != &rhs) {
          destroy ();
+         allocator () = cr::move (rhs.allocator ());
 
          contents_ = rhs.contents_;
          length_ = rhs.length_;
@@ -474,4 +550,339 @@ public:
 // small array (with minimal reserve policy, something like fixed array, but still able to grow, by default allocates 64 elements)
 template <typename T> using SmallArray = Array <T, ReservePolicy::Single, 64>;
 
+// array, that keeps first N elements inside the object itself and spills to the heap only past N,
+// mirrors the Array interface, so short temporary lists never touch the allocator
+template <typename T, size_t N> class InlineArray : public NonCopyable {
+private:
+   static_assert (N > 0, "Inline capacity must be positive.");
+
+   alignas (T) uint8_t storage_[N * sizeof (T)];
+
+   T *contents_ { inlined () };
+   size_t capacity_ { N };
+   size_t length_ {};
+
+public:
+   explicit InlineArray () = default;
+
+   InlineArray (std::initializer_list <T> list) {
+      for (const auto &elem : list) {
+         push (elem);
+      }
+   }
+
+   InlineArray (InlineArray &&rhs) noexcept {
+      take (rhs);
+   }
+
+   ~InlineArray () {
+      destroy ();
+   }
+
+private:
+   T *inlined () noexcept {
+      return reinterpret_cast <T *> (storage_);
+   }
+
+   void destroy () {
+      mem::destructArray (contents_, length_);
+
+      if (!isInline ()) {
+         mem::release (contents_);
+      }
+      contents_ = inlined ();
+      capacity_ = N;
+      length_ = 0;
+   }
+
+   // heap buffer is stolen, inline elements have to be moved one by one
+   void take (InlineArray &rhs) {
+      if (rhs.isInline ()) {
+         mem::transfer (contents_, rhs.contents_, rhs.length_);
+      }
+      else {
+         contents_ = rhs.contents_;
+         capacity_ = rhs.capacity_;
+
+         rhs.contents_ = rhs.inlined ();
+         rhs.capacity_ = N;
+      }
+      length_ = rhs.length_;
+      rhs.length_ = 0;
+   }
+
+public:
+   bool isInline () const {
+      return contents_ == reinterpret_cast <const T *> (storage_);
+   }
+
+   bool reserve (const size_t amount) {
+      if (capacity_ - length_ >= amount) {
+         return true;
+      }
+
+      if (amount > SIZE_MAX - length_) {
+         return false;
+      }
+      const size_t newCapacity = cr::max (capacity_ * 2, length_ + amount);
+      auto newContents = mem::allocate <T> (newCapacity);
+
+      mem::transfer (newContents, contents_, length_);
+
+      if (!isInline ()) {
+         mem::release (contents_);
+      }
+      contents_ = newContents;
+      capacity_ = newCapacity;
+
+      return true;
+   }
+
+   bool ensure (const size_t amount) {
+      if (amount <= length_) {
+         return true;
+      }
+      return reserve (amount - length_);
+   }
+
+   bool resize (const size_t amount) {
+      if (amount < length_) {
+         mem::destructArray (contents_ + amount, length_ - amount);
+         length_ = amount;
+      }
+      else if (amount > length_) {
+         if (!ensure (amount)) {
+            return false;
+         }
+         while (length_ < amount) {
+            emplace ();
+         }
+      }
+      return true;
+   }
+
+   template <typename U = size_t> U length () const {
+      return static_cast <U> (length_);
+   }
+
+   size_t capacity () const {
+      return capacity_;
+   }
+
+   bool empty () const {
+      return length_ == 0;
+   }
+
+   void clear () {
+      mem::destructArray (contents_, length_);
+      length_ = 0;
+   }
+
+   template <typename U> bool insert (size_t index, U &&object) {
+      return insert (index, &object, 1);
+   }
+
+   template <typename U> bool insert (size_t index, U *objects, size_t count = 1) {
+      if (!objects) {
+         return false;
+      }
+      if (!count) {
+         return true;
+      }
+
+      if (index >= length_) {
+         if (!ensure (index + count)) {
+            return false;
+         }
+         for (size_t i = 0; i < count; ++i) {
+            mem::construct (&contents_[i + index], cr::forward <U> (objects[i]));
+         }
+         length_ = index + count;
+
+         return true;
+      }
+
+      if (!reserve (count)) {
+         return false;
+      }
+
+      // move the tail up, constructing slots past the end and assigning the rest
+      for (size_t i = length_; i > index; --i) {
+         const size_t dst = i + count - 1;
+
+         if (dst >= length_) {
+            mem::construct (&contents_[dst], cr::move (contents_[i - 1]));
+         }
+         else {
+            contents_[dst] = cr::move (contents_[i - 1]);
+         }
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+         if (i + index < length_) {
+            mem::destruct (&contents_[i + index]);
+         }
+         mem::construct (&contents_[i + index], cr::forward <U> (objects[i]));
+      }
+      length_ += count;
+
+      return true;
+   }
+
+   bool erase (const size_t index, const size_t count) {
+      if (index >= length_ || count > length_ - index) {
+         return false;
+      }
+
+      if constexpr (cr::is_trivially_copyable_v <T>) {
+         length_ -= count;
+         memmove (&contents_[index], &contents_[index + count], (length_ - index) * sizeof (T));
+      }
+      else {
+         for (size_t i = index; i < index + count; ++i) {
+            mem::destruct (&contents_[i]);
+         }
+         length_ -= count;
+
+         for (size_t i = index; i < length_; ++i) {
+            mem::construct (&contents_[i], cr::move (contents_[i + count]));
+            mem::destruct (&contents_[i + count]);
+         }
+      }
+      return true;
+   }
+
+   bool shift () {
+      return erase (0, 1);
+   }
+
+   template <typename U> bool unshift (U &&object) {
+      return insert (0, &object);
+   }
+
+   bool remove (const T &object) {
+      return erase (index (object), 1);
+   }
+
+   template <typename U> bool push (U &&object) {
+      return emplace (cr::forward <U> (object));
+   }
+
+   template <typename ...Args> bool emplace (Args &&...args) {
+      if (length_ == capacity_ && !reserve (1)) {
+         return false;
+      }
+      mem::construct (&contents_[length_], cr::forward <Args> (args)...);
+      ++length_;
+
+      return true;
+   }
+
+   T pop () {
+      auto object = cr::move (contents_[length_ - 1]);
+      discard ();
+
+      return object;
+   }
+
+   void discard () {
+      --length_;
+      mem::destruct (&contents_[length_]);
+   }
+
+   size_t index (const T &object) const {
+      return &object - &contents_[0];
+   }
+
+   void reverse () {
+      for (size_t i = 0; i < length_ / 2; ++i) {
+         cr::swap (contents_[i], contents_[length_ - 1 - i]);
+      }
+   }
+
+   // count is taken before growing, and room for all of it is reserved at once, so extending with self
+   // copies the original elements out of the moved buffer, and ends
+   template <typename U> bool extend (const U &rhs) {
+      const size_t count = rhs.length ();
+
+      if (!reserve (count)) {
+         return false;
+      }
+
+      for (size_t i = 0; i < count; ++i) {
+         mem::construct (&contents_[length_ + i], rhs[i]);
+      }
+      length_ += count;
+
+      return true;
+   }
+
+   template <typename U> const T &at (U index) const {
+      return contents_[index];
+   }
+
+   template <typename U> T &at (U index) {
+      return contents_[index];
+   }
+
+   const T &first () const {
+      return contents_[0];
+   }
+
+   T &first () {
+      return contents_[0];
+   }
+
+   const T &last () const {
+      return contents_[length_ - 1];
+   }
+
+   T &last () {
+      return contents_[length_ - 1];
+   }
+
+   T *data () {
+      return contents_;
+   }
+
+   const T *data () const {
+      return contents_;
+   }
+
+public:
+   InlineArray &operator = (InlineArray &&rhs) noexcept {
+      if (this != &rhs) {
+         destroy ();
+         take (rhs);
+      }
+      return *this;
+   }
+
+   template <typename U> const T &operator [] (U index) const {
+      return at (index);
+   }
+
+   template <typename U> T &operator [] (U index) {
+      return at (index);
+   }
+
+   // for range-based loops
+public:
+   T *begin () {
+      return contents_;
+   }
+
+   const T *begin () const {
+      return contents_;
+   }
+
+   T *end () {
+      return contents_ + length_;
+   }
+
+   const T *end () const {
+      return contents_ + length_;
+   }
+};
+
 CR_NAMESPACE_END
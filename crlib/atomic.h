@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <string.h>
+
+#if defined(CR_CXX_MSVC)
+#  include <intrin.h>
+#endif
+
+// memory ordering of atomic operations, values match the compiler builtin constants
+CR_DECLARE_SCOPED_ENUM (MemoryOrder,
+   Relaxed = 0,
+   Acquire = 2,
+   Release = 3,
+   AcqRel = 4,
+   SeqCst = 5
+)
+
+CR_NAMESPACE_BEGIN
+
+// lightweight atomic for integers, booleans and pointers, built on compiler intrinsics, so no <atomic> needed
+template <typename T> class Atomic final : public NonCopyable {
+private:
+   static_assert (sizeof (T) == 1 || sizeof (T) == 2 || sizeof (T) == 4 || sizeof (T) == 8, "Unsupported atomic type size.");
+
+private:
+   alignas (sizeof (T)) T value_ {};
+
+#if defined(CR_CXX_MSVC)
+private:
+   // interlocked intrinsics work on signed integers of the same size
+   using Raw = typename conditional <sizeof (T) == 1, char, typename conditional <sizeof (T) == 2, short, typename conditional <sizeof (T) == 4, long, __int64>::type>::type>::type;
+
+   template <typename To, typename From> static To cast (const From &value) noexcept {
+      To result;
+      memcpy (&result, &value, sizeof (To));
+
+      return result;
+   }
+
+   volatile Raw *raw () noexcept {
+      return reinterpret_cast <volatile Raw *> (&value_);
+   }
+
+   const volatile Raw *raw () const noexcept {
+      return reinterpret_cast <const volatile Raw *> (&value_);
+   }
+
+   // 32-bit targets split plain 8-byte moves in two, and lack 8-byte interlocked exchange and add, so all
+   // the 8-byte operations go through compare-exchange there, which is a single locked instruction
+#  if defined(CR_ARCH_X32)
+   static constexpr bool kSplitWide = sizeof (T) == 8;
+#  else
+   static constexpr bool kSplitWide = false;
+#  endif
+
+   static void barrier () noexcept {
+#  if defined(CR_ARCH_ARM)
+      __dmb (_ARM64_BARRIER_ISH);
+#  else
+      _ReadWriteBarrier ();
+#  endif
+   }
+
+   // reads 8-byte value in one piece, compare-exchange of zero with zero leaves it as is either way
+   Raw wideLoad () const noexcept {
+      return _InterlockedCompareExchange64 (const_cast <volatile Raw *> (raw ()), 0, 0);
+   }
+
+   template <typename F> Raw wideUpdate (F &&fn) noexcept {
+      Raw current = wideLoad ();
+
+      for (;;) {
+         const Raw previous = _InterlockedCompareExchange64 (raw (), fn (current), current);
+
+         if (previous == current) {
+            return previous;
+         }
+         current = previous;
+      }
+   }
+
+   Raw interlockedExchange (const Raw value) noexcept {
+      if constexpr (sizeof (T) == 1) { return _InterlockedExchange8 (raw (), value); }
+      else if constexpr (sizeof (T) == 2) { return _InterlockedExchange16 (raw (), value); }
+      else if constexpr (sizeof (T) == 4) { return _InterlockedExchange (raw (), value); }
+      else if constexpr (kSplitWide) { return wideUpdate ([value] (const Raw) { return value; }); }
+      else { return _InterlockedExchange64 (raw (), value); }
+   }
+
+   Raw interlockedCompareExchange (const Raw desired, const Raw expected) noexcept {
+      if constexpr (sizeof (T) == 1) { return _InterlockedCompareExchange8 (raw (), desired, expected); }
+      else if constexpr (sizeof (T) == 2) { return _InterlockedCompareExchange16 (raw (), desired, expected); }
+      else if constexpr (sizeof (T) == 4) { return _InterlockedCompareExchange (raw (), desired, expected); }
+      else { return _InterlockedCompareExchange64 (raw (), desired, expected); }
+   }
+
+   Raw interlockedAdd (const Raw value) noexcept {
+      if constexpr (sizeof (T) == 1) { return _InterlockedExchangeAdd8 (raw (), value); }
+      else if constexpr (sizeof (T) == 2) { return _InterlockedExchangeAdd16 (raw (), value); }
+      else if constexpr (sizeof (T) == 4) { return _InterlockedExchangeAdd (raw (), value); }
+      else if constexpr (kSplitWide) { return wideUpdate ([value] (const Raw current) { return static_cast <Raw> (current + value); }); }
+      else { return _InterlockedExchangeAdd64 (raw (), value); }
+   }
+
+   // generic read-modify-write through compare-exchange loop, interlocked operations are full barriers
+   template <typename F> T update (F &&fn) noexcept {
+      Raw current = *raw ();
+
+      for (;;) {
+         const Raw desired = cast <Raw> (fn (cast <T> (current)));
+         const Raw previous = interlockedCompareExchange (desired, current);
+
+         if (previous == current) {
+            return cast <T> (previous);
+         }
+         current = previous;
+      }
+   }
+#endif
+
+public:
+   constexpr Atomic () noexcept = default;
+   constexpr Atomic (const T value) noexcept : value_ (value) {}
+
+   ~Atomic () = default;
+
+public:
+   T load (const MemoryOrder order = MemoryOrder::SeqCst) const noexcept {
+#if defined(CR_CXX_MSVC)
+      if constexpr (kSplitWide) {
+         (void) order;
+         return cast <T> (wideLoad ());
+      }
+      const Raw value = *raw ();
+
+      if (order != MemoryOrder::Relaxed) {
+         barrier ();
+      }
+      return cast <T> (value);
+#else
+      return __atomic_load_n (&value_, static_cast <int> (order));
+#endif
+   }
+
+   void store (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      if (kSplitWide || order == MemoryOrder::SeqCst) {
+         interlockedExchange (cast <Raw> (value));
+         return;
+      }
+
+      if (order != MemoryOrder::Relaxed) {
+         barrier ();
+      }
+      *raw () = cast <Raw> (value);
+#else
+      __atomic_store_n (&value_, value, static_cast <int> (order));
+#endif
+   }
+
+   T exchange (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) order;
+      return cast <T> (interlockedExchange (cast <Raw> (value)));
+#else
+      return __atomic_exchange_n (&value_, value, static_cast <int> (order));
+#endif
+   }
+
+   // on failure expected receives the current value
+   bool compareExchange (T &expected, const T desired, const MemoryOrder success = MemoryOrder::SeqCst, const MemoryOrder failure = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) success;
+      (void) failure;
+
+      const Raw comparand = cast <Raw> (expected);
+      const Raw previous = interlockedCompareExchange (cast <Raw> (desired), comparand);
+
+      if (previous == comparand) {
+         return true;
+      }
+      expected = cast <T> (previous);
+      return false;
+#else
+      return __atomic_compare_exchange_n (&value_, &expected, desired, false, static_cast <int> (success), static_cast <int> (failure));
+#endif
+   }
+
+   // may fail spuriously, cheaper on ll/sc architectures when used in a loop
+   bool compareExchangeWeak (T &expected, const T desired, const MemoryOrder success = MemoryOrder::SeqCst, const MemoryOrder failure = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      return compareExchange (expected, desired, success, failure);
+#else
+      return __atomic_compare_exchange_n (&value_, &expected, desired, true, static_cast <int> (success), static_cast <int> (failure));
+#endif
+   }
+
+   // arithmetic and bitwise operations return the previous value
+   T fetchAdd (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) order;
+      return cast <T> (interlockedAdd (cast <Raw> (value)));
+#else
+      return __atomic_fetch_add (&value_, value, static_cast <int> (order));
+#endif
+   }
+
+   T fetchSub (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) order;
+      return cast <T> (interlockedAdd (static_cast <Raw> (0 - cast <Raw> (value))));
+#else
+      return __atomic_fetch_sub (&value_, value, static_cast <int> (order));
+#endif
+   }
+
+   T fetchAnd (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) order;
+      return update ([value] (const T current) { return static_cast <T> (current & value); });
+#else
+      return __atomic_fetch_and (&value_, value, static_cast <int> (order));
+#endif
+   }
+
+   T fetchOr (const T value, const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+      (void) order;
+      return update ([value] (const T current) { return static_cast <T> (current | value); });
+#else
+      return __atomic_fetch_or (&value_, value, static_cast <int> (order));
+#endif
+   }
+};
+
+// standalone memory fence
+inline void atomicFence (const MemoryOrder order = MemoryOrder::SeqCst) noexcept {
+#if defined(CR_CXX_MSVC)
+   if (order == MemoryOrder::SeqCst) {
+#  if defined(CR_ARCH_ARM)
+      __dmb (_ARM64_BARRIER_ISH);
+#  else
+      _mm_mfence ();
+#  endif
+   }
+   else {
+      _ReadWriteBarrier ();
+   }
+#else
+   __atomic_thread_fence (static_cast <int> (order));
+#endif
+}
+
+// hints the cpu, that caller is busy-waiting
+CR_FORCE_INLINE void cpuRelax () noexcept {
+#if defined(CR_ARCH_X64) || defined(CR_ARCH_X32)
+#  if defined(CR_CXX_MSVC)
+   _mm_pause ();
+#  else
+   __builtin_ia32_pause ();
+#  endif
+#elif defined(CR_ARCH_ARM) && !defined(CR_CXX_MSVC)
+   __asm__ __volatile__ ("yield");
+#elif defined(CR_ARCH_ARM) && defined(CR_CXX_MSVC)
+   __yield ();
+#endif
+}
+
+CR_NAMESPACE_END
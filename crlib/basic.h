@@ -13,6 +13,10 @@
 #include <stddef.h>
 #include <limits.h>
 
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
 CR_NAMESPACE_BEGIN
 
 // global helper stuff
@@ -58,6 +62,38 @@ constexpr size_t bit_ceil (size_t n) noexcept {
    return n + 1;
 }
 
+// number of trailing zero bits, like std::countr_zero
+inline int32_t countr_zero (uint32_t n) noexcept {
+   if (n == 0) {
+      return 32;
+   }
+#if defined(_MSC_VER)
+   unsigned long index {};
+   _BitScanForward (&index, n);
+
+   return static_cast <int32_t> (index);
+#else
+   return __builtin_ctz (n);
+#endif
+}
+
+inline int32_t countr_zero (uint64_t n) noexcept {
+   if (n == 0) {
+      return 64;
+   }
+#if defined(_MSC_VER) && defined(_WIN64)
+   unsigned long index {};
+   _BitScanForward64 (&index, n);
+
+   return static_cast <int32_t> (index);
+#elif defined(_MSC_VER)
+   const auto lo = static_cast <uint32_t> (n);
+   return lo ? countr_zero (lo) : 32 + countr_zero (static_cast <uint32_t> (n >> 32));
+#else
+   return __builtin_ctzll (n);
+#endif
+}
+
 // simple non-copying base class
 class NonCopyable {
 protected:
@@ -8,7 +8,8 @@
 
 CR_NAMESPACE_BEGIN
 
-template <typename T> class BinaryHeap final : public NonCopyable {
+// min-heap on top of a flat array, memory comes from allocation policy A (heap by default)
+template <typename T, typename A = mem::Allocator> class BinaryHeap final : public NonCopyable, private A {
 private:
    T *data_ = nullptr;
    size_t size_ = 0;
@@ -16,9 +17,10 @@ private:
 
 public:
    explicit BinaryHeap () = default;
+   explicit BinaryHeap (const A &allocator) : A (allocator) {}
 
    BinaryHeap (BinaryHeap &&rhs) noexcept
-      : data_ (rhs.data_), size_ (rhs.size_), capacity_ (rhs.capacity_) {
+      : A (cr::move (rhs.allocator ())), data_ (rhs.data_), size_ (rhs.size_), capacity_ (rhs.capacity_) {
       rhs.data_ = nullptr;
       rhs.size_ = 0;
       rhs.capacity_ = 0;
@@ -102,11 +104,22 @@ public:
       cr::swap (data_, other.data_);
       cr::swap (size_, other.size_);
       cr::swap (capacity_, other.capacity_);
+      cr::swap (allocator (), other.allocator ());
+   }
+
+   A &allocator () noexcept {
+      return *this;
+   }
+
+   const A &allocator () const noexcept {
+      return *this;
    }
 
    BinaryHeap &operator = (BinaryHeap &&rhs) noexcept {
       if (this != &rhs) {
          destroy ();
+         allocator () = cr::move (rhs.allocator ());
+
          data_ = rhs.data_;
          size_ = rhs.size_;
          capacity_ = rhs.capacity_;
@@ -123,7 +136,7 @@ private:
          for (size_t i = 0; i < size_; ++i) {
             mem::destruct (&data_[i]);
          }
-         mem::release (data_);
+         allocator ().release (data_, capacity_);
          data_ = nullptr;
       }
    }
@@ -137,7 +150,7 @@ private:
       while (newCap < needed) {
          newCap *= 2;
       }
-      auto newData = mem::allocate <T> (newCap);
+      auto newData = allocator ().template allocate <T> (newCap);
 
       if (!newData) {
          return false;
@@ -146,7 +159,7 @@ private:
          mem::construct (&newData[i], cr::move (data_[i]));
          mem::destruct (&data_[i]);
       }
-      mem::release (data_);
+      allocator ().release (data_, capacity_);
       data_ = newData;
       capacity_ = newCap;
       return true;
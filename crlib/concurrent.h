@@ -0,0 +1,389 @@
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <crlib/hashmap.h>
+#include <crlib/thread.h>
+#include <crlib/atomic.h>
+
+// which sides of a ring queue may be used from many threads at once
+CR_DECLARE_SCOPED_ENUM (QueuePolicy,
+   Spsc, // single producer, single consumer
+   Mpsc, // many producers, single consumer
+   Mpmc, // many producers, many consumers
+)
+
+CR_NAMESPACE_BEGIN
+
+// hash map safe to use from many threads, keys are spread over independently locked shards (selected
+// by high bits of the hash), so threads working on different shards never wait for each other, and
+// lookups take shards shared, so readers of the same shard don't wait for each other either
+template <typename K, typename V, typename H = Hash <K>, typename E = KeyEqual <K>, size_t N = 16> class ConcurrentHashMap final : public NonCopyable {
+private:
+   static_assert (N > 0 && (N & (N - 1)) == 0, "Shard count must be a power of two.");
+
+   using Map = HashMap <K, V, H, E>;
+   using Lock = ScopedLock <SharedMutex>;
+   using ReadLock = ScopedSharedLock <SharedMutex>;
+
+   template <typename Q> using IfTransparent = enable_if_t <detail::is_transparent <H>::value && detail::is_transparent <E>::value && !is_same <Q, K>::value, int>;
+
+   // each shard owns its cache line, so taking one lock doesn't invalidate neighbours
+   struct alignas (kCacheLineSize) Shard {
+      SharedMutex mutex {};
+      Map map {};
+   };
+
+private:
+   H hash_ {};
+   mutable Shard shards_[N] {};
+
+private:
+   static constexpr uint32_t shardBits () noexcept {
+      uint32_t bits = 0;
+
+      while ((static_cast <size_t> (1) << bits) < N) {
+         ++bits;
+      }
+      return bits;
+   }
+
+   // low bits of the hash are used by the shard map itself, so pick shard from the high ones
+   template <typename Q> Shard &shardOf (const Q &key) const noexcept {
+      if constexpr (N == 1) {
+         return shards_[0];
+      }
+      else {
+         const uint32_t mixed = hash_ (key) * 0x9e3779b1u;
+         return shards_[mixed >> (32 - shardBits ())];
+      }
+   }
+
+   template <typename Q> bool findValue (const Q &key, V &out) const noexcept {
+      auto &shard = shardOf (key);
+      ReadLock lock (shard.mutex);
+
+      if (auto value = shard.map.find (key)) {
+         out = *value;
+         return true;
+      }
+      return false;
+   }
+
+   template <typename Q> bool existsKey (const Q &key) const noexcept {
+      auto &shard = shardOf (key);
+      ReadLock lock (shard.mutex);
+
+      return shard.map.exists (key);
+   }
+
+   template <typename Q> size_t eraseKey (const Q &key) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      return shard.map.erase (key);
+   }
+
+   template <typename Q, typename F> bool visitKey (const Q &key, F &&fn) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      if (auto value = shard.map.find (key)) {
+         fn (*value);
+         return true;
+      }
+      return false;
+   }
+
+public:
+   ConcurrentHashMap () = default;
+   ~ConcurrentHashMap () = default;
+
+public:
+   bool insert (const K &key, const V &val) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      return shard.map.insert (key, val);
+   }
+
+   bool insert (const K &key, V &&val) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      return shard.map.insert (key, cr::move (val));
+   }
+
+   // inserts the key or overwrites the value of the existing one
+   void assign (const K &key, const V &val) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      shard.map[key] = val;
+   }
+
+   void assign (const K &key, V &&val) noexcept {
+      auto &shard = shardOf (key);
+      Lock lock (shard.mutex);
+
+      shard.map[key] = cr::move (val);
+   }
+
+   // values can't be referenced outside of the lock, so lookups copy them out
+   bool find (const K &key, V &out) const noexcept {
+      return findValue (key, out);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> bool find (const Q &key, V &out) const noexcept {
+      return findValue (key, out);
+   }
+
+   bool exists (const K &key) const noexcept {
+      return existsKey (key);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> bool exists (const Q &key) const noexcept {
+      return existsKey (key);
+   }
+
+   size_t erase (const K &key) noexcept {
+      return eraseKey (key);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> size_t erase (const Q &key) noexcept {
+      return eraseKey (key);
+   }
+
+   // runs fn on the value in place while its shard is locked, returns false if no such key
+   template <typename F> bool visit (const K &key, F &&fn) noexcept {
+      return visitKey (key, cr::forward <F> (fn));
+   }
+
+   template <typename Q, typename F, IfTransparent <Q> = 0> bool visit (const Q &key, F &&fn) noexcept {
+      return visitKey (key, cr::forward <F> (fn));
+   }
+
+   // runs fn on every key and value, shards are locked one after another, so it's not a snapshot
+   template <typename F> void forEach (F &&fn) noexcept {
+      for (auto &shard : shards_) {
+         Lock lock (shard.mutex);
+
+         for (auto [key, val] : shard.map) {
+            fn (key, val);
+         }
+      }
+   }
+
+   void clear () noexcept {
+      for (auto &shard : shards_) {
+         Lock lock (shard.mutex);
+         shard.map.clear ();
+      }
+   }
+
+   size_t length () const noexcept {
+      size_t length = 0;
+
+      for (auto &shard : shards_) {
+         ReadLock lock (shard.mutex);
+         length += shard.map.length ();
+      }
+      return length;
+   }
+
+   bool empty () const noexcept {
+      return length () == 0;
+   }
+
+   // reserves room for n entries overall, spread evenly over the shards
+   void reserve (size_t n) noexcept {
+      for (auto &shard : shards_) {
+         Lock lock (shard.mutex);
+         shard.map.reserve (n / N + 1);
+      }
+   }
+
+   static constexpr size_t shards () noexcept {
+      return N;
+   }
+};
+
+// bounded lock-free ring queue (vyukov's sequence numbered cells), push and pop never block, but fail when
+// the queue is full or empty, sides used by a single thread skip the compare-exchange on their position
+template <typename T, QueuePolicy P = QueuePolicy::Mpmc> class RingQueue final : public NonCopyable {
+private:
+   static_assert (alignof (T) <= alignof (max_align_t), "Over-aligned types are not supported.");
+
+   // each cell's sequence tells whose turn it is: equal to position - producer's, position + 1 - consumer's
+   struct Cell {
+      Atomic <size_t> sequence;
+      alignas (T) uint8_t storage[sizeof (T)];
+
+      T *value () {
+         return reinterpret_cast <T *> (storage);
+      }
+   };
+
+   static constexpr bool kMultiProducer = P != QueuePolicy::Spsc;
+   static constexpr bool kMultiConsumer = P == QueuePolicy::Mpmc;
+
+private:
+   // producers and consumers hammer their own positions, so keep them apart from each other and from
+   // the read-only part
+   Cell *cells_ {};
+   size_t mask_ {};
+   uint8_t cellsPadding_[kCacheLineSize] {};
+   Atomic <size_t> enqueuePos_ {};
+   uint8_t enqueuePadding_[kCacheLineSize] {};
+   Atomic <size_t> dequeuePos_ {};
+   uint8_t dequeuePadding_[kCacheLineSize] {};
+
+public:
+   // capacity is rounded up to the power of two
+   explicit RingQueue (const size_t capacity) {
+      const size_t size = cr::max <size_t> (cr::bit_ceil (capacity), 2);
+
+      cells_ = mem::allocate <Cell> (size);
+      mask_ = size - 1;
+
+      for (size_t i = 0; i < size; ++i) {
+         mem::construct (&cells_[i].sequence, i);
+      }
+   }
+
+   ~RingQueue () {
+      while (pop ()) {}
+      mem::release (cells_);
+   }
+
+private:
+   // claims the cell for writing, nullptr if the queue is full
+   Cell *claimPush (size_t &pos) {
+      pos = enqueuePos_.load (MemoryOrder::Relaxed);
+
+      for (;;) {
+         auto cell = &cells_[pos & mask_];
+         const auto diff = static_cast <intptr_t> (cell->sequence.load (MemoryOrder::Acquire)) - static_cast <intptr_t> (pos);
+
+         if (diff == 0) {
+            if constexpr (kMultiProducer) {
+               if (enqueuePos_.compareExchangeWeak (pos, pos + 1, MemoryOrder::Relaxed, MemoryOrder::Relaxed)) {
+                  return cell;
+               }
+            }
+            else {
+               enqueuePos_.store (pos + 1, MemoryOrder::Relaxed);
+               return cell;
+            }
+         }
+         else if (diff < 0) {
+            return nullptr;
+         }
+         else {
+            pos = enqueuePos_.load (MemoryOrder::Relaxed);
+         }
+      }
+   }
+
+   // claims the cell for reading, nullptr if the queue is empty
+   Cell *claimPop (size_t &pos) {
+      pos = dequeuePos_.load (MemoryOrder::Relaxed);
+
+      for (;;) {
+         auto cell = &cells_[pos & mask_];
+         const auto diff = static_cast <intptr_t> (cell->sequence.load (MemoryOrder::Acquire)) - static_cast <intptr_t> (pos + 1);
+
+         if (diff == 0) {
+            if constexpr (kMultiConsumer) {
+               if (dequeuePos_.compareExchangeWeak (pos, pos + 1, MemoryOrder::Relaxed, MemoryOrder::Relaxed)) {
+                  return cell;
+               }
+            }
+            else {
+               dequeuePos_.store (pos + 1, MemoryOrder::Relaxed);
+               return cell;
+            }
+         }
+         else if (diff < 0) {
+            return nullptr;
+         }
+         else {
+            pos = dequeuePos_.load (MemoryOrder::Relaxed);
+         }
+      }
+   }
+
+public:
+   // constructs the value in place, returns false if the queue is full
+   template <typename ...Args> bool emplace (Args &&...args) {
+      size_t pos = 0;
+      auto cell = claimPush (pos);
+
+      if (!cell) {
+         return false;
+      }
+      mem::construct (cell->value (), cr::forward <Args> (args)...);
+      cell->sequence.store (pos + 1, MemoryOrder::Release);
+
+      return true;
+   }
+
+   bool push (const T &value) {
+      return emplace (value);
+   }
+
+   bool push (T &&value) {
+      return emplace (cr::move (value));
+   }
+
+   // moves the oldest value out, returns false if the queue is empty
+   bool pop (T &out) {
+      size_t pos = 0;
+      auto cell = claimPop (pos);
+
+      if (!cell) {
+         return false;
+      }
+      out = cr::move (*cell->value ());
+      mem::destruct (cell->value ());
+      cell->sequence.store (pos + mask_ + 1, MemoryOrder::Release);
+
+      return true;
+   }
+
+   // drops the oldest value, returns false if the queue is empty
+   bool pop () {
+      size_t pos = 0;
+      auto cell = claimPop (pos);
+
+      if (!cell) {
+         return false;
+      }
+      mem::destruct (cell->value ());
+      cell->sequence.store (pos + mask_ + 1, MemoryOrder::Release);
+
+      return true;
+   }
+
+   // approximate, when called concurrently with producers or consumers
+   size_t length () const {
+      const auto size = static_cast <intptr_t> (enqueuePos_.load (MemoryOrder::Relaxed) - dequeuePos_.load (MemoryOrder::Relaxed));
+      return size > 0 ? static_cast <size_t> (size) : 0;
+   }
+
+   bool empty () const {
+      return length () == 0;
+   }
+
+   size_t capacity () const {
+      return mask_ + 1;
+   }
+};
+
+// shortcuts for the queue policies
+template <typename T> using SpscQueue = RingQueue <T, QueuePolicy::Spsc>;
+template <typename T> using MpscQueue = RingQueue <T, QueuePolicy::Mpsc>;
+template <typename T> using MpmcQueue = RingQueue <T, QueuePolicy::Mpmc>;
+
+CR_NAMESPACE_END
@@ -6,6 +6,7 @@
 
 #include <crlib/basic.h>
 #include <crlib/memory.h>
+#include <crlib/arena.h>
 #include <crlib/array.h>
 #include <crlib/deque.h>
 #include <crlib/binheap.h>
@@ -14,6 +15,7 @@
 #include <crlib/http.h>
 #include <crlib/library.h>
 #include <crlib/hashmap.h>
+#include <crlib/hashset.h>
 #include <crlib/logger.h>
 #include <crlib/cpuflags.h>
 #include <crlib/mathlib.h>
@@ -22,7 +24,11 @@
 #include <crlib/ulz.h>
 #include <crlib/color.h>
 #include <crlib/detour.h>
+#include <crlib/atomic.h>
 #include <crlib/thread.h>
+#include <crlib/parallel.h>
+#include <crlib/concurrent.h>
+#include <crlib/pool.h>
 #include <crlib/timers.h>
 #include <crlib/wavehelper.h>
 
@@ -6,7 +6,8 @@
 
 CR_NAMESPACE_BEGIN
 
-template <typename T> class Deque : public NonCopyable {
+// ring buffer based double-ended queue, memory comes from allocation policy A (heap by default)
+template <typename T, typename A = mem::Allocator> class Deque : public NonCopyable, private A {
 private:
    T *contents_ {};
    size_t capacity_ {};
@@ -24,7 +25,7 @@ private:
 
    void grow () {
       const auto capacity = capacity_ > 0 ? capacity_ * 2 : 8;
-      auto contents = mem::allocate <T> (capacity);
+      auto contents = allocator ().template allocate <T> (capacity);
 
       if (length_ > 0) {
          if (head_ + length_ <= capacity_) {
@@ -37,7 +38,7 @@ private:
             mem::transfer (&contents[firstPart], contents_, length_ - firstPart);
          }
       }
-      mem::release (contents_);
+      allocator ().release (contents_, capacity_);
 
       contents_ = contents;
       capacity_ = capacity;
@@ -62,7 +63,7 @@ private:
 
    void destroy () {
       destructElements ();
-      mem::release (contents_);
+      allocator ().release (contents_, capacity_);
    }
 
    void reset () {
@@ -74,9 +75,11 @@ private:
 
 public:
    explicit Deque () = default;
+   explicit Deque (const A &allocator) : A (allocator) {}
 
    Deque (Deque &&rhs) noexcept
-      : contents_ (rhs.contents_)
+      : A (cr::move (rhs.allocator ()))
+      , contents_ (rhs.contents_)
       , capacity_ (rhs.capacity_)
       , head_ (rhs.head_)
       , length_ (rhs.length_) {
@@ -164,10 +167,19 @@ public:
       length_ = 0;
    }
 
+   A &allocator () noexcept {
+      return *this;
+   }
+
+   const A &allocator () const noexcept {
+      return *this;
+   }
+
 public:
    Deque &operator = (Deque &&rhs) noexcept {
       if (this != &rhs) {
          destroy ();
+         allocator () = cr::move (rhs.allocator ());
 
          contents_ = rhs.contents_;
          capacity_ = rhs.capacity_;
@@ -19,10 +19,11 @@ public:
 
 public:
    void initialize (StringRef, StringRef, T *) {}
-   void install (void *, const bool = false) {}
+   void install (void *, const bool = false, const bool = true) {}
 
    bool valid () const { return false; }
    bool detoured () const { return false; }
+   bool hasTrampoline () const { return false; }
    bool detour () { return false; }
    bool restore () { return false; }
 
@@ -46,6 +47,180 @@ CR_NAMESPACE_END
 
 CR_NAMESPACE_BEGIN
 
+namespace detail {
+   // length and relative operand of one decoded x86/x64 instruction
+   struct DetourInstruction {
+      size_t length {}; // zero, if instruction is not supported
+      size_t relative {}; // offset of 32-bit displacement relative to instruction end, zero if there's none
+   };
+
+   // length disassembler for instructions common in function prologues, branches with 8-bit relative
+   // operands can't be moved anywhere, so they are reported as unsupported along with unknown opcodes
+   inline DetourInstruction decodeInstruction (const uint8_t *code) {
+      constexpr bool kLongMode = sizeof (void *) == 8;
+      constexpr size_t kMaxLength = 15;
+
+      const uint8_t *cursor = code;
+      bool operand16 = false;
+      bool wide = false;
+
+      // legacy prefixes (lock, rep, segment overrides, operand size), address size override never
+      // shows up in prologues, so it's left unsupported
+      for (;; ++cursor) {
+         const uint8_t prefix = *cursor;
+
+         if (prefix == 0x66) {
+            operand16 = true;
+         }
+         else if (prefix == 0x67 || static_cast <size_t> (cursor - code) >= kMaxLength) {
+            return {};
+         }
+         else if (prefix != 0xf0 && prefix != 0xf2 && prefix != 0xf3 && prefix != 0x26 && prefix != 0x2e && prefix != 0x36 && prefix != 0x3e && prefix != 0x64 && prefix != 0x65) {
+            break;
+         }
+      }
+
+      if (kLongMode && (*cursor & 0xf0) == 0x40) {
+         wide = !!(*cursor & 0x08);
+         ++cursor;
+      }
+      const uint8_t opcode = *cursor++;
+      const size_t immediate = operand16 ? 2 : 4;
+
+      bool modrm = false;
+      bool branch = false;
+      size_t extra = 0;
+
+      if (opcode == 0x0f) {
+         const uint8_t second = *cursor++;
+
+         if ((second & 0xf0) == 0x80) {
+            branch = true; // jcc rel32
+         }
+         else if (second == 0x05 || second == 0x0b || second == 0x31 || second == 0xa2) {
+            // syscall, ud2, rdtsc, cpuid
+         }
+         else if (second == 0x70 || second == 0x71 || second == 0x72 || second == 0x73 || second == 0xa4 || second == 0xac || second == 0xba || second == 0xc2 || second == 0xc6) {
+            modrm = true;
+            extra = 1;
+         }
+         else if ((second >= 0x10 && second <= 0x1f) || (second >= 0x28 && second <= 0x2f) || (second >= 0x40 && second <= 0x7f) || (second >= 0x90 && second <= 0x9f) || second == 0xa3 || second == 0xab || second == 0xaf || second == 0xb0 || second == 0xb1 || second == 0xb3 || (second >= 0xb6 && second <= 0xc1) || second >= 0xd0) {
+            modrm = true;
+         }
+         else {
+            return {};
+         }
+      }
+      else if (opcode < 0x40) {
+         switch (opcode & 0x07) {
+         case 0x00: case 0x01: case 0x02: case 0x03:
+            modrm = true;
+            break;
+
+         case 0x04:
+            extra = 1;
+            break;
+
+         case 0x05:
+            extra = immediate;
+            break;
+
+         default:
+            return {}; // segment push/pop, bcd adjustments
+         }
+      }
+      else if (opcode < 0x60) {
+         // push, pop (and inc, dec outside of long mode, where these are rex prefixes)
+      }
+      else if (opcode == 0x63 || (opcode >= 0x84 && opcode <= 0x8f) || (opcode >= 0xd0 && opcode <= 0xd3) || opcode == 0xfe || opcode == 0xff) {
+         modrm = true;
+      }
+      else if (opcode == 0x68) {
+         extra = immediate;
+      }
+      else if (opcode == 0x6a || opcode == 0xa8 || (opcode >= 0xb0 && opcode <= 0xb7)) {
+         extra = 1;
+      }
+      else if (opcode == 0x69 || opcode == 0x81 || opcode == 0xc7) {
+         modrm = true;
+         extra = immediate;
+      }
+      else if (opcode == 0x6b || opcode == 0x80 || opcode == 0x83 || opcode == 0xc0 || opcode == 0xc1 || opcode == 0xc6) {
+         modrm = true;
+         extra = 1;
+      }
+      else if ((opcode >= 0x90 && opcode <= 0x99) || opcode == 0x9c || opcode == 0x9d || opcode == 0xc3 || opcode == 0xc9 || opcode == 0xcc) {
+         // xchg, nop, cbw, cwd, pushf, popf, ret, leave, int3
+      }
+      else if (opcode == 0xa9) {
+         extra = immediate;
+      }
+      else if (opcode >= 0xb8 && opcode <= 0xbf) {
+         extra = wide ? 8 : immediate;
+      }
+      else if (opcode == 0xc2) {
+         extra = 2;
+      }
+      else if (opcode == 0xc8) {
+         extra = 3;
+      }
+      else if ((opcode == 0xe8 || opcode == 0xe9) && !operand16) {
+         branch = true; // call, jmp rel32
+      }
+      else if (opcode == 0xf6 || opcode == 0xf7) {
+         modrm = true;
+
+         // only test has an immediate in this group
+         if (((*cursor >> 3) & 0x07) < 2) {
+            extra = opcode == 0xf6 ? 1 : immediate;
+         }
+      }
+      else {
+         return {};
+      }
+      DetourInstruction result {};
+
+      if (modrm) {
+         const uint8_t value = *cursor++;
+         const uint8_t mod = value >> 6;
+         const uint8_t rm = value & 0x07;
+
+         if (mod != 3) {
+            size_t displacement = mod == 1 ? 1 : (mod == 2 ? 4 : 0);
+
+            if (rm == 4) {
+               const uint8_t sib = *cursor++;
+
+               if (mod == 0 && (sib & 0x07) == 5) {
+                  displacement = 4;
+               }
+            }
+            else if (mod == 0 && rm == 5) {
+               displacement = 4;
+
+               // rip-relative in long mode, absolute address otherwise
+               if (kLongMode) {
+                  result.relative = static_cast <size_t> (cursor - code);
+               }
+            }
+            cursor += displacement;
+         }
+      }
+      else if (branch) {
+         result.relative = static_cast <size_t> (cursor - code);
+         cursor += 4;
+      }
+      cursor += extra;
+
+      result.length = static_cast <size_t> (cursor - code);
+
+      if (result.length > kMaxLength) {
+         return {};
+      }
+      return result;
+   }
+}
+
 template <typename T> class Detour final : public NonCopyable {
 private:
    enum : uint32_t {
@@ -58,6 +233,13 @@ private:
 #endif
    };
 
+   // room for relocated prologue (patch length plus the longest instruction) and the jump back
+   static constexpr size_t kTrampolineSize = 64;
+
+   // trampoline must be within reach of 32-bit displacements of relocated instructions
+   static constexpr uint64_t kTrampolineRange = 0x40000000;
+   static constexpr uint64_t kTrampolineStep = 0x10000;
+
 #if defined(CR_ARCH_X64)
    using uintptr = uint64_t;
 #else
@@ -80,11 +262,12 @@ private:
    };
 
 private:
-   Mutex cs_;
+   SpinLock cs_;
    void *original_ { nullptr };
    void *detour_ { nullptr };
    Array <uint8_t> savedBytes_ {};
    bool patched_ { false };
+   uint8_t *trampoline_ { nullptr }; // relocated prologue of the original, that jumps back past the patch
 
 #if defined(CR_ARCH_X64)
    Array <uint8_t> jmpBuffer_ { 0x48, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xe0 };
@@ -106,6 +289,8 @@ public:
 
    ~Detour () {
       restore ();
+      releaseTrampoline ();
+
       original_ = nullptr;
       detour_ = nullptr;
    }
@@ -140,7 +325,9 @@ public:
 #endif
    }
 
-   void install (void *detour, const bool enable = false) {
+   // with trampoline (the default), original is called through relocated copy of its prologue, and the
+   // patch stays in place, if the prologue can't be relocated, every call of original unpatches it
+   void install (void *detour, const bool enable = false, const bool trampoline = true) {
       if (!original_) {
          return;
       }
@@ -153,6 +340,12 @@ public:
       memcpy (savedBytes_.data (), original_, savedBytes_.length ());
       memcpy (reinterpret_cast <void *> (reinterpret_cast <uintptr> (jmpBuffer_.data ()) + JmpOffset), &detour_, PtrSize);
 
+      releaseTrampoline ();
+
+      if (trampoline && detour_) {
+         buildTrampoline ();
+      }
+
       if (enable) {
          this->detour ();
       }
@@ -166,6 +359,11 @@ public:
       return patched_;
    }
 
+   // whether original is called through trampoline, instead of unpatching on every call
+   bool hasTrampoline () const {
+      return trampoline_ != nullptr;
+   }
+
    bool detour () {
       if (!valid ()) {
          return false;
@@ -181,13 +379,165 @@ public:
    }
 
    template <typename... Args> decltype (auto) operator () (Args &&...args) {
+      if (trampoline_) {
+         return reinterpret_cast <T *> (trampoline_) (cr::forward <Args> (args)...);
+      }
       ScopedRestore sr { this };
       return reinterpret_cast <T *> (original_) (cr::forward <Args> (args)...);
    }
 
 private:
+   // read-write memory for trampoline, in long mode it's searched for near the original, so relocated
+   // relative operands still reach their targets
+   static uint8_t *allocateTrampoline (void *near) {
+#if defined(CR_ARCH_X64)
+      const auto origin = reinterpret_cast <uintptr> (near) & ~static_cast <uintptr> (kTrampolineStep - 1);
+
+      for (uintptr offset = kTrampolineStep; offset < kTrampolineRange; offset += kTrampolineStep) {
+         const uintptr below = origin > offset ? origin - offset : 0;
+
+         for (const auto hint : { below, origin + offset }) {
+            if (!hint) {
+               continue;
+            }
+
+            if (auto memory = mapTrampoline (reinterpret_cast <void *> (hint))) {
+               const auto address = reinterpret_cast <uintptr> (memory);
+               const auto distance = address > origin ? address - origin : origin - address;
+
+               if (distance < kTrampolineRange * 2) {
+                  return memory;
+               }
+               unmapTrampoline (memory);
+            }
+         }
+      }
+      return nullptr;
+#else
+      (void) near;
+      return mapTrampoline (nullptr);
+#endif
+   }
+
+   static uint8_t *mapTrampoline (void *hint) {
+#if defined(CR_WINDOWS)
+      return static_cast <uint8_t *> (VirtualAlloc (hint, kTrampolineSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+      auto memory = mmap (hint, kTrampolineSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (memory == MAP_FAILED) {
+         return nullptr;
+      }
+      return static_cast <uint8_t *> (memory);
+#endif
+   }
+
+   static void unmapTrampoline (uint8_t *memory) {
+#if defined(CR_WINDOWS)
+      VirtualFree (memory, 0, MEM_RELEASE);
+#else
+      munmap (memory, kTrampolineSize);
+#endif
+   }
+
+   // makes the trampoline executable, it's never written again
+   static bool sealTrampoline (uint8_t *memory, const size_t length) {
+#if defined(CR_WINDOWS)
+      unsigned long oldProtect {};
+
+      if (!VirtualProtect (memory, kTrampolineSize, PAGE_EXECUTE_READ, &oldProtect)) {
+         return false;
+      }
+      FlushInstructionCache (GetCurrentProcess (), memory, length);
+#else
+      if (mprotect (memory, kTrampolineSize, PROT_READ | PROT_EXEC) == -1) {
+         return false;
+      }
+#  if defined(CR_CXX_CLANG) || defined(CR_CXX_GCC)
+      __builtin___clear_cache (reinterpret_cast <char *> (memory), reinterpret_cast <char *> (memory) + length);
+#  else
+      (void) length;
+#  endif
+#endif
+      return true;
+   }
+
+   // copies whole instructions covered by the patch to the trampoline, fixing their relative operands,
+   // and appends a jump to the first instruction after them
+   bool buildTrampoline () {
+      auto source = static_cast <const uint8_t *> (original_);
+      size_t relocated = 0;
+
+      while (relocated < jmpBuffer_.length ()) {
+         const auto instruction = detail::decodeInstruction (source + relocated);
+
+         if (!instruction.length) {
+            return false;
+         }
+         relocated += instruction.length;
+      }
+      auto memory = allocateTrampoline (original_);
+
+      if (!memory) {
+         return false;
+      }
+      memcpy (memory, source, relocated);
+
+      for (size_t offset = 0; offset < relocated;) {
+         const auto instruction = detail::decodeInstruction (source + offset);
+
+         if (instruction.relative) {
+            int32_t displacement {};
+            memcpy (&displacement, source + offset + instruction.relative, sizeof (displacement));
+
+            const auto target = reinterpret_cast <intptr_t> (source + offset + instruction.length) + displacement;
+            const auto moved = target - reinterpret_cast <intptr_t> (memory + offset + instruction.length);
+
+            if (moved < INT32_MIN || moved > INT32_MAX) {
+               unmapTrampoline (memory);
+               return false;
+            }
+            displacement = static_cast <int32_t> (moved);
+            memcpy (memory + offset + instruction.relative, &displacement, sizeof (displacement));
+         }
+         offset += instruction.length;
+      }
+      auto jump = memory + relocated;
+      const auto resume = reinterpret_cast <uintptr> (source + relocated);
+
+#if defined(CR_ARCH_X64)
+      // jmp qword [rip + 0], followed by the address, doesn't touch any register
+      const uint8_t absoluteJump[] = { 0xff, 0x25, 0x00, 0x00, 0x00, 0x00 };
+
+      memcpy (jump, absoluteJump, sizeof (absoluteJump));
+      memcpy (jump + sizeof (absoluteJump), &resume, sizeof (resume));
+
+      const size_t length = relocated + sizeof (absoluteJump) + sizeof (resume);
+#else
+      const auto displacement = static_cast <int32_t> (resume - reinterpret_cast <uintptr> (jump + 5));
+
+      jump[0] = 0xe9;
+      memcpy (jump + 1, &displacement, sizeof (displacement));
+
+      const size_t length = relocated + 5;
+#endif
+      if (!sealTrampoline (memory, length)) {
+         unmapTrampoline (memory);
+         return false;
+      }
+      trampoline_ = memory;
+      return true;
+   }
+
+   void releaseTrampoline () {
+      if (trampoline_) {
+         unmapTrampoline (trampoline_);
+         trampoline_ = nullptr;
+      }
+   }
+
    bool patchMemory (const Array<uint8_t> &to, const bool patched) noexcept {
-      MutexScopedLock lock (cs_);
+      SpinScopedLock lock (cs_);
       patched_ = patched;
 
 #if defined(CR_WINDOWS)
@@ -203,7 +553,12 @@ private:
 #else
       auto pageAddr = reinterpret_cast <void *> (pageStart_);
 
-      if (mprotect (pageAddr, pageSize_, PROT_READ | PROT_WRITE) == -1) {
+      // patched bytes may cross into the next page
+      const auto patchEnd = reinterpret_cast <uintptr> (original_) + to.length ();
+      const auto protectSize = static_cast <size_t> (((patchEnd + pageSize_ - 1) & ~static_cast <uintptr> (pageSize_ - 1)) - pageStart_);
+
+      // keep the pages executable while writing, the code doing the patching may live on the same page
+      if (mprotect (pageAddr, protectSize, PROT_READ | PROT_WRITE | PROT_EXEC) == -1) {
          return false;
       }
       memcpy (original_, to.data (), to.length ());
@@ -215,7 +570,7 @@ private:
       );
 #endif
 
-      if (mprotect (pageAddr, pageSize_, PROT_READ | PROT_EXEC) == -1) {
+      if (mprotect (pageAddr, protectSize, PROT_READ | PROT_EXEC) == -1) {
          return false;
       }
 
@@ -68,7 +68,7 @@ public:
 
    bool getLine (String &line) {
       int ch = 0;
-      SmallArray <char> data (255);
+      InlineArray <char, 256> data;
 
       line.clear ();
 
@@ -269,7 +269,7 @@ public:
 
    bool getLine (String &line) {
       int ch = 0;
-      SmallArray <char> data (255);
+      InlineArray <char, 256> data;
 
       line.clear ();
 
@@ -438,6 +438,17 @@ public:
 #endif
    }
 
+   // calls fn with every remaining match, returns number of matches visited
+   size_t forEach (FunctionRef <void (const String &)> fn) {
+      size_t count = 0;
+
+      for (; *this; next ()) {
+         fn (getMatch ());
+         ++count;
+      }
+      return count;
+   }
+
    String getMatch () const {
       StringRef match {};
 
@@ -11,22 +11,38 @@
 #include <crlib/array.h>
 #include <crlib/string.h>
 #include <crlib/twin.h>
+#include <crlib/cpuflags.h>
+#include <crlib/mathlib.h>
 
 CR_NAMESPACE_BEGIN
 
 template <typename T> struct Hash;
 
-template <> struct Hash <String> {
-   uint32_t operator () (const String &key) const noexcept {
-      return key.hash ();
-   }
-};
+namespace detail {
+   // hashes and compares any string-like type through string ref, so lookups by string ref or
+   // by character pointer never build temporary string (both string types share the fnv1a hash)
+   struct StringHash {
+      using is_transparent = void;
 
-template <> struct Hash <StringRef> {
-   uint32_t operator () (const StringRef &key) const noexcept {
-      return key.hash ();
-   }
-};
+      uint32_t operator () (StringRef key) const noexcept {
+         return key.hash ();
+      }
+   };
+
+   struct StringKeyEqual {
+      using is_transparent = void;
+
+      bool operator () (StringRef a, StringRef b) const noexcept {
+         return a == b;
+      }
+   };
+
+   template <typename T, typename = void> struct is_transparent : false_type {};
+   template <typename T> struct is_transparent <T, void_t <typename T::is_transparent>> : true_type {};
+}
+
+template <> struct Hash <String> : detail::StringHash {};
+template <> struct Hash <StringRef> : detail::StringHash {};
 
 template <> struct Hash <const char *> {
    uint32_t operator () (const char *key) const noexcept {
@@ -63,6 +79,9 @@ template <typename T> struct KeyEqual {
    }
 };
 
+template <> struct KeyEqual <String> : detail::StringKeyEqual {};
+template <> struct KeyEqual <StringRef> : detail::StringKeyEqual {};
+
 template <> struct KeyEqual <const char *> {
    bool operator () (const char *a, const char *b) const noexcept {
       if (a == b) {
@@ -76,455 +95,643 @@ template <> struct KeyEqual <const char *> {
 };
 
 namespace detail {
-   enum class HashEntryStatus : uint8_t {
-      Empty,
-      Occupied,
-      Deleted
+   // control byte states, full slots keep the low 7 bits of the hash instead
+   struct HashCtrl final {
+      static constexpr int8_t kEmpty = -128;
+      static constexpr int8_t kDeleted = -2;
+
+      static constexpr bool isFull (int8_t ctrl) noexcept {
+         return ctrl >= 0;
+      }
    };
 
-   template <typename K, typename V> struct HashEntry final : NonCopyable {
-      K key {};
-      V val {};
-      uint32_t hash {};
+   // group of control bytes probed at once, matches are returned as bit mask (bit per slot)
+   class HashGroup final {
+   public:
+      static constexpr size_t kWidth = 16;
 
-      HashEntryStatus status { HashEntryStatus::Empty };
+   private:
+#if defined(CR_HAS_SIMD_SSE) || defined(CR_HAS_SIMD_NEON)
+      __m128i ctrl_;
+#else
+      const int8_t *ctrl_;
+#endif
 
-      HashEntry () = default;
-      ~HashEntry () = default;
+   public:
+#if defined(CR_HAS_SIMD_SSE) || defined(CR_HAS_SIMD_NEON)
+      explicit HashGroup (const int8_t *ctrl) noexcept : ctrl_ (_mm_loadu_si128 (reinterpret_cast <const __m128i *> (ctrl))) {}
 
-      HashEntry (HashEntry &&rhs) noexcept
-         : key (cr::move (rhs.key)), val (cr::move (rhs.val)), hash (rhs.hash), status (rhs.status) {
+      uint32_t match (int8_t h2) const noexcept {
+         return static_cast <uint32_t> (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_set1_epi8 (h2), ctrl_)));
       }
 
-      HashEntry &operator = (HashEntry &&rhs) noexcept {
-         if (this != &rhs) {
-            key = cr::move (rhs.key);
-            val = cr::move (rhs.val);
-            hash = rhs.hash;
-            status = rhs.status;
-         }
-         return *this;
+      uint32_t matchEmptyOrDeleted () const noexcept {
+         return static_cast <uint32_t> (_mm_movemask_epi8 (_mm_cmplt_epi8 (ctrl_, _mm_set1_epi8 (-1))));
       }
-   };
-};
-
-template <typename K, typename V, typename H = Hash <K>, typename E = KeyEqual <K>> class HashMap {
-private:
-   using Entry = detail::HashEntry <K, V>;
-   using Status = detail::HashEntryStatus;
+#elif defined(CR_HAS_SIMD_RVV)
+      explicit HashGroup (const int8_t *ctrl) noexcept : ctrl_ (ctrl) {}
 
-   H hash_ {};
-   E equal_ {};
-   size_t length_ {};
-   Array <Entry> contents_ {};
+      uint32_t match (int8_t h2) const noexcept {
+         return toMask (__riscv_vmseq_vx_i8m1_b8 (__riscv_vle8_v_i8m1 (ctrl_, kWidth), h2, kWidth));
+      }
 
-   static constexpr size_t kInitialSize = 8;
-   static constexpr float kLoadFactor = 0.5f;
-   static constexpr size_t kMaxSize = 1 << 24;
-   static constexpr size_t kInvalidIndex = static_cast <size_t> (-1);
+      uint32_t matchEmptyOrDeleted () const noexcept {
+         return toMask (__riscv_vmslt_vx_i8m1_b8 (__riscv_vle8_v_i8m1 (ctrl_, kWidth), -1, kWidth));
+      }
 
-private:
-   struct PositionResult {
-      size_t index;
-      bool found;
-   };
+   private:
+      static uint32_t toMask (vbool8_t mask) noexcept {
+         uint8_t bits[kWidth / 8] {};
+         __riscv_vsm_v_b8 (bits, mask, kWidth);
 
-   PositionResult findPosition (const K &key, uint32_t hashValue) const noexcept {
-      if (contents_.empty ()) {
-         return { 0, false };
+         return static_cast <uint32_t> (bits[0]) | (static_cast <uint32_t> (bits[1]) << 8);
       }
 
-      size_t mask = contents_.length () - 1;
-      size_t index = hashValue & mask;
-      size_t step = 0;
-      size_t firstDeleted = kInvalidIndex;
+   public:
+#else
+      explicit HashGroup (const int8_t *ctrl) noexcept : ctrl_ (ctrl) {}
 
-      while (step < contents_.length ()) {
-         const auto &entry = contents_[index];
+      uint32_t match (int8_t h2) const noexcept {
+         uint32_t mask {};
 
-         if (entry.status == Status::Empty) {
-            if (firstDeleted != kInvalidIndex) {
-               return { firstDeleted, false };
-            }
-            return { index, false };
+         for (size_t i = 0; i < kWidth; ++i) {
+            mask |= static_cast <uint32_t> (ctrl_[i] == h2) << i;
          }
+         return mask;
+      }
 
-         if (entry.status == Status::Deleted) {
-            if (firstDeleted == kInvalidIndex) {
-               firstDeleted = index;
-            }
-         }
-         else if (entry.hash == hashValue && equal_ (entry.key, key)) {
-            return { index, true };
-         }
+      uint32_t matchEmptyOrDeleted () const noexcept {
+         uint32_t mask {};
 
-         ++step;
-         index = (hashValue + step * (step + 1) / 2) & mask;
+         for (size_t i = 0; i < kWidth; ++i) {
+            mask |= static_cast <uint32_t> (ctrl_[i] < -1) << i;
+         }
+         return mask;
       }
+#endif
 
-      if (firstDeleted != kInvalidIndex) {
-         return { firstDeleted, false };
+      uint32_t matchEmpty () const noexcept {
+         return match (HashCtrl::kEmpty);
       }
+   };
 
-      return { 0, false };
-   }
+   template <typename K, typename V> struct HashEntry final {
+      using Reference = Twin <const K &, V &>;
+      using ConstReference = Twin <const K &, const V &>;
 
-   bool needsRehash () const noexcept {
-      return length_ >= size_t (contents_.length () * kLoadFactor);
-   }
+      K key;
+      V val;
 
-   void rehashTo (size_t newSize) noexcept {
-      auto oldContents = cr::move (contents_);
+      template <typename U, typename ...Args> HashEntry (U &&key, Args &&...args)
+         : key (cr::forward <U> (key)), val (cr::forward <Args> (args)...) {
+      }
 
-      if (newSize > kMaxSize) {
-         newSize = kMaxSize;
+      HashEntry (HashEntry &&rhs) noexcept
+         : key (cr::move (rhs.key)), val (cr::move (rhs.val)) {
       }
 
-      if (!contents_.resize (newSize)) {
-         contents_ = cr::move (oldContents);
-         return;
+      ~HashEntry () = default;
+
+      Reference view () noexcept {
+         return { key, val };
       }
 
-      for (auto &entry : contents_) {
-         entry.status = Status::Empty;
+      ConstReference view () const noexcept {
+         return { key, val };
       }
-      length_ = 0;
+   };
+
+   // open addressing table, keeps control bytes separately from the slots, so probing touches
+   // only the control bytes, which are matched a whole group at once, slots must have a key member
+   template <typename K, typename Slot, typename H, typename E, typename A> class HashTable : public NonCopyable, private A {
+   private:
+      using Ctrl = HashCtrl;
+      using Group = HashGroup;
 
-      for (auto &oldEntry : oldContents) {
-         if (oldEntry.status == Status::Occupied) {
-            uint32_t hashValue = oldEntry.hash;
+      static constexpr size_t kInitialSize = Group::kWidth;
+      static constexpr size_t kMaxSize = 1 << 24;
 
-            size_t index = hashValue & (contents_.length () - 1);
-            size_t mask = contents_.length () - 1;
+   protected:
+      static constexpr size_t kInvalidIndex = static_cast <size_t> (-1);
 
-            size_t step = 0;
-            while (contents_[index].status == Status::Occupied) {
-               ++step;
-               index = (hashValue + step * (step + 1) / 2) & mask;
-            }
+      // lookups take any key-compatible type as is, if both hash and equality are transparent
+      template <typename Q> using IfTransparent = enable_if_t <is_transparent <H>::value && is_transparent <E>::value && !is_same <Q, K>::value, int>;
 
-            contents_[index].key = cr::move (oldEntry.key);
-            contents_[index].val = cr::move (oldEntry.val);
-            contents_[index].hash = hashValue;
-            contents_[index].status = Status::Occupied;
+   protected:
+      H hash_ {};
+      E equal_ {};
+      int8_t *ctrl_ {};
+      Slot *slots_ {};
+      size_t capacity_ {};
+      size_t length_ {};
+      size_t deleted_ {};
 
-            ++length_;
-         }
+   private:
+      static constexpr int8_t h2 (uint32_t hashValue) noexcept {
+         return static_cast <int8_t> (hashValue & 0x7f);
       }
-   }
 
-   void rehash () noexcept {
-      size_t newSize = contents_.empty () ? kInitialSize :
-         nextPowerOfTwo (contents_.length () * 2);
+      size_t findInsertIndex (uint32_t hashValue) const noexcept {
+         const size_t groupMask = capacity_ / Group::kWidth - 1;
+         size_t group = (hashValue >> 7) & groupMask;
 
-      rehashTo (newSize);
-   }
+         for (size_t step = 0; step <= groupMask;) {
+            const size_t base = group * Group::kWidth;
 
-   static size_t nextPowerOfTwo (size_t n) noexcept {
-      if (n <= 2) {
-         return 2;
+            if (auto mask = Group (ctrl_ + base).matchEmptyOrDeleted ()) {
+               return base + cr::countr_zero (mask);
+            }
+            group = (group + ++step) & groupMask;
+         }
+         return kInvalidIndex;
       }
-      return cr::bit_ceil (n);
-   }
 
-public:
-   HashMap () {
-      contents_.resize (kInitialSize);
-   }
+      size_t growthLimit () const noexcept {
+         return capacity_ - capacity_ / 8;
+      }
 
-   HashMap (HashMap &&rhs) noexcept
-      : hash_ (cr::move (rhs.hash_)), equal_ (cr::move (rhs.equal_)), length_ (rhs.length_), contents_ (cr::move (rhs.contents_)) {
-      rhs.length_ = 0;
-   }
+      bool needsRehash () const noexcept {
+         return length_ + deleted_ >= growthLimit ();
+      }
 
-   HashMap (std::initializer_list <Twin <K, V>> list) {
-      const size_t cap = nextPowerOfTwo (list.size ());
-      contents_.resize (cap > kInitialSize ? cap : kInitialSize);
+      void allocate (size_t size) noexcept {
+         ctrl_ = allocator ().template allocate <int8_t> (size);
+         slots_ = allocator ().template allocate <Slot> (size);
+         capacity_ = size;
+         deleted_ = 0;
 
-      for (const auto &elem : list) {
-         operator[] (elem.first) = cr::move (elem.second);
+         memset (ctrl_, Ctrl::kEmpty, size);
       }
-   }
 
-   ~HashMap () = default;
+      void destroy () noexcept {
+         for (size_t i = 0; i < capacity_; ++i) {
+            if (Ctrl::isFull (ctrl_[i])) {
+               mem::destruct (&slots_[i]);
+            }
+         }
+         allocator ().release (ctrl_, capacity_);
+         allocator ().release (slots_, capacity_);
 
-   HashMap &operator = (HashMap &&rhs) noexcept {
-      if (this != &rhs) {
-         contents_ = cr::move (rhs.contents_);
-         length_ = rhs.length_;
-         hash_ = cr::move (rhs.hash_);
-         equal_ = cr::move (rhs.equal_);
-         rhs.length_ = 0;
+         reset ();
       }
-      return *this;
-   }
 
-public:
-   template <bool IsConst> class HashMapIterator {
-   private:
-      using EntryType = typename cr::conditional<IsConst, const Entry, Entry>::type;
+      void reset () noexcept {
+         ctrl_ = nullptr;
+         slots_ = nullptr;
+         capacity_ = 0;
+         length_ = 0;
+         deleted_ = 0;
+      }
 
-      EntryType *current_ {};
-      EntryType *end_ {};
+      void rehashTo (size_t newSize) noexcept {
+         auto oldCtrl = ctrl_;
+         auto oldSlots = slots_;
+         auto oldCapacity = capacity_;
 
-      void advanceToNextOccupied () noexcept {
-         while (current_ != end_ && current_->status != Status::Occupied) {
-            ++current_;
+         allocate (cr::clamp (nextPowerOfTwo (newSize), kInitialSize, kMaxSize));
+
+         for (size_t i = 0; i < oldCapacity; ++i) {
+            if (!Ctrl::isFull (oldCtrl[i])) {
+               continue;
+            }
+            const uint32_t hashValue = hashOf (oldSlots[i].key);
+            const size_t index = findInsertIndex (hashValue);
+
+            ctrl_[index] = h2 (hashValue);
+
+            mem::construct (&slots_[index], cr::move (oldSlots[i]));
+            mem::destruct (&oldSlots[i]);
          }
+         allocator ().release (oldCtrl, oldCapacity);
+         allocator ().release (oldSlots, oldCapacity);
       }
 
-   public:
-      using ValueType = typename cr::conditional <IsConst,
-         cr::Twin <const K &, const V &>, cr::Twin <const K &, V &>>::type;
+      void rehash () noexcept {
+         rehashTo (capacity_ * 2);
+      }
 
-      using Reference = ValueType;
-      using Pointer = void;
+      void swapSlots (size_t a, size_t b) noexcept {
+         Slot temp (cr::move (slots_[a]));
+         mem::destruct (&slots_[a]);
 
-      HashMapIterator (EntryType *current, EntryType *end)
-         : current_ (current), end_ (end) {
+         mem::construct (&slots_[a], cr::move (slots_[b]));
+         mem::destruct (&slots_[b]);
 
-         advanceToNextOccupied ();
+         mem::construct (&slots_[b], cr::move (temp));
       }
 
-      Reference operator * () const noexcept {
-         return Reference (current_->key, current_->val);
-      }
+      // drops all the tombstones in place, every entry is moved to the first group of its probe
+      // sequence that has room, entries pending the move are marked as deleted meanwhile
+      void compact () noexcept {
+         for (size_t i = 0; i < capacity_; ++i) {
+            ctrl_[i] = Ctrl::isFull (ctrl_[i]) ? Ctrl::kDeleted : Ctrl::kEmpty;
+         }
 
-      HashMapIterator &operator ++ () noexcept {
-         ++current_;
-         advanceToNextOccupied ();
+         for (size_t i = 0; i < capacity_; ++i) {
+            if (ctrl_[i] != Ctrl::kDeleted) {
+               continue;
+            }
+            const uint32_t hashValue = hashOf (slots_[i].key);
+            const size_t target = findInsertIndex (hashValue);
 
-         return *this;
-      }
+            if (target / Group::kWidth == i / Group::kWidth) {
+               ctrl_[i] = h2 (hashValue);
+               continue;
+            }
 
-      HashMapIterator operator ++ (int) noexcept {
-         HashMapIterator tmp = *this;
-         ++(*this);
+            if (ctrl_[target] == Ctrl::kEmpty) {
+               mem::construct (&slots_[target], cr::move (slots_[i]));
+               mem::destruct (&slots_[i]);
 
-         return tmp;
+               ctrl_[i] = Ctrl::kEmpty;
+            }
+            else {
+               // target holds entry that is still pending, so swap and process this slot once more
+               swapSlots (i, target);
+               --i;
+            }
+            ctrl_[target] = h2 (hashValue);
+         }
+         deleted_ = 0;
       }
 
-      bool operator == (const HashMapIterator &other) const noexcept {
-         return current_ == other.current_;
+      static size_t nextPowerOfTwo (size_t n) noexcept {
+         if (n <= 2) {
+            return 2;
+         }
+         return cr::bit_ceil (n);
       }
 
-      bool operator != (const HashMapIterator &other) const noexcept {
-         return !(*this == other);
+   protected:
+      // spreads weak hashes (like identity one), so both group index and control byte get good bits
+      template <typename Q> uint32_t hashOf (const Q &key) const noexcept {
+         return hash_ (key) * 0x9e3779b1u;
       }
-   };
 
-   using iterator = HashMapIterator<false>;
-   using const_iterator = HashMapIterator<true>;
+      template <typename Q> size_t findIndex (const Q &key, uint32_t hashValue) const noexcept {
+         if (!capacity_) {
+            return kInvalidIndex;
+         }
+         const size_t groupMask = capacity_ / Group::kWidth - 1;
+         size_t group = (hashValue >> 7) & groupMask;
 
-   iterator begin () noexcept {
-      return iterator (contents_.data (), contents_.data () + contents_.length ());
-   }
+         for (size_t step = 0; step <= groupMask;) {
+            const size_t base = group * Group::kWidth;
+            const Group probe (ctrl_ + base);
 
-   iterator end () noexcept {
-      return iterator (contents_.data () + contents_.length (), contents_.data () + contents_.length ());
-   }
+            for (auto mask = probe.match (h2 (hashValue)); mask; mask &= mask - 1) {
+               const size_t index = base + cr::countr_zero (mask);
 
-   const_iterator begin () const noexcept {
-      return cbegin ();
-   }
+               if (equal_ (slots_[index].key, key)) {
+                  return index;
+               }
+            }
 
-   const_iterator end () const noexcept {
-      return cend ();
-   }
+            // key would have been placed here, if it was ever inserted
+            if (probe.matchEmpty ()) {
+               return kInvalidIndex;
+            }
+            group = (group + ++step) & groupMask;
+         }
+         return kInvalidIndex;
+      }
 
-   const_iterator cbegin () const noexcept {
-      return const_iterator (contents_.data (), contents_.data () + contents_.length ());
-   }
+      template <typename Q> size_t findIndex (const Q &key) const noexcept {
+         return findIndex (key, hashOf (key));
+      }
 
-   const_iterator cend () const noexcept {
-      return const_iterator (contents_.data () + contents_.length (), contents_.data () + contents_.length ());
-   }
+      // reserves slot for the new key, growing the table if needed, slot is left for caller to construct
+      size_t prepareInsert (uint32_t hashValue) noexcept {
+         if (needsRehash ()) {
+            // mostly tombstones, so dropping them gives enough room without growing
+            if (deleted_ > 0 && length_ <= growthLimit () / 2) {
+               compact ();
+            }
+            else {
+               rehash ();
+            }
+         }
+         const size_t index = findInsertIndex (hashValue);
 
-public:
-   V &operator [] (const K &key) noexcept {
-      if (contents_.empty ()) {
-         rehash ();
+         if (ctrl_[index] == Ctrl::kDeleted) {
+            --deleted_;
+         }
+         ctrl_[index] = h2 (hashValue);
+         ++length_;
 
-         if (contents_.empty ()) {
-            contents_.resize (kInitialSize);
+         return index;
+      }
+
+      // inserts slot constructed from args, unless the key is already there
+      template <typename Q, typename ...Args> bool emplaceUnique (const Q &key, Args &&...args) noexcept {
+         const uint32_t hashValue = hashOf (key);
+
+         if (findIndex (key, hashValue) != kInvalidIndex) {
+            return false;
          }
+         const size_t index = prepareInsert (hashValue);
+         mem::construct (&slots_[index], key, cr::forward <Args> (args)...);
+
+         return true;
       }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+      void eraseAt (size_t index) noexcept {
+         mem::destruct (&slots_[index]);
 
-      if (!result.found) {
-         if (needsRehash ()) {
-            rehash ();
-            result = findPosition (key, hashValue);
+         // probe sequences pass only full groups, so if the group still has empty slot
+         // nothing ever probed past it, and the slot may become empty instead of tombstone
+         if (Group (ctrl_ + index / Group::kWidth * Group::kWidth).matchEmpty ()) {
+            ctrl_[index] = Ctrl::kEmpty;
          }
-         contents_[result.index].key = key;
-         contents_[result.index].hash = hashValue;
-         contents_[result.index].status = Status::Occupied;
-         ++length_;
+         else {
+            ctrl_[index] = Ctrl::kDeleted;
+            ++deleted_;
+         }
+         --length_;
       }
-      return contents_[result.index].val;
-   }
 
-   bool insert (const K &key, const V &val) noexcept {
-      if (contents_.empty ()) {
-         rehash ();
+      template <typename Q> size_t eraseKey (const Q &key) noexcept {
+         const size_t index = findIndex (key);
 
-         if (contents_.empty ()) {
-            return false;
+         if (index == kInvalidIndex) {
+            return 0;
          }
+         eraseAt (index);
+
+         return 1;
       }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+      bool occupied (size_t index) const noexcept {
+         return Ctrl::isFull (ctrl_[index]);
+      }
 
-      if (result.found) {
-         return false;
+   public:
+      HashTable () {
+         allocate (kInitialSize);
       }
 
-      if (needsRehash ()) {
-         rehash ();
-         result = findPosition (key, hashValue);
+      explicit HashTable (size_t capacity) {
+         allocate (cr::clamp (nextPowerOfTwo (capacity), kInitialSize, kMaxSize));
+      }
 
-         if (result.found) {
-            return false;
+      explicit HashTable (const A &allocator) : A (allocator) {
+         allocate (kInitialSize);
+      }
+
+      HashTable (HashTable &&rhs) noexcept
+         : A (cr::move (rhs.allocator ())), hash_ (cr::move (rhs.hash_)), equal_ (cr::move (rhs.equal_)), ctrl_ (rhs.ctrl_), slots_ (rhs.slots_), capacity_ (rhs.capacity_), length_ (rhs.length_), deleted_ (rhs.deleted_) {
+         rhs.reset ();
+      }
+
+      ~HashTable () {
+         destroy ();
+      }
+
+      HashTable &operator = (HashTable &&rhs) noexcept {
+         if (this != &rhs) {
+            destroy ();
+
+            allocator () = cr::move (rhs.allocator ());
+            hash_ = cr::move (rhs.hash_);
+            equal_ = cr::move (rhs.equal_);
+            ctrl_ = rhs.ctrl_;
+            slots_ = rhs.slots_;
+            capacity_ = rhs.capacity_;
+            length_ = rhs.length_;
+            deleted_ = rhs.deleted_;
+
+            rhs.reset ();
          }
+         return *this;
       }
 
-      contents_[result.index].key = key;
-      contents_[result.index].val = val;
-      contents_[result.index].hash = hashValue;
-      contents_[result.index].status = Status::Occupied;
-      ++length_;
+   public:
+      template <bool IsConst> class HashTableIterator {
+      private:
+         using SlotType = typename cr::conditional <IsConst, const Slot, Slot>::type;
+
+         const int8_t *ctrl_ {};
+         const int8_t *end_ {};
+         SlotType *current_ {};
+
+         void advanceToNextOccupied () noexcept {
+            while (ctrl_ != end_ && !Ctrl::isFull (*ctrl_)) {
+               ++ctrl_;
+               ++current_;
+            }
+         }
+
+      public:
+         using ValueType = typename cr::conditional <IsConst, typename Slot::ConstReference, typename Slot::Reference>::type;
 
-      return true;
-   }
+         using Reference = ValueType;
+         using Pointer = void;
 
-   bool insert (const K &key, V &&val) noexcept {
-      if (contents_.empty ()) {
-         rehash ();
+         HashTableIterator (const int8_t *ctrl, const int8_t *end, SlotType *current)
+            : ctrl_ (ctrl), end_ (end), current_ (current) {
 
-         if (contents_.empty ()) {
-            return false;
+            advanceToNextOccupied ();
+         }
+
+         Reference operator * () const noexcept {
+            return current_->view ();
+         }
+
+         HashTableIterator &operator ++ () noexcept {
+            ++ctrl_;
+            ++current_;
+            advanceToNextOccupied ();
+
+            return *this;
+         }
+
+         HashTableIterator operator ++ (int) noexcept {
+            HashTableIterator tmp = *this;
+            ++(*this);
+
+            return tmp;
+         }
+
+         bool operator == (const HashTableIterator &other) const noexcept {
+            return ctrl_ == other.ctrl_;
+         }
+
+         bool operator != (const HashTableIterator &other) const noexcept {
+            return !(*this == other);
          }
+      };
+
+      using iterator = HashTableIterator <false>;
+      using const_iterator = HashTableIterator <true>;
+
+      iterator begin () noexcept {
+         return iterator (ctrl_, ctrl_ + capacity_, slots_);
       }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+      iterator end () noexcept {
+         return iterator (ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+      }
 
-      if (result.found) {
-         return false;
+      const_iterator begin () const noexcept {
+         return cbegin ();
       }
 
-      if (needsRehash ()) {
-         rehash ();
-         result = findPosition (key, hashValue);
+      const_iterator end () const noexcept {
+         return cend ();
+      }
 
-         if (result.found) {
-            return false;
-         }
+      const_iterator cbegin () const noexcept {
+         return const_iterator (ctrl_, ctrl_ + capacity_, slots_);
       }
 
-      contents_[result.index].key = key;
-      contents_[result.index].val = cr::move (val);
-      contents_[result.index].hash = hashValue;
-      contents_[result.index].status = Status::Occupied;
-      ++length_;
+      const_iterator cend () const noexcept {
+         return const_iterator (ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+      }
 
-      return true;
-   }
+   public:
+      void clear () noexcept {
+         for (size_t i = 0; i < capacity_; ++i) {
+            if (Ctrl::isFull (ctrl_[i])) {
+               mem::destruct (&slots_[i]);
+            }
+         }
+         length_ = 0;
+         deleted_ = 0;
 
-   size_t erase (const K &key) noexcept {
-      if (contents_.empty ()) {
-         return 0;
+         if (ctrl_) {
+            memset (ctrl_, Ctrl::kEmpty, capacity_);
+         }
       }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+      void zap () noexcept {
+         destroy ();
+         allocate (kInitialSize);
+      }
 
-      if (!result.found) {
-         return 0;
+      constexpr size_t length () const noexcept {
+         return length_;
       }
 
-      contents_[result.index].status = Status::Deleted;
-      --length_;
+      constexpr bool empty () const noexcept {
+         return length_ == 0;
+      }
 
-      return 1;
-   }
+      A &allocator () noexcept {
+         return *this;
+      }
 
-   bool exists (const K &key) const noexcept {
-      if (contents_.empty ()) {
-         return false;
+      const A &allocator () const noexcept {
+         return *this;
       }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+      size_t capacity () const noexcept {
+         return capacity_;
+      }
 
-      return result.found;
-   }
+      // makes room for n entries without rehashing, table grows at 7/8 full, so it's sized to n * 8 / 7
+      void reserve (size_t n) noexcept {
+         n = nextPowerOfTwo (n + (n + 6) / 7);
 
-   V *find (const K &key) noexcept {
-      if (contents_.empty ()) {
-         return nullptr;
+         if (n > capacity_) {
+            rehashTo (n);
+         }
       }
+   };
+};
+
+// open addressing hash map built on the control byte table
+template <typename K, typename V, typename H = Hash <K>, typename E = KeyEqual <K>, typename A = mem::Allocator> class HashMap final : public detail::HashTable <K, detail::HashEntry <K, V>, H, E, A> {
+private:
+   using Table = detail::HashTable <K, detail::HashEntry <K, V>, H, E, A>;
+   using Table::kInvalidIndex;
+   using Table::slots_;
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+   template <typename Q> using IfTransparent = typename Table::template IfTransparent <Q>;
 
-      if (!result.found) {
-         return nullptr;
+private:
+   template <typename Q> V &findOrInsert (const Q &key) noexcept {
+      const uint32_t hashValue = this->hashOf (key);
+      size_t index = this->findIndex (key, hashValue);
+
+      if (index == kInvalidIndex) {
+         index = this->prepareInsert (hashValue);
+         mem::construct (&slots_[index], key);
       }
-      return &contents_[result.index].val;
+      return slots_[index].val;
    }
 
-   const V *find (const K &key) const noexcept {
-      if (contents_.empty ()) {
+   template <typename Q> V *findValue (const Q &key) const noexcept {
+      const size_t index = this->findIndex (key);
+
+      if (index == kInvalidIndex) {
          return nullptr;
       }
+      return &slots_[index].val;
+   }
 
-      uint32_t hashValue = hash_ (key);
-      auto result = findPosition (key, hashValue);
+public:
+   HashMap () = default;
+   HashMap (HashMap &&rhs) noexcept = default;
 
-      if (!result.found) {
-         return nullptr;
+   explicit HashMap (const A &allocator) : Table (allocator) {}
+
+   HashMap (std::initializer_list <Twin <K, V>> list) : Table (list.size () * 2) {
+      for (const auto &elem : list) {
+         operator[] (elem.first) = cr::move (elem.second);
       }
-      return &contents_[result.index].val;
    }
 
-   void clear () noexcept {
-      length_ = 0;
+   ~HashMap () = default;
 
-      for (auto &entry : contents_) {
-         entry.status = Status::Empty;
-      }
+   HashMap &operator = (HashMap &&rhs) noexcept = default;
+
+public:
+   V &operator [] (const K &key) noexcept {
+      return findOrInsert (key);
    }
 
-   void zap () noexcept {
-      clear ();
+   template <typename Q, IfTransparent <Q> = 0> V &operator [] (const Q &key) noexcept {
+      return findOrInsert (key);
+   }
 
-      contents_.clear ();
-      contents_.resize (kInitialSize);
-      contents_.shrink ();
+   bool insert (const K &key, const V &val) noexcept {
+      return this->emplaceUnique (key, val);
    }
 
-   constexpr size_t length () const noexcept {
-      return length_;
+   bool insert (const K &key, V &&val) noexcept {
+      return this->emplaceUnique (key, cr::move (val));
    }
 
-   constexpr bool empty () const noexcept {
-      return length_ == 0;
+   size_t erase (const K &key) noexcept {
+      return this->eraseKey (key);
    }
 
-   size_t capacity () const noexcept {
-      return contents_.length ();
+   template <typename Q, IfTransparent <Q> = 0> size_t erase (const Q &key) noexcept {
+      return this->eraseKey (key);
    }
 
-   void reserve (size_t n) noexcept {
-      n = nextPowerOfTwo (n);
+   bool exists (const K &key) const noexcept {
+      return this->findIndex (key) != kInvalidIndex;
+   }
 
-      if (n > contents_.length ()) {
-         rehashTo (n);
-      }
+   template <typename Q, IfTransparent <Q> = 0> bool exists (const Q &key) const noexcept {
+      return this->findIndex (key) != kInvalidIndex;
+   }
+
+   V *find (const K &key) noexcept {
+      return findValue (key);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> V *find (const Q &key) noexcept {
+      return findValue (key);
+   }
+
+   const V *find (const K &key) const noexcept {
+      return findValue (key);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> const V *find (const Q &key) const noexcept {
+      return findValue (key);
    }
 };
 
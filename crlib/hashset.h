@@ -0,0 +1,154 @@
+//
+// crlib, simple class library for private needs.
+// Copyright © RWSH Solutions LLC <lab@rwsh.ru>.
+//
+// SPDX-License-Identifier: MIT
+//
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <crlib/hashmap.h>
+
+CR_NAMESPACE_BEGIN
+
+namespace detail {
+   template <typename K> struct HashSetEntry final {
+      using Reference = const K &;
+      using ConstReference = const K &;
+
+      K key;
+
+      template <typename U> explicit HashSetEntry (U &&key) : key (cr::forward <U> (key)) {
+      }
+
+      HashSetEntry (HashSetEntry &&rhs) noexcept : key (cr::move (rhs.key)) {
+      }
+
+      ~HashSetEntry () = default;
+
+      const K &view () const noexcept {
+         return key;
+      }
+   };
+}
+
+// open addressing hash set, shares the control byte table with hash map, but stores keys only
+template <typename K, typename H = Hash <K>, typename E = KeyEqual <K>, typename A = mem::Allocator> class HashSet final : public detail::HashTable <K, detail::HashSetEntry <K>, H, E, A> {
+private:
+   using Table = detail::HashTable <K, detail::HashSetEntry <K>, H, E, A>;
+   using Table::kInvalidIndex;
+
+   template <typename Q> using IfTransparent = typename Table::template IfTransparent <Q>;
+
+   // bulk insertion accepts any range, that yields keys (arrays, sets, initializer lists)
+   template <typename R> using IfRange = enable_if_t <is_same <remove_cv_t <remove_reference_t <decltype (*cr::declval <const R &> ().begin ())>>, K>::value, int>;
+
+public:
+   HashSet () = default;
+   HashSet (HashSet &&rhs) noexcept = default;
+
+   explicit HashSet (const A &allocator) : Table (allocator) {}
+
+   HashSet (std::initializer_list <K> list) : Table (list.size () * 2) {
+      insert (list);
+   }
+
+   ~HashSet () = default;
+
+   HashSet &operator = (HashSet &&rhs) noexcept = default;
+
+public:
+   bool insert (const K &key) noexcept {
+      return this->emplaceUnique (key);
+   }
+
+   bool insert (K &&key) noexcept {
+      const uint32_t hashValue = this->hashOf (key);
+
+      if (this->findIndex (key, hashValue) != kInvalidIndex) {
+         return false;
+      }
+      const size_t index = this->prepareInsert (hashValue);
+      mem::construct (&this->slots_[index], cr::move (key));
+
+      return true;
+   }
+
+   // returns number of keys, that were not in the set before
+   template <typename R, IfRange <R> = 0> size_t insert (const R &range) noexcept {
+      size_t inserted = 0;
+
+      for (const auto &key : range) {
+         inserted += insert (key);
+      }
+      return inserted;
+   }
+
+   size_t erase (const K &key) noexcept {
+      return this->eraseKey (key);
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> size_t erase (const Q &key) noexcept {
+      return this->eraseKey (key);
+   }
+
+   bool contains (const K &key) const noexcept {
+      return this->findIndex (key) != kInvalidIndex;
+   }
+
+   template <typename Q, IfTransparent <Q> = 0> bool contains (const Q &key) const noexcept {
+      return this->findIndex (key) != kInvalidIndex;
+   }
+
+public:
+   // adds all the keys of rhs, returns number of keys added
+   size_t unite (const HashSet &rhs) noexcept {
+      if (&rhs == this) {
+         return 0;
+      }
+      this->reserve (this->length_ + rhs.length_);
+
+      return insert (rhs);
+   }
+
+   // keeps only the keys that are also in rhs, returns number of keys removed
+   size_t intersect (const HashSet &rhs) noexcept {
+      size_t removed = 0;
+
+      // erase never moves other slots, so it's safe to erase while scanning
+      for (size_t i = 0; i < this->capacity_; ++i) {
+         if (this->occupied (i) && !rhs.contains (this->slots_[i].key)) {
+            this->eraseAt (i);
+            ++removed;
+         }
+      }
+      return removed;
+   }
+
+   static HashSet unionOf (const HashSet &a, const HashSet &b) noexcept {
+      HashSet result (a.allocator ());
+      result.reserve (a.length () + b.length ());
+
+      result.insert (a);
+      result.insert (b);
+
+      return result;
+   }
+
+   static HashSet intersectionOf (const HashSet &a, const HashSet &b) noexcept {
+      const auto &smaller = a.length () < b.length () ? a : b;
+      const auto &larger = a.length () < b.length () ? b : a;
+
+      HashSet result (a.allocator ());
+
+      for (const auto &key : smaller) {
+         if (larger.contains (key)) {
+            result.insert (key);
+         }
+      }
+      return result;
+   }
+};
+
+CR_NAMESPACE_END
@@ -296,7 +296,7 @@ private:
 
    bool initialized_ {};
    bool hasConnection_ {};
-   Mutex connectionMutex_;
+   SpinLock connectionMutex_;
 
 public:
    HttpClient () = default;
@@ -310,7 +310,7 @@ private:
    }
 
    bool checkConnection () {
-      MutexScopedLock lock (connectionMutex_);
+      SpinScopedLock lock (connectionMutex_);
       return hasConnection_;
    }
 
@@ -387,12 +387,12 @@ public:
       initialized_ = true;
 
       if (hostCheck.empty ()) {
-         MutexScopedLock lock (connectionMutex_);
+         SpinScopedLock lock (connectionMutex_);
          hasConnection_ = true;
          return;
       }
       {
-         MutexScopedLock lock (connectionMutex_);
+         SpinScopedLock lock (connectionMutex_);
          hasConnection_ = false;
       }
       String hostCopy { hostCheck };
@@ -403,9 +403,10 @@ public:
          socket->setTimeout (timeout);
 
          const bool connected = socket->connect (hostCopy);
-
-         MutexScopedLock lock (connectionMutex_);
-         hasConnection_ = connected;
+         {
+            SpinScopedLock lock (connectionMutex_);
+            hasConnection_ = connected;
+         }
 
          if (!connected && !errCopy.empty ()) {
             logger.message (errCopy.chars ());
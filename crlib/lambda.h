@@ -6,196 +6,287 @@
 
 CR_NAMESPACE_BEGIN
 
-template <typename> class Lambda;
-template <typename R, typename ...Args> class Lambda <R (Args...)> final {
+// default inline storage of lambda, callables that don't fit are kept on the heap
+constexpr size_t kLambdaInlineSize = sizeof (void *) * 3;
+
+// type-erased callable with N bytes of inline storage, move-only when Copyable is false, so it can hold
+// callables owning unique resources, dispatch goes through a plain function pointer instead of vtable,
+// and trivially copyable callables kept inline are copied and moved bytewise without any indirect call
+template <typename, size_t = kLambdaInlineSize, bool = true> class BasicLambda;
+template <typename R, typename ...Args, size_t N, bool Copyable> class BasicLambda <R (Args...), N, Copyable> final {
 private:
-   static constexpr size_t kSmallBufferSize = sizeof (void *) * 3;
+   static_assert (N >= sizeof (void *), "Inline storage must hold at least a pointer.");
 
-   // type-erased callable interface
-   class Holder {
-   public:
-      Holder () = default;
-      virtual ~Holder () = default;
-
-      Holder (const Holder &) = delete;
-      Holder &operator = (const Holder &) = delete;
+   enum Operation {
+      Copy,
+      Move,
+      Destroy
+   };
 
-   public:
-      virtual R invoke (Args &&... args) const = 0;
-      virtual Holder *cloneInto (void *buf) const = 0;
-      virtual Holder *moveInto (void *buf) = 0;
+   union Storage {
+      double alignment;
+      void *pointer;
+      uint8_t buffer[N];
    };
 
-   template <typename T> class CallableHolder final : public Holder {
-   private:
-      T callee_;
+   using Invoker = R (*) (Storage &, Args &&...);
+   using Manager = void (*) (Operation, Storage &, Storage &);
 
-   public:
-      CallableHolder (const T &callee) : callee_ (callee) {}
-      CallableHolder (T &&callee) : callee_ (cr::move (callee)) {}
-      CallableHolder (const CallableHolder &rhs) : callee_ (rhs.callee_) {}
-      CallableHolder (CallableHolder &&rhs) noexcept : callee_ (cr::move (rhs.callee_)) {}
+   // copy constructor and assignment take this, so they turn into unrelated overloads for move-only lambdas
+   struct Disabled {};
+   using CopySource = typename conditional <Copyable, BasicLambda, Disabled>::type;
 
-   public:
-      R invoke (Args &&... args) const override {
-         return callee_ (cr::forward <Args> (args)...);
-      }
+   template <typename T> static constexpr bool kFitsInline = sizeof (T) <= sizeof (Storage) && alignof (T) <= alignof (Storage);
 
-      Holder *cloneInto (void *buf) const override {
-         if (buf) {
-            return mem::construct (static_cast <CallableHolder *> (buf), *this);
-         }
-         return mem::allocateAndConstruct <CallableHolder> (*this);
-      }
-
-      Holder *moveInto (void *buf) override {
-         if (buf) {
-            return mem::construct (static_cast <CallableHolder *> (buf), cr::move (*this));
-         }
-         return mem::allocateAndConstruct <CallableHolder> (cr::move (*this));
-      }
-   };
+private:
+   mutable Storage storage_ {};
+   Invoker invoke_ {};
+   Manager manage_ {}; // null for the empty lambda and for trivially copyable inline callables
 
 private:
-   Holder *holder_ {};
-   bool small_ {};
+   template <typename T> static T *inlined (Storage &storage) {
+      return reinterpret_cast <T *> (storage.buffer);
+   }
 
-   union {
-      double alignment_;
-      uint8_t buffer_[kSmallBufferSize];
-   } storage_ {};
+   template <typename T> static T *&allocated (Storage &storage) {
+      return reinterpret_cast <T *&> (storage.pointer);
+   }
 
-private:
-   void *smallBuffer () {
-      return storage_.buffer_;
+   template <typename T> static R invokeInline (Storage &storage, Args &&...args) {
+      return (*inlined <T> (storage)) (cr::forward <Args> (args)...);
    }
 
-   void destroyHolder () noexcept {
-      if (!holder_) {
-         return;
+   template <typename T> static R invokeAllocated (Storage &storage, Args &&...args) {
+      return (*allocated <T> (storage)) (cr::forward <Args> (args)...);
+   }
+
+   template <typename T> static void manageInline (Operation op, Storage &dst, Storage &src) {
+      switch (op) {
+      case Copy:
+         if constexpr (Copyable) {
+            mem::construct (inlined <T> (dst), *static_cast <const T *> (inlined <T> (src)));
+         }
+         break;
+
+      case Move:
+         mem::construct (inlined <T> (dst), cr::move (*inlined <T> (src)));
+         mem::destruct (inlined <T> (src));
+         break;
+
+      case Destroy:
+         mem::destruct (inlined <T> (dst));
+         break;
       }
+   }
+
+   template <typename T> static void manageAllocated (Operation op, Storage &dst, Storage &src) {
+      switch (op) {
+      case Copy:
+         if constexpr (Copyable) {
+            allocated <T> (dst) = mem::allocateAndConstruct <T> (*static_cast <const T *> (allocated <T> (src)));
+         }
+         break;
 
-      if (small_) {
-         holder_->~Holder ();
+      case Move:
+         allocated <T> (dst) = allocated <T> (src); // just steal the pointer
+         break;
+
+      case Destroy:
+         mem::destruct (allocated <T> (dst));
+         mem::release (allocated <T> (dst));
+         break;
       }
-      else {
-         mem::destruct (holder_);
-         mem::release (holder_);
+   }
+
+   void destroyCallable () noexcept {
+      if (manage_) {
+         manage_ (Destroy, storage_, storage_);
       }
-      holder_ = nullptr;
-      small_ = false;
+      invoke_ = nullptr;
+      manage_ = nullptr;
    }
 
    template <typename U> void assignCallable (U &&fn) {
-      using Callable = CallableHolder <typename cr::decay <U>::type>;
+      using T = typename cr::decay <U>::type;
 
-      if constexpr (sizeof (Callable) <= sizeof (storage_)) {
-         holder_ = mem::construct (static_cast <Callable *> (smallBuffer ()), cr::forward <U> (fn));
-         small_ = true;
+      if constexpr (kFitsInline <T>) {
+         mem::construct (inlined <T> (storage_), cr::forward <U> (fn));
+
+         invoke_ = &invokeInline <T>;
+         manage_ = is_trivially_copyable <T>::value ? nullptr : &manageInline <T>;
       }
       else {
-         holder_ = mem::allocateAndConstruct <Callable> (cr::forward <U> (fn));
-         small_ = false;
-      }
-   }
+         allocated <T> (storage_) = mem::allocateAndConstruct <T> (cr::forward <U> (fn));
 
-   void copyFrom (const Lambda &rhs) {
-      if (!rhs) {
-         return;
+         invoke_ = &invokeAllocated <T>;
+         manage_ = &manageAllocated <T>;
       }
+   }
 
-      if (rhs.small_) {
-         holder_ = rhs.holder_->cloneInto (smallBuffer ());
-         small_ = true;
+   void copyFrom (const BasicLambda &rhs) {
+      if (rhs.manage_) {
+         rhs.manage_ (Copy, storage_, rhs.storage_);
       }
       else {
-         holder_ = rhs.holder_->cloneInto (nullptr);
-         small_ = false;
+         storage_ = rhs.storage_;
       }
+      invoke_ = rhs.invoke_;
+      manage_ = rhs.manage_;
    }
 
-   void moveFrom (Lambda &&rhs) noexcept {
-      if (!rhs) {
-         return;
-      }
-
-      if (rhs.small_) {
-         holder_ = rhs.holder_->moveInto (smallBuffer ());
-         small_ = true;
-
-         // destruct the moved-from object still alive in rhs small buffer
-         rhs.holder_->~Holder ();
-         rhs.holder_ = nullptr;
-         rhs.small_ = false;
+   void moveFrom (BasicLambda &&rhs) noexcept {
+      if (rhs.manage_) {
+         rhs.manage_ (Move, storage_, rhs.storage_);
       }
       else {
-         // heap-allocated, just steal the pointer
-         holder_ = rhs.holder_;
-         small_ = false;
-
-         rhs.holder_ = nullptr;
+         storage_ = rhs.storage_;
       }
+      invoke_ = rhs.invoke_;
+      manage_ = rhs.manage_;
+
+      rhs.invoke_ = nullptr;
+      rhs.manage_ = nullptr;
    }
 
 public:
-   Lambda () = default;
-   Lambda (nullptr_t) {}
+   BasicLambda () = default;
+   BasicLambda (nullptr_t) {}
 
-   Lambda (const Lambda &rhs) {
+   BasicLambda (const CopySource &rhs) {
       copyFrom (rhs);
    }
 
-   Lambda (Lambda &&rhs) noexcept {
+   BasicLambda (BasicLambda &&rhs) noexcept {
       moveFrom (cr::move (rhs));
    }
 
-   template <typename U, typename = cr::enable_if_t<!cr::is_same <cr::remove_cv_t <cr::remove_reference_t <U>>, Lambda>::value>>
-   Lambda (U &&obj) {
+   template <typename U, typename = cr::enable_if_t<!cr::is_same <cr::remove_cv_t <cr::remove_reference_t <U>>, BasicLambda>::value>>
+   BasicLambda (U &&obj) {
       assignCallable (cr::forward <U> (obj));
    }
 
-   ~Lambda () {
-      destroyHolder ();
+   ~BasicLambda () {
+      destroyCallable ();
    }
 
 public:
    explicit operator bool () const {
-      return !!holder_;
+      return !!invoke_;
    }
 
    decltype (auto) operator () (Args... args) const {
-      assert (holder_);
-      return holder_->invoke (cr::forward <Args> (args)...);
+      assert (invoke_);
+      return invoke_ (storage_, cr::forward <Args> (args)...);
+   }
+
+   // whether callable of type T is kept in the inline storage, without touching the heap
+   template <typename T> static constexpr bool storesInline () {
+      return kFitsInline <typename cr::decay <T>::type>;
    }
 
 public:
-   Lambda &operator = (nullptr_t) {
-      destroyHolder ();
+   BasicLambda &operator = (nullptr_t) {
+      destroyCallable ();
       return *this;
    }
 
-   Lambda &operator = (const Lambda &rhs) {
+   BasicLambda &operator = (const CopySource &rhs) {
       if (this != &rhs) {
-         destroyHolder ();
+         destroyCallable ();
          copyFrom (rhs);
       }
       return *this;
    }
 
-   Lambda &operator = (Lambda &&rhs) noexcept {
+   BasicLambda &operator = (BasicLambda &&rhs) noexcept {
       if (this != &rhs) {
-         destroyHolder ();
+         destroyCallable ();
          moveFrom (cr::move (rhs));
       }
       return *this;
    }
 
-   template <typename U, typename = cr::enable_if_t<!cr::is_same <cr::remove_cv_t <cr::remove_reference_t <U>>, Lambda>::value>>
-   Lambda &operator = (U &&rhs) {
-      destroyHolder ();
+   template <typename U, typename = cr::enable_if_t<!cr::is_same <cr::remove_cv_t <cr::remove_reference_t <U>>, BasicLambda>::value>>
+   BasicLambda &operator = (U &&rhs) {
+      destroyCallable ();
       assignCallable (cr::forward <U> (rhs));
       return *this;
    }
 };
 
+// copyable lambda with default inline storage
+template <typename S> using Lambda = BasicLambda <S>;
+
+// copyable lambda with N bytes of inline storage
+template <typename S, size_t N> using InlineLambda = BasicLambda <S, N>;
+
+// move-only lambda, accepts move-only callables
+template <typename S, size_t N = kLambdaInlineSize> using UniqueLambda = BasicLambda <S, N, false>;
+
+// non-owning reference to a callable, two pointers in size, never allocates, meant for parameters of
+// functions, that call back synchronously, the callable must outlive the reference, so never store it
+template <typename> class FunctionRef;
+template <typename R, typename ...Args> class FunctionRef <R (Args...)> final {
+private:
+   union Target {
+      void *object;
+      void (*function) ();
+   };
+
+   using Invoker = R (*) (Target, Args &&...);
+
+private:
+   Target target_ {};
+   Invoker invoke_ {};
+
+private:
+   template <typename T> static R invokeObject (Target target, Args &&...args) {
+      return (*static_cast <T *> (target.object)) (cr::forward <Args> (args)...);
+   }
+
+   template <typename T> static R invokeFunction (Target target, Args &&...args) {
+      return reinterpret_cast <T *> (target.function) (cr::forward <Args> (args)...);
+   }
+
+public:
+   FunctionRef () = default;
+   FunctionRef (nullptr_t) {}
+
+   FunctionRef (const FunctionRef &) = default;
+   FunctionRef &operator = (const FunctionRef &) = default;
+
+   // functions are referenced by their address, other callables by reference, temporaries are fine, as
+   // long as the reference doesn't outlive the full expression (as with a function parameter)
+   template <typename U, typename = cr::enable_if_t<!cr::is_same <cr::remove_cv_t <cr::remove_reference_t <U>>, FunctionRef>::value>>
+   FunctionRef (U &&callable) {
+      using D = typename cr::decay <U>::type;
+
+      // the only pointers, that can be called, are function pointers
+      if constexpr (!cr::is_same <cr::remove_pointer_t <D>, D>::value) {
+         const D function = callable;
+
+         if (function) {
+            target_.function = reinterpret_cast <void (*) ()> (function);
+            invoke_ = &invokeFunction <cr::remove_pointer_t <D>>;
+         }
+      }
+      else {
+         target_.object = const_cast <void *> (static_cast <const void *> (&callable));
+         invoke_ = &invokeObject <cr::remove_reference_t <U>>;
+      }
+   }
+
+   ~FunctionRef () = default;
+
+public:
+   explicit operator bool () const {
+      return !!invoke_;
+   }
+
+   R operator () (Args... args) const {
+      assert (invoke_);
+      return invoke_ (target_, cr::forward <Args> (args)...);
+   }
+};
+
 CR_NAMESPACE_END
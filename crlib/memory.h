@@ -38,6 +38,17 @@ namespace mem {
       return nullptr;
    }
 
+   // default allocation policy for containers, goes straight to the heap, carries no state
+   struct Allocator {
+      template <typename T> T *allocate (const size_t length) noexcept {
+         return mem::allocate <T> (length);
+      }
+
+      template <typename T> void release (T *memory, const size_t) noexcept {
+         mem::release (memory);
+      }
+   };
+
    // in-place constructs a single object with forwarded arguments
    template <typename T, typename ...Args> CR_FORCE_INLINE T *construct (T *memory, Args &&...args) noexcept {
       new (memory) T (cr::forward <Args> (args)...);
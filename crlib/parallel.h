@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <crlib/array.h>
+#include <crlib/lambda.h>
+#include <crlib/thread.h>
+
+CR_NAMESPACE_BEGIN
+
+namespace detail {
+   // chunks per thread, when grain is chosen automatically, a few per thread let stealing even out uneven chunks
+   constexpr size_t kChunksPerThread = 4;
+
+   // splits [begin, end) into chunks of grain elements
+   struct ChunkRange {
+      size_t begin;
+      size_t end;
+      size_t grain;
+
+      size_t count () const {
+         return (end - begin + grain - 1) / grain;
+      }
+
+      size_t first (const size_t chunk) const {
+         return begin + chunk * grain;
+      }
+
+      size_t last (const size_t chunk) const {
+         return cr::min (end, first (chunk) + grain);
+      }
+   };
+
+   inline ChunkRange makeChunks (ThreadPool &pool, const size_t begin, const size_t end, size_t grain) {
+      if (grain == 0) {
+         const size_t threads = cr::max <size_t> (pool.threadCount (), 1);
+         const size_t target = threads * kChunksPerThread;
+
+         grain = cr::max <size_t> ((end - begin + target - 1) / target, 1);
+      }
+      return { begin, end, grain };
+   }
+
+   struct ChunkSplitter {
+      TaskGroup &group;
+      FunctionRef <void (size_t)> fn;
+
+      // right half of chunks goes to the pool (where idle workers steal it from), left half is split
+      // further on calling thread, so chunks are handed out in log(n) steps and balanced by stealing
+      void split (size_t first, size_t last) const {
+         while (last - first > 1) {
+            const size_t middle = first + (last - first) / 2;
+
+            group.run ([this, middle, last] () {
+               split (middle, last);
+            });
+            last = middle;
+         }
+         fn (first);
+      }
+   };
+
+   // runs fn (chunk) for every chunk, spreading them over the pool and waiting for all of them, chunk
+   // body is referenced, not copied, so splitting code is shared between all the callers
+   inline void forEachChunk (ThreadPool &pool, const size_t chunks, FunctionRef <void (size_t)> fn) {
+      if (chunks == 0) {
+         return;
+      }
+
+      if (chunks == 1 || pool.threadCount () == 0) {
+         for (size_t i = 0; i < chunks; ++i) {
+            fn (i);
+         }
+         return;
+      }
+      TaskGroup group (pool);
+      ChunkSplitter splitter { group, fn };
+
+      splitter.split (0, chunks);
+      group.wait ();
+   }
+}
+
+// runs fn (index) for every index in [begin, end) on the pool, at least grain indices per job, grain of
+// zero picks one, that gives each thread a few jobs, returns when all the indices are done
+template <typename F> void parallelFor (ThreadPool &pool, const size_t begin, const size_t end, const size_t grain, F &&fn) {
+   if (begin >= end) {
+      return;
+   }
+   const auto range = detail::makeChunks (pool, begin, end, grain);
+
+   detail::forEachChunk (pool, range.count (), [&range, &fn] (const size_t chunk) {
+      for (size_t i = range.first (chunk), last = range.last (chunk); i < last; ++i) {
+         fn (i);
+      }
+   });
+}
+
+// runs fn (element) for every element of the contiguous range (array or anything with data () and length ())
+template <typename R, typename F> void parallelFor (ThreadPool &pool, R &range, const size_t grain, F &&fn) {
+   auto data = range.data ();
+
+   parallelFor (pool, 0, range.length (), grain, [data, &fn] (const size_t index) {
+      fn (data[index]);
+   });
+}
+
+// folds fn (index) for every index in [begin, end) with combine, starting each chunk from identity, then
+// combines chunk results in index order, so the result doesn't depend on which thread ran which chunk
+template <typename T, typename F, typename C> T parallelReduce (ThreadPool &pool, const size_t begin, const size_t end, const size_t grain, const T &identity, F &&fn, C &&combine) {
+   if (begin >= end) {
+      return identity;
+   }
+   const auto range = detail::makeChunks (pool, begin, end, grain);
+   Array <T> partial (range.count (), identity);
+
+   detail::forEachChunk (pool, range.count (), [&] (const size_t chunk) {
+      T value = identity;
+
+      for (size_t i = range.first (chunk), last = range.last (chunk); i < last; ++i) {
+         value = combine (cr::move (value), fn (i));
+      }
+      partial[chunk] = cr::move (value);
+   });
+   T result = identity;
+
+   for (auto &value : partial) {
+      result = combine (cr::move (result), cr::move (value));
+   }
+   return result;
+}
+
+// same as above over elements of the contiguous range
+template <typename R, typename T, typename F, typename C> T parallelReduce (ThreadPool &pool, const R &range, const size_t grain, const T &identity, F &&fn, C &&combine) {
+   auto data = range.data ();
+
+   return parallelReduce (pool, 0, range.length (), grain, identity, [data, &fn] (const size_t index) {
+      return fn (data[index]);
+   }, combine);
+}
+
+CR_NAMESPACE_END
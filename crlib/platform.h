@@ -193,6 +193,13 @@ CR_NAMESPACE_BEGIN
 #endif
 #endif
 
+// cache line size, used to keep data written by different threads apart
+#if defined(CR_MACOS) && defined(CR_ARCH_ARM64)
+constexpr size_t kCacheLineSize = 128;
+#else
+constexpr size_t kCacheLineSize = 64;
+#endif
+
 CR_NAMESPACE_END
 
 #if defined(CR_WINDOWS)
@@ -451,6 +458,23 @@ struct Platform : public Singleton <Platform> {
 #endif
    }
 
+   // milliseconds since unspecified point in the past, never goes backwards, unlike wall clock
+   [[nodiscard]] uint64_t monotonicMillis () {
+#if defined(CR_WINDOWS)
+      LARGE_INTEGER count {}, freq {};
+
+      QueryPerformanceFrequency (&freq);
+      QueryPerformanceCounter (&count);
+
+      return static_cast <uint64_t> (count.QuadPart / freq.QuadPart * 1000 + count.QuadPart % freq.QuadPart * 1000 / freq.QuadPart);
+#else
+      timespec ts {};
+      clock_gettime (CLOCK_MONOTONIC, &ts);
+
+      return static_cast <uint64_t> (ts.tv_sec) * 1000 + static_cast <uint64_t> (ts.tv_nsec) / 1000000;
+#endif
+   }
+
    void abort (const char *msg = "OUT OF MEMORY!") noexcept {
       fprintf (stderr, "%s\n", msg);
 
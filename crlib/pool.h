@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <crlib/basic.h>
+#include <crlib/memory.h>
+#include <crlib/uniqueptr.h>
+#include <crlib/thread.h>
+
+// policy of object pool sharing between threads
+CR_DECLARE_SCOPED_ENUM (PoolPolicy,
+   Local, // single thread only, no locking at all
+   Shared, // free list is guarded with a mutex
+   Cached, // same as shared, but each thread keeps a small cache of free objects
+)
+
+CR_NAMESPACE_BEGIN
+
+// fixed-size object pool, objects are carved out of slabs of S objects, freed objects are kept in an
+// intrusive free list and recycled, slabs are returned to the heap only when the pool is destroyed,
+// so every object must be recycled before the pool goes away
+template <typename T, PoolPolicy P = PoolPolicy::Local, size_t S = 64> class ObjectPool final : public NonCopyable {
+private:
+   static_assert (S > 0, "Slab must hold at least one object.");
+   static_assert (alignof (T) <= alignof (max_align_t), "Over-aligned types are not supported.");
+
+   union Node {
+      Node *next;
+      alignas (T) uint8_t storage[sizeof (T)];
+   };
+
+   struct Slab {
+      Slab *next;
+      Node nodes[S];
+   };
+
+   struct NoLock {
+      void lock () {}
+      void unlock () {}
+   };
+
+   using Lock = typename conditional <P == PoolPolicy::Local, NoLock, Mutex>::type;
+
+   // liveness of a cached pool, shared with thread caches, that were claimed by it, so a cache left over
+   // from a dead pool is noticed and dropped by the next pool used on that thread, and caches of exiting
+   // threads are given back to the pool, while it's alive (mutex keeps the pool from dying meanwhile)
+   struct Owner final : public NonCopyable {
+      Atomic <int32_t> refs { 1 };
+      Atomic <bool> alive { true };
+      Mutex mutex {};
+      ObjectPool *pool {};
+
+      explicit Owner (ObjectPool *pool) : pool (pool) {}
+
+      void acquire () {
+         refs.fetchAdd (1, MemoryOrder::Relaxed);
+      }
+
+      void release () {
+         if (refs.fetchSub (1, MemoryOrder::AcqRel) != 1) {
+            return;
+         }
+         auto self = this;
+
+         mem::destruct (self);
+         mem::release (self);
+      }
+   };
+
+   // free objects of one pool, kept by each thread, so most of acquire/recycle pairs never lock
+   struct ThreadCache {
+      Owner *owner {};
+      Node *head {};
+      size_t length {};
+
+      // exiting thread hands its objects back, so they aren't lost to the pool for its whole lifetime
+      ~ThreadCache () {
+         if (owner) {
+            MutexScopedLock lock (owner->mutex);
+
+            if (owner->alive.load (MemoryOrder::Relaxed)) {
+               owner->pool->reclaim (head);
+            }
+         }
+         reset ();
+      }
+
+      // forgets cached objects, they are still in owner's slabs, so nothing leaks past the pool
+      void reset () {
+         if (owner) {
+            owner->release ();
+         }
+         owner = nullptr;
+         head = nullptr;
+         length = 0;
+      }
+   };
+
+   static constexpr size_t kCacheSize = 32;
+
+public:
+   // returns object to the pool it came from, used by pooled unique pointers
+   struct Deleter {
+      ObjectPool *pool {};
+
+      void operator () (T *object) const noexcept {
+         pool->recycle (object);
+      }
+   };
+
+   using Pointer = UniquePtr <T, Deleter>;
+
+private:
+   Slab *slabs_ {};
+   Node *free_ {};
+   size_t capacity_ {};
+   Owner *owner_ {};
+   mutable Lock lock_ {};
+
+   static inline thread_local ThreadCache cache_ {};
+
+public:
+   explicit ObjectPool () {
+      if constexpr (P == PoolPolicy::Cached) {
+         owner_ = mem::allocateAndConstruct <Owner> (this);
+      }
+   }
+
+   explicit ObjectPool (const size_t reserved) : ObjectPool () {
+      reserve (reserved);
+   }
+
+   ~ObjectPool () {
+      if constexpr (P == PoolPolicy::Cached) {
+         if (cache_.owner == owner_) {
+            cache_.reset ();
+         }
+         {
+            MutexScopedLock lock (owner_->mutex);
+            owner_->alive.store (false, MemoryOrder::Release);
+         }
+         owner_->release ();
+      }
+
+      while (slabs_) {
+         auto next = slabs_->next;
+         mem::release (slabs_);
+
+         slabs_ = next;
+      }
+   }
+
+private:
+   // carves a new slab into the free list, called with lock held
+   void grow () {
+      auto slab = mem::allocate <Slab> ();
+      slab->next = slabs_;
+
+      for (size_t i = 0; i < S - 1; ++i) {
+         slab->nodes[i].next = &slab->nodes[i + 1];
+      }
+      slab->nodes[S - 1].next = free_;
+
+      free_ = &slab->nodes[0];
+      slabs_ = slab;
+      capacity_ += S;
+   }
+
+   Node *pop () {
+      ScopedLock <Lock> lock (lock_);
+
+      if (!free_) {
+         grow ();
+      }
+      auto node = free_;
+      free_ = node->next;
+
+      return node;
+   }
+
+   void push (Node *node) {
+      ScopedLock <Lock> lock (lock_);
+
+      node->next = free_;
+      free_ = node;
+   }
+
+   // whether calling thread's cache is serving this pool, first pool used on a thread claims the cache,
+   // cache of a destroyed pool is released, so it doesn't keep caching off for the later pools
+   bool ownsCache () {
+      if (cache_.owner == owner_) {
+         return true;
+      }
+
+      if (cache_.owner && !cache_.owner->alive.load (MemoryOrder::Acquire)) {
+         cache_.reset ();
+      }
+
+      if (!cache_.owner) {
+         owner_->acquire ();
+
+         cache_.owner = owner_;
+         return true;
+      }
+      return false;
+   }
+
+   Node *acquireNode () {
+      if constexpr (P == PoolPolicy::Cached) {
+         if (ownsCache ()) {
+            if (!cache_.head) {
+               refill ();
+            }
+            auto node = cache_.head;
+
+            cache_.head = node->next;
+            --cache_.length;
+
+            return node;
+         }
+      }
+      return pop ();
+   }
+
+   void releaseNode (Node *node) {
+      if constexpr (P == PoolPolicy::Cached) {
+         if (ownsCache ()) {
+            if (cache_.length == kCacheSize) {
+               flush ();
+            }
+            node->next = cache_.head;
+
+            cache_.head = node;
+            ++cache_.length;
+
+            return;
+         }
+      }
+      push (node);
+   }
+
+   // puts the list of nodes from cache of exited thread back to the shared free list
+   void reclaim (Node *node) {
+      ScopedLock <Lock> lock (lock_);
+
+      while (node) {
+         auto next = node->next;
+
+         node->next = free_;
+         free_ = node;
+         node = next;
+      }
+   }
+
+   // moves half of the cache worth of objects from the shared free list to the cache at once
+   void refill () {
+      ScopedLock <Lock> lock (lock_);
+
+      while (cache_.length < kCacheSize / 2) {
+         if (!free_) {
+            grow ();
+         }
+         auto node = free_;
+         free_ = node->next;
+
+         node->next = cache_.head;
+         cache_.head = node;
+         ++cache_.length;
+      }
+   }
+
+   // gives half of the cache back to the shared free list, so objects can migrate between threads
+   void flush () {
+      ScopedLock <Lock> lock (lock_);
+
+      while (cache_.length > kCacheSize / 2) {
+         auto node = cache_.head;
+         cache_.head = node->next;
+
+         node->next = free_;
+         free_ = node;
+         --cache_.length;
+      }
+   }
+
+public:
+   // takes an object from the pool and constructs it in place
+   template <typename ...Args> T *acquire (Args &&...args) {
+      return mem::construct (reinterpret_cast <T *> (acquireNode ()->storage), cr::forward <Args> (args)...);
+   }
+
+   // destroys object and puts its memory back to the free list
+   void recycle (T *object) {
+      if (!object) {
+         return;
+      }
+      mem::destruct (object);
+      releaseNode (reinterpret_cast <Node *> (object));
+   }
+
+   // same as acquire, but the object is owned by unique pointer, that recycles it on destruction
+   template <typename ...Args> Pointer make (Args &&...args) {
+      return Pointer { acquire (cr::forward <Args> (args)...), Deleter { this } };
+   }
+
+   // makes sure at least n objects can be acquired without touching the heap
+   void reserve (const size_t n) {
+      ScopedLock <Lock> lock (lock_);
+
+      while (capacity_ < n) {
+         grow ();
+      }
+   }
+
+   // number of objects, slabs were carved into
+   size_t capacity () const {
+      ScopedLock <Lock> lock (lock_);
+      return capacity_;
+   }
+};
+
+// pooled unique pointer, recycles the object back into the pool
+template <typename T, PoolPolicy P = PoolPolicy::Local> using PooledPtr = typename ObjectPool <T, P>::Pointer;
+
+// makeUnique counterpart for object pools
+template <typename T, PoolPolicy P, size_t S, typename ...Args> typename ObjectPool <T, P, S>::Pointer makePooled (ObjectPool <T, P, S> &pool, Args &&...args) {
+   return pool.make (cr::forward <Args> (args)...);
+}
+
+CR_NAMESPACE_END
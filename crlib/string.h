@@ -459,7 +459,7 @@ public:
    }
 };
 
-// simple std::string analogue
+// simple std::string analogue, short strings are kept inline in the object itself, longer ones on the heap
 class String final {
 public:
    enum : size_t {
@@ -467,51 +467,167 @@ public:
    };
 
 private:
-   static inline char empty_[] = { kNullChar };
+   struct Heap {
+      char *chars;
+      size_t length;
+      size_t capacity;
+   };
 
-   char *chars_ = empty_;
-   size_t length_ {};
-   size_t capacity_ {};
+   static constexpr size_t kStorageSize = sizeof (Heap);
+   static constexpr uint8_t kHeapTag = 0x80;
+
+public:
+   // longest string, that fits into the object without heap allocation (the last byte holds the length)
+   static constexpr size_t kInlineCapacity = kStorageSize - 2;
+
+private:
+   // last byte of the storage is either the inline length, or has the heap tag bit set, that bit overlaps
+   // a bit of heap capacity, so heap capacities are kept even, and packed without their lowest bit, which
+   // leaves that bit free for any capacity
+   union {
+      Heap heap_;
+      char inline_[kStorageSize] {};
+   };
 
 private:
+#if defined(CR_ARCH_CPU_BIG_ENDIAN)
+   // tag bit is the top bit of the lowest byte, halved capacity is split around it
+   static constexpr size_t packCapacity (size_t capacity) {
+      const auto half = capacity >> 1;
+      return ((half >> 7) << 8) | kHeapTag | (half & 0x7f);
+   }
+
+   static constexpr size_t unpackCapacity (size_t packed) {
+      return (((packed >> 8) << 7) | (packed & 0x7f)) << 1;
+   }
+#else
+   // tag bit is the top bit of the highest byte, halved capacity never reaches it
+   static constexpr size_t kTagBit = static_cast <size_t> (kHeapTag) << ((sizeof (size_t) - 1) * 8);
+
+   static constexpr size_t packCapacity (size_t capacity) {
+      return (capacity >> 1) | kTagBit;
+   }
+
+   static constexpr size_t unpackCapacity (size_t packed) {
+      return (packed & ~kTagBit) << 1;
+   }
+#endif
+
+   // heap capacities are even, so packing doesn't lose anything
+   static constexpr size_t evenCapacity (size_t capacity) {
+      return (capacity + 1) & ~static_cast <size_t> (1);
+   }
+
+   uint8_t tag () const {
+      return reinterpret_cast <const uint8_t *> (this)[kStorageSize - 1];
+   }
+
+   bool isInline () const {
+      return !(tag () & kHeapTag);
+   }
+
+   char *buffer () {
+      return isInline () ? inline_ : heap_.chars;
+   }
+
+   const char *buffer () const {
+      return isInline () ? inline_ : heap_.chars;
+   }
+
+   // sets the length and terminates the string
+   void setLength (size_t length) {
+      if (isInline ()) {
+         inline_[length] = kNullChar;
+         inline_[kStorageSize - 1] = static_cast <char> (length);
+      }
+      else {
+         heap_.length = length;
+         heap_.chars[length] = kNullChar;
+      }
+   }
+
    static size_t growCapacity (size_t current, size_t needed) {
       auto capacity = current ? current : cr::max <size_t> (16U, needed);
 
       while (capacity < needed) {
          capacity += capacity / 2;
       }
-      return capacity;
+      return evenCapacity (capacity);
    }
 
+   // makes buffer hold at least needed bytes (including terminator), contents are dropped unless asked to keep,
+   // returns the buffer to write to
+   char *grow (size_t needed, bool keep = true) {
+      const size_t current = capacity ();
+
+      if (needed <= current) {
+         return buffer ();
+      }
+      const size_t newCapacity = growCapacity (current, needed);
+      auto transfer = mem::allocate <char> (newCapacity);
+
+      const size_t length = keep ? this->length () : 0;
+      memcpy (transfer, buffer (), length);
+
+      release ();
+
+      heap_.chars = transfer;
+      heap_.capacity = packCapacity (newCapacity);
+
+      setLength (length);
+      return transfer;
+   }
 
    void initFromChars (const char *str, size_t length) {
       if (!length || !str || length >= InvalidIndex) {
          return;
       }
-      capacity_ = cr::max <size_t> (16U, length + 1);
-      chars_ = mem::allocate <char> (capacity_);
-      length_ = length;
 
-      memcpy (chars_, str, length);
-      chars_[length] = kNullChar;
+      auto chars = inline_;
+
+      // terminator and length are written per branch, so the compiler doesn't see heap length indexing
+      // the inline buffer
+      if (length > kInlineCapacity) {
+         const auto capacity = evenCapacity (cr::max <size_t> (16U, length + 1));
+
+         chars = mem::allocate <char> (capacity);
+         chars[length] = kNullChar;
+
+         heap_.chars = chars;
+         heap_.capacity = packCapacity (capacity);
+         heap_.length = length;
+      }
+      else {
+         inline_[length] = kNullChar;
+         inline_[kStorageSize - 1] = static_cast <char> (length);
+      }
+      memcpy (chars, str, length);
    }
 
-   void freeBuffer () {
-      if (chars_ != empty_) {
-         mem::release (chars_);
+   // frees the heap buffer (if any), leaving the string empty and inline
+   void release () {
+      if (!isInline ()) {
+         mem::release (heap_.chars);
       }
-      chars_ = empty_;
-      length_ = 0;
-      capacity_ = 0;
+      memset (inline_, 0, kStorageSize);
+   }
+
+   // takes over rhs storage, leaving rhs empty
+   void steal (String &rhs) {
+      memcpy (inline_, rhs.inline_, kStorageSize);
+      memset (rhs.inline_, 0, kStorageSize);
+   }
+
+   bool aliases (const char *str) const {
+      const auto chars = buffer ();
+      return str >= chars && str < chars + capacity ();
    }
 
 public:
    String () = default;
 
    ~String () {
-      if (chars_ != empty_) {
-         mem::release (chars_);
-      }
+      release ();
    }
 
    String (const char *str) {
@@ -523,7 +639,7 @@ public:
    }
 
    String (const String &str) {
-      initFromChars (str.chars_, str.length_);
+      initFromChars (str.chars (), str.length ());
    }
 
    String (StringRef str) {
@@ -534,32 +650,13 @@ public:
       assign (ch);
    }
 
-   String (String &&rhs) noexcept : chars_ (rhs.chars_), length_ (rhs.length_), capacity_ (rhs.capacity_) {
-      rhs.chars_ = empty_;
-      rhs.length_ = 0;
-      rhs.capacity_ = 0;
+   String (String &&rhs) noexcept {
+      steal (rhs);
    }
 
 public:
    void resize (const size_t amount) noexcept {
-      const size_t needed = length_ + amount + 1;
-
-      if (needed <= capacity_) {
-         return;
-      }
-      const size_t newCapacity = growCapacity (capacity_, needed);
-      auto transfer = mem::allocate <char> (newCapacity);
-
-      if (length_ > 0) {
-         memcpy (transfer, chars_, length_);
-      }
-      transfer[length_] = kNullChar;
-
-      if (chars_ != empty_) {
-         mem::release (chars_);
-      }
-      chars_ = transfer;
-      capacity_ = newCapacity;
+      grow (length () + amount + 1);
    }
 
    String &assign (const char *str) {
@@ -568,45 +665,16 @@ public:
 
    String &assign (const char *str, size_t length) {
       if (!length || !str || length >= InvalidIndex) {
-         length_ = 0;
-
-         if (chars_ != empty_) {
-            chars_[0] = kNullChar;
-         }
-         return *this;
-      }
-
-      if (str >= chars_ && str < chars_ + capacity_) {
-         auto copy = mem::allocate <char> (length + 1);
-
-         memcpy (copy, str, length);
-         copy[length] = kNullChar;
-
-         if (chars_ != empty_) {
-            mem::release (chars_);
-         }
-         chars_ = copy;
-         length_ = length;
-         capacity_ = length + 1;
-
+         setLength (0);
          return *this;
       }
-      const size_t needed = length + 1;
-
-      if (needed > capacity_) {
-         const size_t newCapacity = growCapacity (capacity_, needed);
-         auto transfer = mem::allocate <char> (newCapacity);
 
-         if (chars_ != empty_) {
-            mem::release (chars_);
-         }
-         chars_ = transfer;
-         capacity_ = newCapacity;
+      if (aliases (str)) {
+         String copy (str, length);
+         return *this = cr::move (copy);
       }
-      memcpy (chars_, str, length);
-
-      length_ = length;
-      chars_[length_] = kNullChar;
+      memcpy (grow (length + 1, false), str, length);
+      setLength (length);
 
       return *this;
    }
@@ -615,15 +683,12 @@ public:
       if (&str == this) {
          return *this;
       }
-      return assign (str.chars_, length > 0 ? length : str.length_);
+      return assign (str.chars (), length > 0 ? length : str.length ());
    }
 
    String &assign (const char ch) {
-      resize (1);
-
-      chars_[0] = ch;
-      chars_[1] = kNullChar;
-      length_ = 1;
+      grow (2, false)[0] = ch;
+      setLength (1);
 
       return *this;
    }
@@ -633,41 +698,34 @@ public:
    }
 
    String &append (const char *str, size_t length) {
-
       if (!length) {
          return *this;
       }
+      const size_t current = this->length ();
 
-      if (str >= chars_ && str < chars_ + capacity_) {
-         auto copy = mem::allocate <char> (length);
-         memcpy (copy, str, length);
-
-         resize (length);
-         memcpy (chars_ + length_, copy, length);
+      if (aliases (str)) {
+         const auto offset = static_cast <size_t> (str - buffer ());
+         auto chars = grow (current + length + 1);
 
-         mem::release (copy);
+         memmove (chars + current, chars + offset, length);
       }
       else {
-         resize (length);
-         memcpy (chars_ + length_, str, length);
+         memcpy (grow (current + length + 1) + current, str, length);
       }
-
-      length_ += length;
-      chars_[length_] = kNullChar;
+      setLength (current + length);
 
       return *this;
    }
 
    String &append (const String &str, size_t length = 0) {
-      return append (str.chars_, length > 0 ? length : str.length_);
+      return append (str.chars (), length > 0 ? length : str.length ());
    }
 
    String &append (const char ch) {
-      resize (1);
+      const size_t current = length ();
 
-      chars_[length_] = ch;
-      ++length_;
-      chars_[length_] = kNullChar;
+      grow (current + 2)[current] = ch;
+      setLength (current + 1);
 
       return *this;
    }
@@ -675,55 +733,54 @@ public:
    template <typename ...Args> String &assignf (const char *fmt, Args &&...args) {
       const size_t size = fmtwrap.exec (nullptr, 0, fmt, args...);
 
-      resize (size);
-      fmtwrap.exec (chars_, size + 1, fmt, cr::forward <Args> (args)...);
+      fmtwrap.exec (grow (size + 1, false), size + 1, fmt, cr::forward <Args> (args)...);
 
-      length_ = size;
+      setLength (size);
       return *this;
    }
 
    template <typename ...Args> String &appendf (const char *fmt, Args &&...args) {
       const size_t size = fmtwrap.exec (nullptr, 0, fmt, args...);
+      const size_t current = length ();
 
-      resize (size);
-      fmtwrap.exec (chars_ + length_, size + 1, fmt, cr::forward <Args> (args)...);
+      fmtwrap.exec (grow (current + size + 1) + current, size + 1, fmt, cr::forward <Args> (args)...);
 
-      length_ += size;
+      setLength (current + size);
       return *this;
    }
 
 public:
    const char &at (size_t index) const {
-      return chars_[index];
+      return buffer ()[index];
    }
 
    char &at (size_t index) {
-      return chars_[index];
+      return buffer ()[index];
    }
 
    const char *chars () const {
-      return chars_;
+      return buffer ();
    }
 
    size_t length () const {
-      return length_;
+      return isInline () ? static_cast <size_t> (tag ()) : heap_.length;
    }
 
+   // size of the buffer in bytes (including terminator), inline buffer is the object itself
    size_t capacity () const {
-      return capacity_;
+      return isInline () ? kInlineCapacity + 1 : unpackCapacity (heap_.capacity);
    }
 
    bool empty () const {
-      return !length_;
+      return !length ();
    }
 
    void clear () {
-      length_ = 0;
-      chars_[0] = kNullChar;
+      setLength (0);
    }
 
    StringRef str () const {
-      return { chars_, length_ };
+      return { chars (), length () };
    }
 
 public:
@@ -732,43 +789,40 @@ public:
          return false;
       }
       const auto strLen = str.length ();
+      const auto current = length ();
 
-      if (index >= length_) {
+      if (index >= current) {
          append (str.chars (), strLen);
       }
       else {
-         resize (strLen);
-
-         const size_t moveSize = length_ - index;
+         auto chars = grow (current + strLen + 1) + index;
+         const size_t moveSize = current - index;
 
          if (moveSize > 0) {
-            memmove (chars_ + index + strLen,
-               chars_ + index,
+            memmove (chars + strLen,
+               chars,
                moveSize);
          }
-         memcpy (chars_ + index, str.chars (), strLen);
-
-         length_ += strLen;
-         chars_[length_] = kNullChar;
+         memcpy (chars, str.chars (), strLen);
+         setLength (current + strLen);
       }
       return true;
    }
 
    bool erase (size_t index, size_t count = 1) {
-      if (index + count > length_) {
+      if (index + count > length ()) {
          return false;
       }
-      const size_t newLength = length_ - count;
+      const size_t newLength = length () - count;
       const size_t moveSize = newLength - index;
 
       if (moveSize > 0) {
-         memmove (chars_ + index,
-            chars_ + index + count,
+         memmove (buffer () + index,
+            buffer () + index + count,
             moveSize);
       }
 
-      length_ = newLength;
-      chars_[length_] = kNullChar;
+      setLength (newLength);
 
       return true;
    }
@@ -811,7 +865,7 @@ public:
    }
 
    String &ltrim (StringRef characters = "\r\n\t ") {
-      size_t begin = length_;
+      size_t begin = length ();
 
       for (size_t i = 0; i < begin; ++i) {
          if (characters.find (at (i)) == InvalidIndex) {
@@ -819,13 +873,13 @@ public:
             break;
          }
       }
-      return *this = substr (begin, length_ - begin);
+      return *this = substr (begin, length () - begin);
    }
 
    String &rtrim (StringRef characters = "\r\n\t ") {
       size_t end = 0;
 
-      for (size_t i = length_; i > 0; --i) {
+      for (size_t i = length (); i > 0; --i) {
          if (characters.find (at (i - 1)) == InvalidIndex) {
             end = i;
             break;
@@ -840,7 +894,7 @@ public:
 
 public:
    uint32_t hash () const {
-      return detail::fnv1a32_n (chars_, length_);
+      return detail::fnv1a32_n (chars (), length ());
    }
 
    bool contains (StringRef rhs) const {
@@ -848,106 +902,98 @@ public:
    }
 
    bool startsWith (StringRef prefix) const {
-      return detail::starts_with_impl (chars_, length_, prefix.chars (), prefix.length ());
+      return detail::starts_with_impl (chars (), length (), prefix.chars (), prefix.length ());
    }
 
    bool endsWith (StringRef suffix) const {
-      return detail::ends_with_impl (chars_, length_, suffix.chars (), suffix.length ());
+      return detail::ends_with_impl (chars (), length (), suffix.chars (), suffix.length ());
    }
 
    size_t find (char pattern, size_t start = 0) const {
-      return detail::find_char_impl (chars_, length_, pattern, start);
+      return detail::find_char_impl (chars (), length (), pattern, start);
    }
 
    size_t find (StringRef pattern, size_t start = 0) const {
-      return detail::find_str_impl (chars_, length_, pattern.chars (), pattern.length (), start);
+      return detail::find_str_impl (chars (), length (), pattern.chars (), pattern.length (), start);
    }
 
    size_t rfind (char pattern) const {
-      return detail::rfind_char_impl (chars_, length_, pattern);
+      return detail::rfind_char_impl (chars (), length (), pattern);
    }
 
    size_t rfind (StringRef pattern) const {
-      return detail::rfind_str_impl (chars_, length_, pattern.chars (), pattern.length ());
+      return detail::rfind_str_impl (chars (), length (), pattern.chars (), pattern.length ());
    }
 
    size_t findFirstOf (StringRef pattern, size_t start = 0) const {
-      return detail::find_first_of_impl (chars_, length_, pattern.chars (), pattern.length (), start);
+      return detail::find_first_of_impl (chars (), length (), pattern.chars (), pattern.length (), start);
    }
 
    size_t findLastOf (StringRef pattern) const {
-      return detail::find_last_of_impl (chars_, length_, pattern.chars (), pattern.length ());
+      return detail::find_last_of_impl (chars (), length (), pattern.chars (), pattern.length ());
    }
 
    size_t findFirstNotOf (StringRef pattern, size_t start = 0) const {
-      return detail::find_first_not_of_impl (chars_, length_, pattern.chars (), pattern.length (), start);
+      return detail::find_first_not_of_impl (chars (), length (), pattern.chars (), pattern.length (), start);
    }
 
    size_t findLastNotOf (StringRef pattern) const {
-      return detail::find_last_not_of_impl (chars_, length_, pattern.chars (), pattern.length ());
+      return detail::find_last_not_of_impl (chars (), length (), pattern.chars (), pattern.length ());
    }
 
    size_t countChar (char ch) const {
-      return detail::count_char_impl (chars_, length_, ch);
+      return detail::count_char_impl (chars (), length (), ch);
    }
 
    size_t countStr (StringRef pattern) const {
-      return detail::count_str_impl (chars_, length_, pattern.chars (), pattern.length ());
+      return detail::count_str_impl (chars (), length (), pattern.chars (), pattern.length ());
    }
 
    String substr (size_t start, size_t count = InvalidIndex) const {
-      const auto ref = StringRef (chars_, length_).substr (start, count);
+      const auto ref = str ().substr (start, count);
       return String (ref.chars (), ref.length ());
    }
 
    Array <String> split (StringRef delim) const {
-      return StringRef (chars_, length_).split <String> (delim);
+      return str ().split <String> (delim);
    }
 
    Array <String> split (size_t maxLength) const {
-      return StringRef (chars_, length_).split <String> (maxLength);
+      return str ().split <String> (maxLength);
    }
 
 public:
    template <typename U> constexpr U as () const {
       if constexpr (cr::is_same <U, float>::value) {
-         return static_cast <float> (atof (chars_));
+         return static_cast <float> (atof (chars ()));
       }
       else if constexpr (cr::is_same <U, int>::value) {
-         return atoi (chars_);
+         return atoi (chars ());
       }
    }
 
 public:
    char *begin () {
-      return chars_;
+      return buffer ();
    }
 
    const char *begin () const {
-      return chars_;
+      return buffer ();
    }
 
    char *end () {
-      return chars_ + length_;
+      return buffer () + length ();
    }
 
    const char *end () const {
-      return chars_ + length_;
+      return buffer () + length ();
    }
 
 public:
    String &operator = (String &&rhs) noexcept {
       if (this != &rhs) {
-         if (chars_ != empty_) {
-            mem::release (chars_);
-         }
-         chars_ = rhs.chars_;
-         length_ = rhs.length_;
-         capacity_ = rhs.capacity_;
-
-         rhs.chars_ = empty_;
-         rhs.length_ = 0;
-         rhs.capacity_ = 0;
+         release ();
+         steal (rhs);
       }
       return *this;
    }
@@ -973,11 +1019,11 @@ public:
    }
 
    const char &operator [] (size_t index) const {
-      return chars_[index];
+      return buffer ()[index];
    }
 
    char &operator [] (size_t index) {
-      return chars_[index];
+      return buffer ()[index];
    }
 
    friend String operator + (const String &lhs, char rhs) {
@@ -1001,7 +1047,8 @@ public:
    }
 
    friend bool operator == (const String &lhs, const String &rhs) {
-      return lhs.length_ == rhs.length_ && memcmp (lhs.chars_, rhs.chars_, lhs.length_) == 0;
+      const auto length = lhs.length ();
+      return length == rhs.length () && memcmp (lhs.chars (), rhs.chars (), length) == 0;
    }
 
    friend bool operator == (const char *lhs, const String &rhs) {
@@ -1010,9 +1057,10 @@ public:
 
    friend bool operator == (const String &lhs, const char *rhs) {
       if (!rhs) {
-         return lhs.length_ == 0;
+         return lhs.empty ();
       }
-      return strlen (rhs) == lhs.length_ && memcmp (lhs.chars_, rhs, lhs.length_) == 0;
+      const auto length = lhs.length ();
+      return strlen (rhs) == length && memcmp (lhs.chars (), rhs, length) == 0;
    }
 
    friend bool operator != (const String &lhs, const String &rhs) {
@@ -3,14 +3,32 @@
 #pragma once
 
 #include <crlib/basic.h>
+#include <crlib/atomic.h>
 
 #if !defined(CR_WINDOWS)
 #  include <pthread.h>
+#  include <sched.h>
 #  include <errno.h>
+#  if defined(CR_LINUX)
+#     include <sys/resource.h>
+#     include <sys/syscall.h>
+#  elif defined(CR_MACOS)
+#     include <pthread/qos.h>
+#  endif
 #else
 #  include <process.h>
 #endif
 
+// scheduling priority of a thread, maps to nice values on linux, quality of service classes on macos and
+// thread priorities on windows
+CR_DECLARE_SCOPED_ENUM (ThreadPriority,
+   Lowest,
+   Low,
+   Normal,
+   High,
+   Highest
+)
+
 CR_NAMESPACE_BEGIN
 
 // simple scoped lock wrapper
@@ -41,6 +59,21 @@ public:
    }
 };
 
+// scoped shared (reader) lock wrapper, for locks with lockShared/unlockShared
+template <typename T> class ScopedSharedLock final : public NonCopyable {
+private:
+   T &lockable_;
+
+public:
+   ScopedSharedLock (T &lock) : lockable_ (lock) {
+      lockable_.lockShared ();
+   }
+
+   ~ScopedSharedLock () {
+      lockable_.unlockShared ();
+   }
+};
+
 // simple wrapper for critical sections
 #if defined(CR_WINDOWS) && defined(CR_HAS_WINXP_SUPPORT)
 class Mutex final : public NonCopyable {
@@ -91,6 +124,63 @@ public:
 };
 #endif
 
+// reader-writer lock, any number of shared owners or a single exclusive one
+#if defined(CR_WINDOWS) && defined(CR_HAS_WINXP_SUPPORT)
+// no slim reader-writer locks on xp, so shared locking is exclusive there
+class SharedMutex final : public NonCopyable {
+private:
+   Mutex cs_;
+
+public:
+   SharedMutex () = default;
+   ~SharedMutex () = default;
+
+   void lock () { cs_.lock (); }
+   void unlock () { cs_.unlock (); }
+   bool tryLock () { return cs_.tryLock (); }
+
+   void lockShared () { cs_.lock (); }
+   void unlockShared () { cs_.unlock (); }
+   bool tryLockShared () { return cs_.tryLock (); }
+};
+
+#elif defined(CR_WINDOWS)
+class SharedMutex final : public NonCopyable {
+private:
+   SRWLOCK cs_ = SRWLOCK_INIT;
+
+public:
+   SharedMutex () = default;
+   ~SharedMutex () = default;
+
+   void lock () { AcquireSRWLockExclusive (&cs_); }
+   void unlock () { ReleaseSRWLockExclusive (&cs_); }
+   bool tryLock () { return !!TryAcquireSRWLockExclusive (&cs_); }
+
+   void lockShared () { AcquireSRWLockShared (&cs_); }
+   void unlockShared () { ReleaseSRWLockShared (&cs_); }
+   bool tryLockShared () { return !!TryAcquireSRWLockShared (&cs_); }
+};
+
+#else
+class SharedMutex final : public NonCopyable {
+private:
+   pthread_rwlock_t lock_;
+
+public:
+   SharedMutex () { pthread_rwlock_init (&lock_, nullptr); }
+   ~SharedMutex () { pthread_rwlock_destroy (&lock_); }
+
+   void lock () { pthread_rwlock_wrlock (&lock_); }
+   void unlock () { pthread_rwlock_unlock (&lock_); }
+   bool tryLock () { return pthread_rwlock_trywrlock (&lock_) == 0; }
+
+   void lockShared () { pthread_rwlock_rdlock (&lock_); }
+   void unlockShared () { pthread_rwlock_unlock (&lock_); }
+   bool tryLockShared () { return pthread_rwlock_tryrdlock (&lock_) == 0; }
+};
+#endif
+
 // conditional variable (signal)
 #if defined(CR_WINDOWS) && defined(CR_HAS_WINXP_SUPPORT)
 class Signal final : public NonCopyable {
@@ -198,11 +288,30 @@ public:
 using MutexScopedLock = ScopedLock <Mutex>;
 using SignalScopedLock = ScopedLock <Signal>;
 
+// thread creation options, zero or empty fields keep the system defaults, options not supported by the
+// platform are ignored (no affinity on macos, names and priorities on linux, macos and windows only)
+struct ThreadOptions {
+   const char *name {}; // shown in debuggers, top and perf, linux keeps only first 15 characters
+   size_t stackSize {};
+   uint64_t affinity {}; // mask of the first 64 cpus, the thread is allowed to run on
+   ThreadPriority priority { ThreadPriority::Normal };
+};
+
 // basic thread class
 class Thread final : public NonCopyable {
 public:
    using Func = Lambda <void ()>;
 
+private:
+   static constexpr size_t kMaxNameLength = 64;
+
+   // everything the new thread needs, owned by the thread object, as the thread may outlive start ()
+   struct Startup {
+      Func callback;
+      ThreadOptions options;
+      char name[kMaxNameLength];
+   };
+
 private:
 #if defined(CR_WINDOWS)
    HANDLE thread_ {};
@@ -210,28 +319,96 @@ private:
    bool initialized_ {};
    pthread_t thread_ {};
 #endif
-   UniquePtr <Func> invokable_;
+   UniquePtr <Startup> invokable_;
 
 private:
+   static void run (Startup *startup) {
+      configure (startup->options);
+      startup->callback ();
+   }
+
 #if defined(CR_WINDOWS)
    static unsigned int __stdcall worker (void *pinvokable) {
       assert (pinvokable);
-      (*reinterpret_cast <Func *> (pinvokable)) ();
+      run (reinterpret_cast <Startup *> (pinvokable));
       return 0;
    }
 #else
    static void *worker (void *pinvokable) {
       assert (pinvokable);
-      (*reinterpret_cast <Func *> (pinvokable)) ();
+      run (reinterpret_cast <Startup *> (pinvokable));
       return nullptr;
    }
 #endif
 
+   static bool applyName (const char *name) {
+#if defined(CR_WINDOWS)
+      // available since windows 10, so look it up at runtime
+      using SetThreadDescriptionFn = HRESULT (WINAPI *) (HANDLE, PCWSTR);
+      auto fn = reinterpret_cast <SetThreadDescriptionFn> (reinterpret_cast <void *> (GetProcAddress (GetModuleHandleA ("kernel32.dll"), "SetThreadDescription")));
+
+      if (!fn) {
+         return false;
+      }
+      wchar_t wide[kMaxNameLength] {};
+      MultiByteToWideChar (CP_UTF8, 0, name, -1, wide, static_cast <int> (kMaxNameLength) - 1);
+
+      return SUCCEEDED (fn (GetCurrentThread (), wide));
+#elif defined(CR_LINUX)
+      char truncated[16] {};
+      snprintf (truncated, sizeof (truncated), "%s", name);
+
+      return pthread_setname_np (pthread_self (), truncated) == 0;
+#elif defined(CR_MACOS)
+      return pthread_setname_np (name) == 0;
+#else
+      (void) name;
+      return false;
+#endif
+   }
+
+   static bool applyAffinity (const uint64_t affinity) {
+#if defined(CR_WINDOWS)
+      return SetThreadAffinityMask (GetCurrentThread (), static_cast <DWORD_PTR> (affinity)) != 0;
+#elif defined(CR_LINUX)
+      cpu_set_t set;
+      CPU_ZERO (&set);
+
+      for (size_t cpu = 0; cpu < 64; ++cpu) {
+         if (affinity & (static_cast <uint64_t> (1) << cpu)) {
+            CPU_SET (cpu, &set);
+         }
+      }
+      return sched_setaffinity (0, sizeof (set), &set) == 0;
+#else
+      (void) affinity;
+      return false;
+#endif
+   }
+
+   static bool applyPriority (const ThreadPriority priority) {
+#if defined(CR_WINDOWS)
+      constexpr int kPriorities[] = { THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST };
+      return !!SetThreadPriority (GetCurrentThread (), kPriorities[priority]);
+#elif defined(CR_LINUX)
+      // linux threads have their own nice values, raising priority needs privileges and may fail
+      constexpr int kNiceValues[] = { 19, 10, 0, -5, -10 };
+      return setpriority (PRIO_PROCESS, static_cast <id_t> (syscall (SYS_gettid)), kNiceValues[priority]) == 0;
+#elif defined(CR_MACOS)
+      // macos schedules threads by quality of service class, that also decides which cores they run on
+      constexpr qos_class_t kClasses[] = { QOS_CLASS_BACKGROUND, QOS_CLASS_UTILITY, QOS_CLASS_DEFAULT, QOS_CLASS_USER_INITIATED, QOS_CLASS_USER_INTERACTIVE };
+      return pthread_set_qos_class_self_np (kClasses[priority], 0) == 0;
+#else
+      (void) priority;
+      return false;
+#endif
+   }
+
 public:
    Thread () = default;
 
-   explicit Thread (Func &&callback) {
-      start (cr::move (callback));
+   explicit Thread (Func &&callback, const ThreadOptions &options = {}) {
+      start (cr::move (callback), options);
    }
 
    Thread (Thread &&rhs) noexcept {
@@ -269,15 +446,34 @@ public:
       join ();
    }
 
-   void start (Func &&callback) {
+   void start (Func &&callback, const ThreadOptions &options = {}) {
       join ();
 
-      invokable_ = makeUnique <Func> (cr::move (callback));
+      invokable_ = makeUnique <Startup> ();
+      invokable_->callback = cr::move (callback);
+      invokable_->options = options;
+
+      // name is copied, so caller's buffer may go away once start returns
+      if (options.name) {
+         snprintf (invokable_->name, sizeof (invokable_->name), "%s", options.name);
+         invokable_->options.name = invokable_->name;
+      }
 
 #if defined(CR_WINDOWS)
-      thread_ = reinterpret_cast <HANDLE> (_beginthreadex (nullptr, 0, worker, invokable_.get (), 0, nullptr));
+      thread_ = reinterpret_cast <HANDLE> (_beginthreadex (nullptr, static_cast <unsigned> (options.stackSize), worker, invokable_.get (), 0, nullptr));
 #else
-      initialized_ = (pthread_create (&thread_, nullptr, worker, invokable_.get ()) == 0);
+      pthread_attr_t attr;
+      pthread_attr_init (&attr);
+
+      if (options.stackSize > 0) {
+#if defined(PTHREAD_STACK_MIN)
+         pthread_attr_setstacksize (&attr, cr::max <size_t> (options.stackSize, PTHREAD_STACK_MIN));
+#else
+         pthread_attr_setstacksize (&attr, options.stackSize);
+#endif
+      }
+      initialized_ = (pthread_create (&thread_, &attr, worker, invokable_.get ()) == 0);
+      pthread_attr_destroy (&attr);
 #endif
 
       if (!ok ()) {
@@ -325,88 +521,1035 @@ public:
    decltype (auto) handle () const {
       return thread_;
    }
+
+   // applies name, affinity and priority of the options to calling thread (stack size can't be changed
+   // after creation), so the main thread can be pinned too, returns false if any of them failed
+   static bool configure (const ThreadOptions &options) {
+      bool result = true;
+
+      if (options.name && *options.name) {
+         result &= applyName (options.name);
+      }
+
+      if (options.affinity) {
+         result &= applyAffinity (options.affinity);
+      }
+
+      if (options.priority != ThreadPriority::Normal) {
+         result &= applyPriority (options.priority);
+      }
+      return result;
+   }
+
+   // gives the rest of calling thread's time slice to other threads
+   static void yield () {
+#if defined(CR_WINDOWS)
+      SwitchToThread ();
+#else
+      sched_yield ();
+#endif
+   }
 };
 
-// extra simple thread pool
-class ThreadPool final : public NonCopyable {
+// chase-lev work-stealing deque, owning thread pushes and pops at the bottom without locking, while any
+// other thread may steal from the top, items must be trivially copyable (thread pool keeps job pointers)
+template <typename T> class WorkStealingDeque final : public NonCopyable {
+private:
+   // positions are native words, so they are read and written in one piece on 32-bit targets as well,
+   // they wrap around, so they are only compared through their distance
+   using Index = uintptr_t;
+
+   struct Ring {
+      Index mask;
+      Ring *retired; // ring this one replaced, kept alive, as thieves may still read from it
+      Atomic <T> *items;
+   };
+
+   static constexpr Index kInitialCapacity = 64;
+
+private:
+   // thieves write top, owner writes bottom, padding keeps them on separate cache lines, even when
+   // the deque itself lives in heap memory, that isn't cache line aligned
+   Atomic <Index> top_ {};
+   uint8_t topPadding_[kCacheLineSize] {};
+   Atomic <Index> bottom_ {};
+   Atomic <Ring *> ring_ {};
+   uint8_t bottomPadding_[kCacheLineSize] {};
+
+public:
+   explicit WorkStealingDeque () {
+      ring_.store (createRing (kInitialCapacity, nullptr), MemoryOrder::Relaxed);
+   }
+
+   ~WorkStealingDeque () {
+      auto ring = ring_.load (MemoryOrder::Relaxed);
+
+      while (ring) {
+         auto retired = ring->retired;
+
+         mem::release (ring->items);
+         mem::release (ring);
+
+         ring = retired;
+      }
+   }
+
+private:
+   // signed distance from one position to another, stays right across wrap around
+   static intptr_t distance (const Index from, const Index to) {
+      return static_cast <intptr_t> (to - from);
+   }
+
+   static Ring *createRing (const Index capacity, Ring *retired) {
+      auto ring = mem::allocate <Ring> ();
+      ring->mask = capacity - 1;
+      ring->retired = retired;
+      ring->items = mem::allocate <Atomic <T>> (static_cast <size_t> (capacity));
+
+      for (Index i = 0; i < capacity; ++i) {
+         mem::construct (&ring->items[i]);
+      }
+      return ring;
+   }
+
+   // doubles the ring, called by the owner only, when the ring is full
+   Ring *grow (Ring *ring, const Index top, const Index bottom) {
+      auto bigger = createRing ((ring->mask + 1) * 2, ring);
+
+      for (Index i = top; i != bottom; ++i) {
+         bigger->items[i & bigger->mask].store (ring->items[i & ring->mask].load (MemoryOrder::Relaxed), MemoryOrder::Relaxed);
+      }
+      ring_.store (bigger, MemoryOrder::Release);
+
+      return bigger;
+   }
+
+public:
+   // owner only
+   void push (const T &item) {
+      const auto bottom = bottom_.load (MemoryOrder::Relaxed);
+      const auto top = top_.load (MemoryOrder::Acquire);
+      auto ring = ring_.load (MemoryOrder::Relaxed);
+
+      if (bottom - top > ring->mask) {
+         ring = grow (ring, top, bottom);
+      }
+      ring->items[bottom & ring->mask].store (item, MemoryOrder::Relaxed);
+      bottom_.store (bottom + 1, MemoryOrder::Release);
+   }
+
+   // owner only, takes the most recently pushed item
+   bool pop (T &item) {
+      const auto bottom = bottom_.load (MemoryOrder::Relaxed) - 1;
+      auto ring = ring_.load (MemoryOrder::Relaxed);
+
+      // sequentially consistent store and load stand for the store-load fence of the original algorithm
+      bottom_.store (bottom, MemoryOrder::SeqCst);
+      auto top = top_.load (MemoryOrder::SeqCst);
+
+      if (distance (top, bottom) < 0) {
+         bottom_.store (bottom + 1, MemoryOrder::Relaxed);
+         return false;
+      }
+      item = ring->items[bottom & ring->mask].load (MemoryOrder::Relaxed);
+
+      if (distance (top, bottom) > 0) {
+         return true;
+      }
+
+      // last item, race against thieves for it
+      const bool won = top_.compareExchange (top, top + 1, MemoryOrder::SeqCst, MemoryOrder::Relaxed);
+      bottom_.store (bottom + 1, MemoryOrder::Relaxed);
+
+      return won;
+   }
+
+   // any thread, takes the oldest item, fails if empty or lost the race to another thread
+   bool steal (T &item) {
+      auto top = top_.load (MemoryOrder::SeqCst);
+      const auto bottom = bottom_.load (MemoryOrder::SeqCst);
+
+      if (distance (top, bottom) <= 0) {
+         return false;
+      }
+      auto ring = ring_.load (MemoryOrder::Acquire);
+      item = ring->items[top & ring->mask].load (MemoryOrder::Relaxed);
+
+      return top_.compareExchange (top, top + 1, MemoryOrder::SeqCst, MemoryOrder::Relaxed);
+   }
+
+   // approximate, when called concurrently with the owner or thieves
+   size_t length () const {
+      const auto size = distance (top_.load (MemoryOrder::Relaxed), bottom_.load (MemoryOrder::Relaxed));
+      return size > 0 ? static_cast <size_t> (size) : 0;
+   }
+
+   bool empty () const {
+      return length () == 0;
+   }
+};
+
+// test-and-test-and-set lock for very short critical sections, waiters back off from pausing to yielding,
+// so a preempted owner doesn't make them burn their whole time slice
+class SpinLock final : public NonCopyable {
 private:
-   using Func = Thread::Func;
+   static constexpr uint32_t kMaxPauses = 64;
 
 private:
-   bool running_ { false };
-   mutable Signal signal_ {};
+   Atomic <bool> locked_ { false };
+
+public:
+   SpinLock () = default;
+   ~SpinLock () = default;
 
-   Deque <Func> jobs_ {};
-   Array <Thread> threads_;
+public:
+   void lock () {
+      uint32_t pauses = 1;
+
+      while (locked_.exchange (true, MemoryOrder::Acquire)) {
+         // wait on plain loads, so the cache line isn't bounced between waiters
+         while (locked_.load (MemoryOrder::Relaxed)) {
+            if (pauses <= kMaxPauses) {
+               for (uint32_t i = 0; i < pauses; ++i) {
+                  cpuRelax ();
+               }
+               pauses *= 2;
+            }
+            else {
+               Thread::yield ();
+            }
+         }
+      }
+   }
+
+   void unlock () {
+      locked_.store (false, MemoryOrder::Release);
+   }
+
+   bool tryLock () {
+      return !locked_.load (MemoryOrder::Relaxed) && !locked_.exchange (true, MemoryOrder::Acquire);
+   }
+};
+
+// mutex, that spins for a while before going to sleep, spin limit follows how long recent acquisitions had
+// to spin, so short critical sections rarely pay for a syscall, while long ones don't waste cpu
+class AdaptiveMutex final : public NonCopyable {
+private:
+   static constexpr int32_t kMaxSpins = 100;
+
+private:
+   Mutex mutex_ {};
+   Atomic <int32_t> spins_ {}; // running average of spins, that were needed to get the lock
+
+public:
+   AdaptiveMutex () = default;
+   ~AdaptiveMutex () = default;
 
 public:
-   explicit ThreadPool (size_t workers = 0) noexcept {
+   void lock () {
+      if (mutex_.tryLock ()) {
+         return;
+      }
+      const int32_t average = spins_.load (MemoryOrder::Relaxed);
+      const int32_t limit = cr::min (average * 2 + 10, kMaxSpins);
+
+      int32_t count = 0;
+
+      for (;;) {
+         if (count++ >= limit) {
+            mutex_.lock ();
+            break;
+         }
+         cpuRelax ();
+
+         if (mutex_.tryLock ()) {
+            break;
+         }
+      }
+      spins_.store (average + (count - average) / 8, MemoryOrder::Relaxed);
+   }
+
+   void unlock () {
+      mutex_.unlock ();
+   }
+
+   bool tryLock () {
+      return mutex_.tryLock ();
+   }
+};
+
+using SpinScopedLock = ScopedLock <SpinLock>;
+
+template <typename T> class Future;
+
+namespace detail {
+   // job of thread pool, move-only, so it may own its data, captures up to eight pointers in size are kept
+   // inline, so enqueueing usual jobs never allocates
+   using PoolJob = UniqueLambda <void (), sizeof (void *) * 8>;
+
+   // delayed or periodic job, shared between the pool and the handle, freed when both are done with it
+   class TimedJob final : public NonCopyable {
+   public:
+      Atomic <int32_t> refs { 1 };
+      Atomic <bool> cancelled { false };
+      Atomic <uint32_t> runs { 0 };
+      PoolJob fn;
+      uint64_t due {};
+      uint64_t period {};
+
+   public:
+      TimedJob (PoolJob &&fn, const uint64_t due, const uint64_t period) : fn (cr::move (fn)), due (due), period (period) {}
+
+   public:
+      void acquire () {
+         refs.fetchAdd (1, MemoryOrder::Relaxed);
+      }
+
+      void release () {
+         if (refs.fetchSub (1, MemoryOrder::AcqRel) == 1) {
+            auto self = this;
+
+            mem::destruct (self);
+            mem::release (self);
+         }
+      }
+   };
+}
+
+// handle to a delayed or periodic job, dropping the handle doesn't cancel the job
+class ScheduledJob final : public NonCopyable {
+private:
+   detail::TimedJob *job_ {};
+
+public:
+   explicit ScheduledJob () = default;
+
+   explicit ScheduledJob (detail::TimedJob *job) : job_ (job) {
+      job_->acquire ();
+   }
+
+   ScheduledJob (ScheduledJob &&rhs) noexcept : job_ (rhs.job_) {
+      rhs.job_ = nullptr;
+   }
+
+   ScheduledJob &operator = (ScheduledJob &&rhs) noexcept {
+      if (this != &rhs) {
+         reset ();
+
+         job_ = rhs.job_;
+         rhs.job_ = nullptr;
+      }
+      return *this;
+   }
+
+   ~ScheduledJob () {
+      reset ();
+   }
+
+private:
+   void reset () {
+      if (job_) {
+         job_->release ();
+         job_ = nullptr;
+      }
+   }
+
+public:
+   // job won't start anymore, a run, that has already started, still finishes
+   void cancel () {
+      if (job_) {
+         job_->cancelled.store (true, MemoryOrder::Release);
+      }
+   }
+
+   bool cancelled () const {
+      return job_ && job_->cancelled.load (MemoryOrder::Acquire);
+   }
+
+   // number of times the job has run so far
+   uint32_t runs () const {
+      return job_ ? job_->runs.load (MemoryOrder::Acquire) : 0;
+   }
+
+   bool valid () const {
+      return job_ != nullptr;
+   }
+};
+
+// work-stealing thread pool, each worker runs jobs from its own deque, jobs enqueued by a worker go to its
+// own deque, jobs enqueued from outside go to a shared injection queue, idle workers take batches from
+// the injection queue and steal from other workers, so busy workers almost never touch a shared lock
+class ThreadPool final : public NonCopyable {
+private:
+   using Func = detail::PoolJob;
+
+   // job nodes are recycled through free lists instead of going back to the heap
+   struct Job {
+      Func fn;
+      Job *next;
+   };
+
+   struct Worker {
+      ThreadPool *pool {};
+      WorkStealingDeque <Job *> jobs {};
+      Thread thread {};
+      uint32_t seed {};
+      Job *spare {};
+      size_t spares {};
+   };
+
+   static constexpr size_t kInjectBatch = 32;
+   static constexpr size_t kMaxWorkerSpares = kInjectBatch * 2;
+   static constexpr size_t kMaxSharedSpares = 1024;
+   static constexpr uint64_t kMaxTimerWait = 1000;
+
+   // entry of the delayed job heap, earliest deadline on top, same deadlines run in scheduling order
+   struct Timer {
+      uint64_t due;
+      uint64_t sequence;
+      detail::TimedJob *job;
+
+      bool operator < (const Timer &rhs) const {
+         return due < rhs.due || (due == rhs.due && sequence < rhs.sequence);
+      }
+   };
+
+private:
+   Atomic <bool> running_ { false };
+   Atomic <size_t> pending_ {}; // jobs enqueued, but not yet picked up by a worker
+   Atomic <size_t> sleepers_ {};
+   mutable Signal signal_ {}; // used only to park idle workers
+
+   Mutex injectLock_ {};
+   Deque <Job *> injected_ {};
+   Job *spare_ {}; // spare job nodes for enqueueing from outside, guarded by inject lock
+   size_t spares_ {};
+   Array <UniquePtr <Worker>> workers_ {};
+
+   // delayed jobs wait in the heap, the timer thread sleeps until the earliest of them is due, and hands
+   // it over to the workers, so nothing is polled while waiting
+   mutable Signal timerSignal_ {};
+   BinaryHeap <Timer> timers_ {};
+   uint64_t timerSequence_ {};
+   bool timerRunning_ {};
+   Thread timerThread_ {};
+
+   static inline thread_local Worker *current_ {};
+
+public:
+   explicit ThreadPool (size_t workers = 0, const ThreadOptions &options = {}) noexcept {
       if (workers > 0) {
-         startup (workers);
+         startup (workers, options);
       }
    }
 
    ~ThreadPool () {
       shutdown ();
+
+      // jobs enqueued without any worker to run them
+      while (!injected_.empty ()) {
+         auto job = injected_.popFront ();
+
+         mem::destruct (&job->fn);
+         mem::release (job);
+      }
+      releaseSpares (spare_, spares_);
+   }
+
+private:
+   static void releaseSpares (Job *&head, size_t &count) {
+      while (head) {
+         auto next = head->next;
+         mem::release (head);
+
+         head = next;
+      }
+      count = 0;
+   }
+
+   // takes a spare node, if there's any, so steady stream of jobs runs without touching the heap
+   static Job *makeJob (Job *&head, size_t &count, Func &&task) {
+      auto job = head;
+
+      if (job) {
+         head = job->next;
+         --count;
+      }
+      else {
+         job = mem::allocate <Job> ();
+      }
+      mem::construct (&job->fn, cr::move (task));
+      job->next = nullptr;
+
+      return job;
+   }
+
+   // nodes freed on workers go to their own spares, surplus is handed over to the shared spares in
+   // batches, as jobs enqueued from outside are the ones, that end up on workers
+   void recycle (Worker *worker, Job *job) {
+      mem::destruct (&job->fn);
+
+      if (worker) {
+         job->next = worker->spare;
+         worker->spare = job;
+
+         if (++worker->spares < kMaxWorkerSpares) {
+            return;
+         }
+         MutexScopedLock lock (injectLock_);
+
+         while (worker->spares > kMaxWorkerSpares / 2) {
+            job = worker->spare;
+            worker->spare = job->next;
+            --worker->spares;
+
+            shareSpare (job);
+         }
+         return;
+      }
+      MutexScopedLock lock (injectLock_);
+      shareSpare (job);
+   }
+
+   // called with inject lock held
+   void shareSpare (Job *job) {
+      if (spares_ >= kMaxSharedSpares) {
+         mem::release (job);
+         return;
+      }
+      job->next = spare_;
+      spare_ = job;
+      ++spares_;
+   }
+
+   // worker of this pool, that runs on calling thread, if any
+   Worker *self () const {
+      return current_ && current_->pool == this ? current_ : nullptr;
+   }
+
+   // moves a batch of injected jobs to the worker's deque, so other idle workers can steal them
+   Job *takeInjected (Worker *worker) {
+      MutexScopedLock lock (injectLock_);
+
+      if (injected_.empty ()) {
+         return nullptr;
+      }
+      auto job = injected_.popFront ();
+
+      if (worker) {
+         const size_t batch = cr::min (injected_.length () / workers_.length (), kInjectBatch);
+
+         for (size_t i = 0; i < batch; ++i) {
+            worker->jobs.push (injected_.popFront ());
+         }
+      }
+      return job;
+   }
+
+   Job *steal (Worker *worker) {
+      const size_t count = workers_.length ();
+
+      if (count == 0) {
+         return nullptr;
+      }
+      size_t start = 0;
+
+      if (worker) {
+         worker->seed = worker->seed * 1664525u + 1013904223u;
+         start = (worker->seed >> 8) % count;
+      }
+      Job *job = nullptr;
+
+      for (size_t i = 0; i < count; ++i) {
+         auto victim = workers_[(start + i) % count].get ();
+
+         if (victim != worker && victim->jobs.steal (job)) {
+            return job;
+         }
+      }
+      return nullptr;
+   }
+
+   // own deque first, then injected jobs, then other workers
+   Job *take (Worker *worker) {
+      Job *job = nullptr;
+
+      if (worker && worker->jobs.pop (job)) {
+         return job;
+      }
+
+      if (pending_.load (MemoryOrder::Relaxed) == 0) {
+         return nullptr;
+      }
+      job = takeInjected (worker);
+
+      if (!job) {
+         job = steal (worker);
+      }
+      return job;
+   }
+
+   void execute (Worker *worker, Job *job) {
+      pending_.fetchSub (1);
+
+      job->fn ();
+      recycle (worker, job);
+   }
+
+   void run (Worker *worker) {
+      current_ = worker;
+
+      for (;;) {
+         if (auto job = take (worker)) {
+            execute (worker, job);
+            continue;
+         }
+         SignalScopedLock lock (signal_);
+
+         // announce sleeping before checking for jobs, so enqueue either sees a sleeper, or we see its job
+         sleepers_.fetchAdd (1);
+
+         while (running_.load () && pending_.load () == 0) {
+            signal_.wait ();
+         }
+         sleepers_.fetchSub (1);
+
+         if (!running_.load () && pending_.load () == 0) {
+            break;
+         }
+      }
+      current_ = nullptr;
+   }
+
+   // called with timer lock held
+   void pushTimer (detail::TimedJob *job) {
+      timers_.emplace (Timer { job->due, timerSequence_++, job });
+      timerSignal_.notify ();
+   }
+
+   void runTimers () {
+      SignalScopedLock lock (timerSignal_);
+
+      while (timerRunning_) {
+         if (timers_.empty ()) {
+            timerSignal_.wait ();
+            continue;
+         }
+         const auto now = plat.monotonicMillis ();
+         const auto due = timers_.top ().due;
+
+         // signal waits on wall clock, so wake up now and then, in case it jumps back
+         if (due > now) {
+            timerSignal_.wait (cr::min <uint64_t> (due - now, kMaxTimerWait));
+            continue;
+         }
+         auto job = timers_.pop ().job;
+
+         if (job->cancelled.load (MemoryOrder::Acquire)) {
+            job->release ();
+            continue;
+         }
+
+         // heap's reference goes over to the pool job
+         enqueue ([this, job] () {
+            runTimed (job);
+         });
+      }
+   }
+
+   void runTimed (detail::TimedJob *job) {
+      if (!job->cancelled.load (MemoryOrder::Acquire)) {
+         job->fn ();
+         job->runs.fetchAdd (1, MemoryOrder::Release);
+
+         // periodic jobs are put back only after the run, so runs never overlap, and a slow run delays
+         // the next one instead of causing a burst of catching up runs
+         if (job->period > 0 && !job->cancelled.load (MemoryOrder::Acquire)) {
+            SignalScopedLock lock (timerSignal_);
+
+            if (timerRunning_) {
+               job->due = cr::max (job->due + job->period, plat.monotonicMillis ());
+               pushTimer (job);
+
+               return;
+            }
+         }
+      }
+      job->release ();
+   }
+
+   ScheduledJob schedule (const uint64_t due, const uint64_t period, Func &&task) {
+      auto job = mem::allocateAndConstruct <detail::TimedJob> (cr::move (task), due, period);
+      ScheduledJob handle (job);
+
+      SignalScopedLock lock (timerSignal_);
+
+      // timer thread is started on first use, so pools, that never delay anything, don't pay for it
+      if (!timerRunning_) {
+         timerRunning_ = true;
+
+         timerThread_.start ([this] () {
+            runTimers ();
+         });
+      }
+      pushTimer (job);
+
+      return handle;
+   }
+
+   // stops the timer thread and drops delayed jobs, that are not due yet
+   void stopTimers () {
+      {
+         SignalScopedLock lock (timerSignal_);
+
+         timerRunning_ = false;
+         timerSignal_.broadcast ();
+      }
+      timerThread_.join ();
+
+      SignalScopedLock lock (timerSignal_);
+
+      while (!timers_.empty ()) {
+         timers_.pop ().job->release ();
+      }
+   }
+
+   void wakeOne () {
+      if (sleepers_.load () > 0) {
+         SignalScopedLock lock (signal_);
+         signal_.notify ();
+      }
    }
 
 public:
    size_t jobs () noexcept {
-      SignalScopedLock lock (signal_);
-      return jobs_.length ();
+      return pending_.load ();
    }
 
    size_t threadCount () noexcept {
-      return threads_.length ();
+      return workers_.length ();
+   }
+
+public:
+   // runs one pending job on calling thread, returns false if there was nothing to run
+   bool runPending () {
+      auto worker = self ();
+
+      if (auto job = take (worker)) {
+         execute (worker, job);
+         return true;
+      }
+      return false;
+   }
+
+   // runs pending jobs on calling thread, until done returns true, so waiting on results never blocks
+   // a worker, that might be needed to produce them, backs off to yielding, when there's nothing to run
+   template <typename P> void helpUntil (P &&done) {
+      for (uint32_t idle = 0; !done ();) {
+         if (runPending ()) {
+            idle = 0;
+         }
+         else if (++idle < 64) {
+            cpuRelax ();
+         }
+         else {
+            Thread::yield ();
+         }
+      }
    }
 
 public:
    void enqueue (Func &&task) {
-      SignalScopedLock lock (signal_);
+      // counted before it becomes visible, so the counter never drops below the real number of jobs
+      pending_.fetchAdd (1);
+
+      if (auto worker = self ()) {
+         worker->jobs.push (makeJob (worker->spare, worker->spares, cr::move (task)));
+      }
+      else {
+         MutexScopedLock lock (injectLock_);
+         injected_.emplaceLast (makeJob (spare_, spares_, cr::move (task)));
+      }
+      wakeOne ();
+   }
+
+   // runs the job once, after delay milliseconds
+   ScheduledJob enqueueAfter (const uint64_t delay, Func &&task) {
+      return schedule (plat.monotonicMillis () + delay, 0, cr::move (task));
+   }
+
+   // runs the job once at the given time of plat.monotonicMillis () clock
+   ScheduledJob enqueueAt (const uint64_t time, Func &&task) {
+      return schedule (time, 0, cr::move (task));
+   }
 
-      jobs_.emplaceLast (cr::move (task));
-      signal_.notify ();
+   // runs the job every period milliseconds (first time after one period), until cancelled
+   ScheduledJob enqueueEvery (const uint64_t period, Func &&task) {
+      return schedule (plat.monotonicMillis () + period, cr::max <uint64_t> (period, 1), cr::move (task));
    }
 
+   // number of delayed jobs, that are not due yet (including cancelled ones, until their time comes)
+   size_t scheduled () const {
+      SignalScopedLock lock (timerSignal_);
+      return timers_.length ();
+   }
+
+   // same as enqueue, but the result of fn (or just completion for void) can be obtained through the future
+   template <typename F> auto submit (F &&fn) -> Future <decltype (cr::declval <typename decay <F>::type &> () ())>;
+
+   // stops the workers, once they run out of jobs, and waits for them to finish, delayed jobs, that are
+   // not due yet, are dropped
    void shutdown () {
+      stopTimers ();
       {
          SignalScopedLock lock (signal_);
-         running_ = false;
+         running_.store (false);
          signal_.broadcast ();
       }
 
-      for (auto &thread : threads_) {
-         thread.join ();
+      for (auto &worker : workers_) {
+         worker->thread.join ();
+         releaseSpares (worker->spare, worker->spares);
       }
-      threads_.clear ();
+      workers_.clear ();
    }
 
-   void startup (size_t workers) {
-      {
-         SignalScopedLock lock (signal_);
-         running_ = true;
+   // starts the workers, running pool is shut down first, as the set of workers is fixed while running,
+   // options apply to every worker, named workers get their index appended ("name-0", "name-1", ...)
+   void startup (size_t workers, const ThreadOptions &options = {}) {
+      if (!workers_.empty ()) {
+         shutdown ();
       }
+      running_.store (true);
 
       for (size_t i = 0; i < workers; ++i) {
-         threads_.emplace ([this] () {
-            for (;;) {
-               Func job {};
-               {
-                  SignalScopedLock lock (signal_);
-
-                  while (running_ && jobs_.empty ()) {
-                     signal_.wait ();
-                  }
-
-                  if (!running_ && jobs_.empty ()) {
-                     return;
-                  }
-                  job = cr::move (jobs_.popFront ());
-               }
-               job ();
+         auto worker = makeUnique <Worker> ();
+
+         worker->pool = this;
+         worker->seed = static_cast <uint32_t> (i) * 7919u + 1u;
+
+         workers_.push (cr::move (worker));
+      }
+
+      // workers may steal from each other, so start them only after all of them exist
+      for (size_t i = 0; i < workers_.length (); ++i) {
+         auto worker = workers_[i].get ();
+
+         ThreadOptions workerOptions = options;
+         char name[64] {};
+
+         if (options.name) {
+            snprintf (name, sizeof (name), "%s-%zu", options.name, i);
+            workerOptions.name = name;
+         }
+
+         worker->thread.start ([this, worker] () {
+            run (worker);
+         }, workerOptions);
+      }
+   }
+};
+
+namespace detail {
+   template <typename T> struct FutureStorage {
+      alignas (T) uint8_t data[sizeof (T)];
+
+      T &value () {
+         return *reinterpret_cast <T *> (data);
+      }
+   };
+
+   template <> struct FutureStorage <void> {};
+
+   // result shared between the future and the job, that produces it, freed when both are gone
+   template <typename T> class FutureState final : public NonCopyable {
+   public:
+      Atomic <int32_t> refs { 1 };
+      Atomic <bool> ready { false };
+      ThreadPool *pool {};
+      FutureStorage <T> storage;
+
+   public:
+      explicit FutureState (ThreadPool *pool) : pool (pool) {}
+
+   public:
+      void acquire () {
+         refs.fetchAdd (1, MemoryOrder::Relaxed);
+      }
+
+      void release () {
+         if (refs.fetchSub (1, MemoryOrder::AcqRel) != 1) {
+            return;
+         }
+
+         if constexpr (!is_same <T, void>::value) {
+            if (ready.load (MemoryOrder::Acquire)) {
+               mem::destruct (&storage.value ());
             }
-         });
+         }
+         auto self = this;
+
+         mem::destruct (self);
+         mem::release (self);
+      }
+   };
+
+   // job side of the future, move-only, as pool jobs don't need to be copied
+   template <typename T> class FuturePromise final : public NonCopyable {
+   private:
+      FutureState <T> *state_ {};
+
+   public:
+      explicit FuturePromise (FutureState <T> *state) : state_ (state) {
+         state_->acquire ();
+      }
+
+      FuturePromise (FuturePromise &&rhs) noexcept : state_ (rhs.state_) {
+         rhs.state_ = nullptr;
+      }
+
+      FuturePromise &operator = (FuturePromise &&) = delete;
+
+      ~FuturePromise () {
+         if (state_) {
+            state_->release ();
+         }
+      }
+
+   public:
+      // callable is taken by non-const reference, so mutable jobs can be fulfilled
+      template <typename F> void fulfil (F &fn) const {
+         if constexpr (is_same <T, void>::value) {
+            fn ();
+         }
+         else {
+            mem::construct (&state_->storage.value (), fn ());
+         }
+         state_->ready.store (true, MemoryOrder::Release);
+      }
+   };
+}
+
+// handle to the result of a job submitted to thread pool, waiting on it helps the pool with pending jobs
+template <typename T> class Future final : public NonCopyable {
+private:
+   using State = detail::FutureState <T>;
+
+private:
+   State *state_ {};
+
+public:
+   explicit Future () = default;
+   explicit Future (State *state) : state_ (state) {}
+
+   Future (Future &&rhs) noexcept : state_ (rhs.state_) {
+      rhs.state_ = nullptr;
+   }
+
+   Future &operator = (Future &&rhs) noexcept {
+      if (this != &rhs) {
+         reset ();
+
+         state_ = rhs.state_;
+         rhs.state_ = nullptr;
+      }
+      return *this;
+   }
+
+   ~Future () {
+      reset ();
+   }
+
+private:
+   void reset () {
+      if (state_) {
+         state_->release ();
+         state_ = nullptr;
+      }
+   }
+
+public:
+   bool valid () const {
+      return state_ != nullptr;
+   }
+
+   bool ready () const {
+      return state_ && state_->ready.load (MemoryOrder::Acquire);
+   }
+
+   void wait () const {
+      if (!state_) {
+         return;
       }
+      auto state = state_;
+
+      state->pool->helpUntil ([state] () {
+         return state->ready.load (MemoryOrder::Acquire);
+      });
+   }
+
+   // waits for the job and moves its result out, so it should be called once
+   auto get () {
+      wait ();
+
+      if constexpr (!is_same <T, void>::value) {
+         return cr::move (state_->storage.value ());
+      }
+   }
+};
+
+template <typename F> auto ThreadPool::submit (F &&fn) -> Future <decltype (cr::declval <typename decay <F>::type &> () ())> {
+   using Result = decltype (cr::declval <typename decay <F>::type &> () ());
+   using State = detail::FutureState <Result>;
+
+   auto state = mem::allocateAndConstruct <State> (this);
+   Future <Result> future (state);
+
+   enqueue ([promise = detail::FuturePromise <Result> (state), fn = cr::forward <F> (fn)] () mutable {
+      promise.fulfil (fn);
+   });
+   return future;
+}
+
+// set of jobs, that can be joined at once, like per-frame work fanned out over the pool, waiting thread
+// runs pending jobs itself instead of blocking
+class TaskGroup final : public NonCopyable {
+private:
+   ThreadPool &pool_;
+   Atomic <size_t> pending_ {};
+
+public:
+   explicit TaskGroup (ThreadPool &pool) : pool_ (pool) {}
+
+   ~TaskGroup () {
+      wait ();
+   }
+
+public:
+   // jobs may run more jobs in the same group
+   template <typename F> void run (F &&fn) {
+      pending_.fetchAdd (1, MemoryOrder::Relaxed);
+
+      pool_.enqueue ([this, fn = cr::forward <F> (fn)] () mutable {
+         fn ();
+
+         // last touch of the group, waiter may destroy it right after
+         pending_.fetchSub (1, MemoryOrder::Release);
+      });
+   }
+
+   void wait () {
+      pool_.helpUntil ([this] () {
+         return pending_.load (MemoryOrder::Acquire) == 0;
+      });
+   }
+
+   bool done () const {
+      return pending_.load (MemoryOrder::Acquire) == 0;
+   }
+
+   size_t pending () const {
+      return pending_.load (MemoryOrder::Relaxed);
    }
 };
 
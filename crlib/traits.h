@@ -80,6 +80,20 @@ template <typename T> struct remove_cv <const volatile T> {
 
 template <typename T> using remove_cv_t = typename remove_cv<T>::type;
 
+template <typename T> struct remove_pointer {
+   using type = T;
+};
+
+template <typename T> struct remove_pointer <T *> {
+   using type = T;
+};
+
+template <typename T> struct remove_pointer <T *const> {
+   using type = T;
+};
+
+template <typename T> using remove_pointer_t = typename remove_pointer <T>::type;
+
 template <typename T> struct remove_const {
    using type = T;
 };
@@ -95,6 +109,8 @@ template <typename T > struct enable_if <true, T> { typedef T type; };
 
 template <bool b, class T = void> using enable_if_t = typename enable_if <b, T>::type;
 
+template <typename...> using void_t = void;
+
 // defined nullptr type
 using nullptr_t = decltype (nullptr);
 
@@ -119,4 +135,7 @@ template <typename T, typename F> struct conditional <false, T, F> { using type
 template <typename T> struct is_trivially_copyable : bool_constant <__is_trivially_copyable(T)> {};
 template <typename T> inline constexpr bool is_trivially_copyable_v = is_trivially_copyable<T>::value;
 
+template <typename T> struct is_trivially_default_constructible : bool_constant <__is_trivially_constructible(T)> {};
+template <typename T> inline constexpr bool is_trivially_default_constructible_v = is_trivially_default_constructible<T>::value;
+
 CR_NAMESPACE_END
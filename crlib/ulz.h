@@ -8,11 +8,25 @@
 #pragma once
 
 #include <crlib/array.h>
+#include <crlib/files.h>
+#include <crlib/lambda.h>
+#include <crlib/parallel.h>
+
+// trade-off between compression speed and ratio, every level produces the same format, so decompression
+// doesn't depend on it
+CR_DECLARE_SCOPED_ENUM (ULZLevel,
+   Fast, // short match chains, no lazy matching
+   Default, // greedy matching with one step lazy check
+   High, // long match chains, and price based optimal parsing, for data compressed once and read many times
+)
 
 CR_NAMESPACE_BEGIN
 
 // see https://github.com/encode84/ulz/
-class ULZ final : public Singleton <ULZ> {
+// compressor state, owns match tables, so every thread or connection can keep its own context, tables are
+// sized by the input and never cleared in full: positions are stored shifted by a base, that moves past
+// every compressed input, so entries left by previous calls fall behind it, and are seen as empty
+class ULZContext : public NonCopyable {
 public:
    enum : int32_t {
       Excess = 16,
@@ -26,15 +40,38 @@ private:
       WindowMask = WindowSize - 1,
 
       MinMatch = 4,
-      MaxChain = cr::bit (5),
+      CopySlack = 16,
+      FastChain = cr::bit (2),
+      DefaultChain = cr::bit (5),
+      HighChain = cr::bit (8),
 
-      HashBits = 19,
-      HashLength = cr::bit (HashBits),
-      EmptyHash = -1,
+      // optimal parser takes matches this long right away, instead of pricing every length of them
+      NiceLength = 128,
+      OptimalWindow = cr::bit (16),
+      NoPrice = 0x7fffffff,
+
+      MinHashBits = 10,
+      MaxHashBits = 19,
+
+      MaxBase = 0x7fffffff
+   };
+
+   // cheapest known way to reach position of the input in optimal parsing
+   struct Step {
+      int32_t price; // in bits
+      int32_t length; // of match ending here, zero for literal
+      int32_t dist;
+      int32_t literals; // run of literals ending here
    };
 
    SmallArray <int32_t> hashTable_ {};
    SmallArray <int32_t> prevTable_ {};
+   SmallArray <Step> steps_ {};
+
+   int32_t base_ { 1 }; // zeroed tables are empty as well
+   int32_t hashShift_ { 32 - MaxHashBits };
+   int32_t prevMask_ { WindowMask };
+   int32_t maxChain_ { DefaultChain };
 
 private:
    static uint32_t load16 (const uint8_t *ptr) {
@@ -51,6 +88,13 @@ private:
       return ret;
    }
 
+   static uint64_t load64 (const uint8_t *ptr) {
+      uint64_t ret;
+      memcpy (&ret, ptr, sizeof (uint64_t));
+
+      return ret;
+   }
+
    static void store16 (uint8_t *ptr, uint16_t val) {
       memcpy (ptr, &val, sizeof (uint16_t));
    }
@@ -59,6 +103,11 @@ private:
       memcpy (dst, src, sizeof (uint64_t));
    }
 
+   static void copy16 (uint8_t *dst, const uint8_t *src) {
+      memcpy (dst, src, 2 * sizeof (uint64_t));
+   }
+
+   // copies exactly count bytes, for buffers without slack, and for matches at least eight bytes back
    static void wildCopy (uint8_t *dst, const uint8_t *src, int32_t count) {
       int32_t i = 0;
       for (; i + 8 <= count; i += 8) {
@@ -69,8 +118,41 @@ private:
       }
    }
 
-   static uint32_t hash32 (const uint8_t *ptr) {
-      return (load32 (ptr) * 0x9e3779b9) >> (32 - HashBits);
+   // copies count bytes rounded up to 16, so reads and writes go up to CopySlack bytes past count, source
+   // has to be either separate buffer, or at least sixteen bytes back
+   static void wildCopy16 (uint8_t *dst, const uint8_t *src, int32_t count) {
+      for (int32_t i = 0; i < count; i += 16) {
+         copy16 (dst + i, src + i);
+      }
+   }
+
+   // length of common prefix of a and b, starting from already matched length, up to limit, eight bytes
+   // are compared at once, and first differing byte is found from trailing zeros of their xor
+   static int32_t matchLength (const uint8_t *a, const uint8_t *b, int32_t length, int32_t limit) {
+      while (length + 8 <= limit) {
+         const auto diff = load64 (a + length) ^ load64 (b + length);
+
+         if (diff != 0) {
+#if defined(CR_ARCH_CPU_BIG_ENDIAN)
+            while (a[length] == b[length]) {
+               ++length;
+            }
+            return length;
+#else
+            return length + (cr::countr_zero (diff) >> 3);
+#endif
+         }
+         length += 8;
+      }
+
+      while (length < limit && a[length] == b[length]) {
+         ++length;
+      }
+      return length;
+   }
+
+   uint32_t hash32 (const uint8_t *ptr) const {
+      return (load32 (ptr) * 0x9e3779b9) >> hashShift_;
    }
 
    static void emitByte (uint8_t *&dst, int32_t val) {
@@ -87,6 +169,16 @@ private:
       *ptr++ = static_cast <uint8_t> (val);
    }
 
+   static int32_t varIntLength (uint32_t val) {
+      int32_t length = 1;
+
+      while (val >= 128) {
+         val = (val - 128) >> 7;
+         ++length;
+      }
+      return length;
+   }
+
    static uint32_t decodeVarInt (const uint8_t *&ptr, const uint8_t *end) {
       uint32_t val = 0;
 
@@ -104,31 +196,69 @@ private:
       return val;
    }
 
+   // sizes tables for the input, and moves the base past the previous one
+   void prepare (int32_t inputLength) {
+      int32_t bits = MinHashBits;
+
+      while (bits < MaxHashBits && cr::bit (bits) < inputLength) {
+         ++bits;
+      }
+      hashShift_ = 32 - bits;
+
+      // chains never reach past the window, nor past the input, so there's no need for more slots
+      const auto prevLength = cr::min <int32_t> (cr::bit (bits), WindowSize);
+      prevMask_ = prevLength - 1;
+
+      if (hashTable_.length () < static_cast <size_t> (cr::bit (bits))) {
+         hashTable_.resize (static_cast <size_t> (cr::bit (bits)));
+      }
+
+      if (prevTable_.length () < static_cast <size_t> (prevLength)) {
+         prevTable_.resize (static_cast <size_t> (prevLength));
+      }
+
+      // positions are about to overflow, so tables are cleared for real, once in two gigabytes of input
+      if (base_ > MaxBase - inputLength) {
+         for (auto &htb : hashTable_) {
+            htb = 0;
+         }
+
+         for (auto &ptb : prevTable_) {
+            ptb = 0;
+         }
+         base_ = 1;
+      }
+   }
+
    void updateChain (const uint8_t *in, int32_t pos) {
       const auto hash = hash32 (&in[pos]);
+      const auto stored = base_ + pos;
+
+      prevTable_[stored & prevMask_] = hashTable_[hash];
+      hashTable_[hash] = stored;
+   }
 
-      prevTable_[pos & WindowMask] = hashTable_[hash];
-      hashTable_[hash] = pos;
+   // stored positions below the base are left from previous inputs, and end the chain
+   int32_t chainLimit (int32_t cur) const {
+      return cr::max <int32_t> (base_ + cur - WindowSize, base_ - 1);
    }
 
    int32_t findBestMatch (const uint8_t *in, int32_t cur, int32_t maxMatch, int32_t &dist) const {
-      const auto limit = cr::max <int32_t> (cur - WindowSize, EmptyHash);
+      const auto limit = chainLimit (cur);
 
-      int32_t chainLength = MaxChain;
+      int32_t chainLength = maxChain_;
       int32_t lookup = hashTable_[hash32 (&in[cur])];
       int32_t bestLength = 0;
 
       while (lookup > limit) {
-         if (in[lookup + bestLength] == in[cur + bestLength] && load32 (&in[lookup]) == load32 (&in[cur])) {
-            int32_t length = MinMatch;
+         const auto match = lookup - base_;
 
-            while (length < maxMatch && in[lookup + length] == in[cur + length]) {
-               ++length;
-            }
+         if (in[match + bestLength] == in[cur + bestLength] && load32 (&in[match]) == load32 (&in[cur])) {
+            const auto length = matchLength (&in[match], &in[cur], MinMatch, maxMatch);
 
             if (length > bestLength) {
                bestLength = length;
-               dist = cur - lookup;
+               dist = cur - match;
 
                if (length == maxMatch) {
                   break;
@@ -139,26 +269,22 @@ private:
          if (--chainLength == 0) {
             break;
          }
-         lookup = prevTable_[lookup & WindowMask];
+         lookup = prevTable_[lookup & prevMask_];
       }
       return bestLength;
    }
 
    bool hasLazyMatch (const uint8_t *in, int32_t next, int32_t target) const {
-      const auto limit = cr::max <int32_t> (next - WindowSize, EmptyHash);
+      const auto limit = chainLimit (next);
 
-      int32_t chainLength = MaxChain;
+      int32_t chainLength = maxChain_;
       int32_t lookup = hashTable_[hash32 (&in[next])];
 
       while (lookup > limit) {
-         if (in[lookup + target - 1] == in[next + target - 1] && load32 (&in[lookup]) == load32 (&in[next])) {
-            int32_t length = MinMatch;
+         const auto match = lookup - base_;
 
-            while (length < target && in[lookup + length] == in[next + length]) {
-               ++length;
-            }
-
-            if (length == target) {
+         if (in[match + target - 1] == in[next + target - 1] && load32 (&in[match]) == load32 (&in[next])) {
+            if (matchLength (&in[match], &in[next], MinMatch, target) == target) {
                return true;
             }
          }
@@ -166,7 +292,7 @@ private:
          if (--chainLength == 0) {
             break;
          }
-         lookup = prevTable_[lookup & WindowMask];
+         lookup = prevTable_[lookup & prevMask_];
       }
       return false;
    }
@@ -185,21 +311,37 @@ private:
       op += run;
    }
 
-public:
-   explicit ULZ () {
-      hashTable_.resize (HashLength);
-      prevTable_.resize (WindowSize);
-   }
+   // match along with literals before it
+   void emitMatch (uint8_t *&op, const uint8_t *in, int32_t anchor, int32_t cur, int32_t matchLength, int32_t dist) {
+      const auto length = matchLength - MinMatch;
+      const auto token = ((dist >> 12) & 16) + cr::min <int32_t> (length, 15);
 
-   ~ULZ () = default;
+      if (anchor != cur) {
+         emitLiterals (op, in, anchor, cur, token);
+      }
+      else {
+         emitByte (op, token);
+      }
 
-public:
-   int32_t compress (const uint8_t *in, int32_t inputLength, uint8_t *out) {
-      for (auto &htb : hashTable_) {
-         htb = EmptyHash;
+      if (length >= 15) {
+         encodeVarInt (op, length - 15);
       }
-      auto op = out;
+      store16 (op, static_cast <uint16_t> (dist));
+      op += 2;
+   }
+
+   // encoded size of literal run in bits, run length goes into the token of the next match up to six
+   static int32_t literalsPrice (int32_t run) {
+      return run * 8 + (run >= 7 ? varIntLength (run - 7) * 8 : 0);
+   }
 
+   // encoded size of match in bits, token and distance, and extra length bytes for long matches
+   static int32_t matchPrice (int32_t matchLength) {
+      const auto length = matchLength - MinMatch;
+      return 24 + (length >= 15 ? varIntLength (length - 15) * 8 : 0);
+   }
+
+   void compressGreedy (const uint8_t *in, int32_t inputLength, uint8_t *&op, bool lazy) {
       int32_t anchor = 0;
       int32_t cur = 0;
 
@@ -218,59 +360,194 @@ public:
             bestLength = 0;
          }
 
-         // lazy matching: check if next position yields a better match
-         if (bestLength >= MinMatch && bestLength < maxMatch && (cur - anchor) != 6) {
+         // lazy matching: check if next position yields a better match (it has to fit into the input)
+         if (lazy && bestLength >= MinMatch && bestLength + 1 < maxMatch && (cur - anchor) != 6) {
             if (hasLazyMatch (in, cur + 1, bestLength + 1)) {
                bestLength = 0;
             }
          }
 
          if (bestLength >= MinMatch) {
-            const auto length = bestLength - MinMatch;
-            const auto token = ((dist >> 12) & 16) + cr::min <int32_t> (length, 15);
-
-            if (anchor != cur) {
-               emitLiterals (op, in, anchor, cur, token);
-            }
-            else {
-               emitByte (op, token);
-            }
-
-            if (length >= 15) {
-               encodeVarInt (op, length - 15);
-            }
-            store16 (op, static_cast <uint16_t> (dist));
-            op += 2;
+            emitMatch (op, in, anchor, cur, bestLength, dist);
 
             while (bestLength-- != 0) {
-               updateChain (in, cur);
+               if (cur + MinMatch <= inputLength) {
+                  updateChain (in, cur);
+               }
                ++cur;
             }
             anchor = cur;
          }
          else {
-            updateChain (in, cur);
+            // last few bytes can't start a match, and hashing them would read past the input
+            if (maxMatch >= MinMatch) {
+               updateChain (in, cur);
+            }
             ++cur;
          }
       }
 
       if (anchor != cur) {
-         const auto run = cur - anchor;
+         emitLiterals (op, in, anchor, cur, 0);
+      }
+   }
+
+   // prices the cheapest way to reach every position of the window going forward, taking the longest
+   // match at each of them in every length, then emits the cheapest path, that ends at the end of the
+   // window, matches may reach back past the window start, but not past its end
+   void parseWindow (const uint8_t *in, int32_t start, int32_t end, int32_t inputLength, uint8_t *&op, int32_t &anchor) {
+      const auto window = end - start;
+      auto steps = steps_.data ();
+
+      for (int32_t i = 0; i <= window; ++i) {
+         steps[i] = { NoPrice, 0, 0, 0 };
+      }
+
+      // literals left over from previous window are still pending, so they are priced in here
+      steps[0].price = 0;
+      steps[0].literals = start - anchor;
+
+      auto relax = [steps] (int32_t to, int32_t price, int32_t length, int32_t dist, int32_t literals) {
+         if (price < steps[to].price) {
+            steps[to] = { price, length, dist, literals };
+         }
+      };
+
+      for (int32_t cur = start; cur < end;) {
+         const int32_t maxMatch = end - cur;
+         const auto &step = steps[cur - start];
+
+         // literals price grows in steps, so the run ending here decides the price of the next one
+         relax (cur - start + 1, step.price + literalsPrice (step.literals + 1) - literalsPrice (step.literals), 0, 0, step.literals + 1);
+
+         // last few bytes of the input can't start a match, and hashing them would read past the input
+         if (cur + MinMatch > inputLength) {
+            ++cur;
+            continue;
+         }
+
+         if (maxMatch < MinMatch) {
+            updateChain (in, cur);
+
+            ++cur;
+            continue;
+         }
+         int32_t dist = 0;
+         const auto bestLength = findBestMatch (in, cur, maxMatch, dist);
+
+         updateChain (in, cur);
+
+         if (bestLength >= NiceLength) {
+            relax (cur - start + bestLength, step.price + matchPrice (bestLength), bestLength, dist, 0);
+
+            for (int32_t i = 1; i < bestLength; ++i) {
+               if (cur + i + MinMatch <= inputLength) {
+                  updateChain (in, cur + i);
+               }
+            }
+            cur += bestLength;
+            continue;
+         }
 
-         if (run >= 7) {
-            emitByte (op, 7 << 5);
-            encodeVarInt (op, run - 7);
+         for (int32_t length = MinMatch; length <= bestLength; ++length) {
+            relax (cur - start + length, step.price + matchPrice (length), length, dist, 0);
+         }
+         ++cur;
+      }
+
+      // turn the path, that is linked backwards from the end, into forward one
+      int32_t pos = window;
+      int32_t length = 0;
+      int32_t dist = 0;
+
+      while (pos > 0) {
+         const auto backLength = steps[pos].length;
+         const auto backDist = steps[pos].dist;
+
+         steps[pos].length = length;
+         steps[pos].dist = dist;
+
+         length = backLength;
+         dist = backDist;
+
+         pos -= backLength > 0 ? backLength : 1;
+      }
+      steps[0].length = length;
+      steps[0].dist = dist;
+
+      for (int32_t cur = start; cur < end;) {
+         const auto &step = steps[cur - start];
+
+         if (step.length > 0) {
+            emitMatch (op, in, anchor, cur, step.length, step.dist);
+
+            cur += step.length;
+            anchor = cur;
          }
          else {
-            emitByte (op, run << 5);
+            ++cur;
          }
-         wildCopy (op, &in[anchor], run);
-         op += run;
       }
+   }
+
+   // parses the input in windows of OptimalWindow bytes, so path state stays bounded for any input size
+   void compressOptimal (const uint8_t *in, int32_t inputLength, uint8_t *&op) {
+      const auto window = cr::min <int32_t> (inputLength, OptimalWindow);
+
+      if (steps_.length () < static_cast <size_t> (window) + 1) {
+         steps_.resize (static_cast <size_t> (window) + 1);
+      }
+      int32_t anchor = 0;
+
+      for (int32_t start = 0; start < inputLength; start += OptimalWindow) {
+         parseWindow (in, start, cr::min <int32_t> (inputLength, start + OptimalWindow), inputLength, op, anchor);
+      }
+
+      if (anchor != inputLength) {
+         emitLiterals (op, in, anchor, inputLength, 0);
+      }
+   }
+
+public:
+   // worst case compressed length, incompressible input grows by a byte per literal run
+   static constexpr int32_t bound (const int32_t length) {
+      return length + length / 128 + Excess;
+   }
+
+public:
+   // tables are allocated by the first compress, and grow with the input
+   explicit ULZContext () = default;
+   ~ULZContext () = default;
+
+public:
+   int32_t compress (const uint8_t *in, int32_t inputLength, uint8_t *out, ULZLevel level = ULZLevel::Default) {
+      prepare (inputLength);
+      auto op = out;
+
+      switch (level) {
+      case ULZLevel::Fast:
+         maxChain_ = FastChain;
+         compressGreedy (in, inputLength, op, false);
+         break;
+
+      case ULZLevel::Default:
+      default:
+         maxChain_ = DefaultChain;
+         compressGreedy (in, inputLength, op, true);
+         break;
+
+      case ULZLevel::High:
+         maxChain_ = HighChain;
+         compressOptimal (in, inputLength, op);
+         break;
+      }
+      base_ += inputLength;
+
       return static_cast <int32_t> (op - out);
    }
 
-   int32_t uncompress (const uint8_t *in, int32_t inputLength, uint8_t *out, int32_t outLength) {
+   // needs no tables, so it may be called on any thread
+   static int32_t uncompress (const uint8_t *in, int32_t inputLength, uint8_t *out, int32_t outLength) {
       auto op = out;
       auto ip = in;
 
@@ -290,7 +567,14 @@ public:
             if ((opEnd - op) < run || (ipEnd - ip) < run) {
                return UncompressFailure;
             }
-            wildCopy (op, ip, run);
+
+            // away from the ends of buffers literals are copied with overshoot
+            if ((opEnd - op) >= run + CopySlack && (ipEnd - ip) >= run + CopySlack) {
+               wildCopy16 (op, ip, run);
+            }
+            else {
+               wildCopy (op, ip, run);
+            }
 
             op += run;
             ip += run;
@@ -321,7 +605,11 @@ public:
          }
          auto cp = op - dist;
 
-         if (dist >= 8) {
+         if (dist >= 16 && (opEnd - op) >= length + CopySlack) {
+            wildCopy16 (op, cp, length);
+            op += length;
+         }
+         else if (dist >= 8) {
             wildCopy (op, cp, length);
             op += length;
          }
@@ -340,4 +628,878 @@ public:
    }
 };
 
+// process-wide context, kept for callers compressing from a single thread
+class ULZ final : public ULZContext, public Singleton <ULZ> {
+public:
+   explicit ULZ () = default;
+   ~ULZ () = default;
+};
+
+namespace detail {
+   // layout of the framed ulz stream, all numbers are little endian:
+   //   header:  magic "ULZF", flags, log2 of block size, content size (8 bytes, if flagged)
+   //   block:   length (4 bytes, top bit set for blocks stored as is, zero ends the frame), payload
+   //   trailer: adler-32 of the content (4 bytes, if flagged)
+   //   index:   per block offset of its length in the frame (8 bytes) and its content length (4 bytes),
+   //            then block count and magic "ULZI" (4 bytes each), if flagged
+   // blocks are compressed independently of each other, so memory is bounded by the block size, and with
+   // the index blocks can be found from the end of the frame, and decoded concurrently
+   struct ULZFrame {
+      static constexpr uint32_t kMagic = 0x465a4c55;
+      static constexpr uint32_t kIndexMagic = 0x495a4c55;
+      static constexpr uint8_t kChecksumFlag = 0x01;
+      static constexpr uint8_t kContentSizeFlag = 0x02;
+      static constexpr uint8_t kIndexFlag = 0x04;
+      static constexpr uint8_t kKnownFlags = kChecksumFlag | kContentSizeFlag | kIndexFlag;
+      static constexpr uint32_t kStoredBlock = 0x80000000u;
+      static constexpr uint32_t kMinBlockBits = 12;
+      static constexpr uint32_t kMaxBlockBits = 24;
+      static constexpr size_t kMinHeaderSize = 6;
+      static constexpr size_t kMaxHeaderSize = 14;
+      static constexpr size_t kIndexEntrySize = 12;
+      static constexpr size_t kIndexFooterSize = 8;
+
+      static void put32 (uint8_t *ptr, const uint32_t value) {
+         for (size_t i = 0; i < 4; ++i) {
+            ptr[i] = static_cast <uint8_t> (value >> (i * 8));
+         }
+      }
+
+      static void put64 (uint8_t *ptr, const uint64_t value) {
+         put32 (ptr, static_cast <uint32_t> (value));
+         put32 (ptr + 4, static_cast <uint32_t> (value >> 32));
+      }
+
+      static uint32_t get32 (const uint8_t *ptr) {
+         return static_cast <uint32_t> (ptr[0]) | static_cast <uint32_t> (ptr[1]) << 8 | static_cast <uint32_t> (ptr[2]) << 16 | static_cast <uint32_t> (ptr[3]) << 24;
+      }
+
+      static uint64_t get64 (const uint8_t *ptr) {
+         return static_cast <uint64_t> (get32 (ptr)) | static_cast <uint64_t> (get32 (ptr + 4)) << 32;
+      }
+
+      // block size rounded up to the power of two within supported range
+      static uint32_t blockBits (const size_t blockSize) {
+         uint32_t bits = kMinBlockBits;
+
+         while (bits < kMaxBlockBits && (static_cast <size_t> (1) << bits) < blockSize) {
+            ++bits;
+         }
+         return bits;
+      }
+
+      // writes frame header, returns its length
+      static size_t putHeader (uint8_t *ptr, const uint8_t flags, const uint32_t bits, const uint64_t contentSize) {
+         put32 (ptr, kMagic);
+         ptr[4] = flags;
+         ptr[5] = static_cast <uint8_t> (bits);
+
+         if (flags & kContentSizeFlag) {
+            put64 (ptr + kMinHeaderSize, contentSize);
+            return kMaxHeaderSize;
+         }
+         return kMinHeaderSize;
+      }
+
+      // checks the fixed part of header, returns full header length, or zero, if it's not a valid frame
+      static size_t checkHeader (const uint8_t *ptr) {
+         const auto bits = static_cast <uint32_t> (ptr[5]);
+
+         if (get32 (ptr) != kMagic || (ptr[4] & ~kKnownFlags) || bits < kMinBlockBits || bits > kMaxBlockBits) {
+            return 0;
+         }
+         return (ptr[4] & kContentSizeFlag) ? kMaxHeaderSize : kMinHeaderSize;
+      }
+
+      static void putIndexEntry (uint8_t *ptr, const uint64_t offset, const uint32_t length) {
+         put64 (ptr, offset);
+         put32 (ptr + 8, length);
+      }
+   };
+
+   // adler-32 checksum of the stream content, sums are reduced only once in a run, that can't overflow them
+   class ULZChecksum final {
+   private:
+      static constexpr uint32_t kModulus = 65521;
+      static constexpr size_t kMaxRun = 5552;
+
+   private:
+      uint32_t a_ { 1 };
+      uint32_t b_ {};
+
+   public:
+      void update (const uint8_t *data, size_t length) {
+         uint32_t a = a_;
+         uint32_t b = b_;
+
+         while (length > 0) {
+            const size_t run = cr::min (length, kMaxRun);
+
+            for (size_t i = 0; i < run; ++i) {
+               a += data[i];
+               b += a;
+            }
+            a %= kModulus;
+            b %= kModulus;
+
+            data += run;
+            length -= run;
+         }
+         a_ = a;
+         b_ = b;
+      }
+
+      uint32_t value () const {
+         return (b_ << 16) | a_;
+      }
+
+      // checksum of two pieces of content joined together, from their checksums, and length of the second
+      static uint32_t combine (const uint32_t first, const uint32_t second, const uint64_t secondLength) {
+         const auto rem = static_cast <uint32_t> (secondLength % kModulus);
+
+         uint32_t a = first & 0xffff;
+         uint32_t b = static_cast <uint32_t> ((static_cast <uint64_t> (rem) * a) % kModulus);
+
+         a += (second & 0xffff) + kModulus - 1;
+         b += (first >> 16) + (second >> 16) + kModulus - rem;
+
+         a = a % kModulus;
+         b = b % kModulus;
+
+         return (b << 16) | a;
+      }
+   };
+}
+
+// settings of the framed ulz stream
+struct ULZStreamOptions {
+   static constexpr uint64_t kUnknownSize = ~static_cast <uint64_t> (0);
+
+   size_t blockSize { 1 << 20 }; // rounded up to power of two between 4 KB and 16 MB
+   bool checksum { true };
+   bool index { false }; // block index at the end of the frame, so blocks can be decoded concurrently
+   ULZLevel level { ULZLevel::Default };
+   uint64_t contentSize { kUnknownSize }; // stored in the header, when known upfront, and verified on both ends
+};
+
+// compresses data of any size into framed ulz stream, input is taken in chunks of any size, and written out
+// block by block, so memory use is bounded by the block size, not the input size
+class ULZEncoder final : public NonCopyable {
+public:
+   using Writer = Lambda <bool (const uint8_t *, size_t)>;
+
+private:
+   using Frame = detail::ULZFrame;
+
+private:
+   Writer writer_;
+   ULZContext context_ {};
+   Array <uint8_t> block_ {};
+   Array <uint8_t> packed_ {};
+   Array <uint8_t> index_ {};
+   detail::ULZChecksum checksum_ {};
+
+   size_t blockSize_ {};
+   size_t filled_ {};
+   uint64_t contentSize_ {};
+   uint64_t consumed_ {};
+   uint64_t produced_ {};
+
+   ULZLevel level_ {};
+
+   bool useChecksum_ {};
+   bool useIndex_ {};
+   bool started_ {};
+   bool finished_ {};
+   bool failed_ {};
+
+public:
+   explicit ULZEncoder (Writer writer, const ULZStreamOptions &options = {}) : writer_ (cr::move (writer)) {
+      blockSize_ = static_cast <size_t> (1) << Frame::blockBits (options.blockSize);
+      contentSize_ = options.contentSize;
+      useChecksum_ = options.checksum;
+      useIndex_ = options.index;
+      level_ = options.level;
+   }
+
+   explicit ULZEncoder (File &file, const ULZStreamOptions &options = {}) : ULZEncoder ([&file] (const uint8_t *data, size_t length) {
+      return file.write (data, 1, length) == length;
+   }, options) {}
+
+   ~ULZEncoder () {
+      if (started_) {
+         finish ();
+      }
+   }
+
+private:
+   bool emit (const uint8_t *data, const size_t length) {
+      if (failed_ || !writer_ (data, length)) {
+         failed_ = true;
+         return false;
+      }
+      produced_ += length;
+      return true;
+   }
+
+   bool start () {
+      uint8_t header[Frame::kMaxHeaderSize] {};
+      const auto flags = static_cast <uint8_t> ((useChecksum_ ? Frame::kChecksumFlag : 0) | (contentSize_ != ULZStreamOptions::kUnknownSize ? Frame::kContentSizeFlag : 0) | (useIndex_ ? Frame::kIndexFlag : 0));
+
+      started_ = true;
+      return emit (header, Frame::putHeader (header, flags, Frame::blockBits (blockSize_), contentSize_));
+   }
+
+   // compresses one block, blocks, that don't get smaller, are stored as is
+   bool emitBlock (const uint8_t *data, const size_t length) {
+      if (useChecksum_) {
+         checksum_.update (data, length);
+      }
+      consumed_ += length;
+
+      if (useIndex_) {
+         uint8_t entry[Frame::kIndexEntrySize] {};
+         Frame::putIndexEntry (entry, produced_, static_cast <uint32_t> (length));
+
+         index_.insert (index_.length (), entry, sizeof (entry));
+      }
+
+      if (packed_.empty ()) {
+         packed_.resize (static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (blockSize_))));
+      }
+      const auto packed = context_.compress (data, static_cast <int32_t> (length), packed_.data (), level_);
+      uint8_t header[4] {};
+
+      if (packed > 0 && static_cast <size_t> (packed) < length) {
+         Frame::put32 (header, static_cast <uint32_t> (packed));
+         return emit (header, sizeof (header)) && emit (packed_.data (), static_cast <size_t> (packed));
+      }
+      Frame::put32 (header, static_cast <uint32_t> (length) | Frame::kStoredBlock);
+      return emit (header, sizeof (header)) && emit (data, length);
+   }
+
+public:
+   // takes next chunk of input, returns false, if writing failed
+   bool write (const void *data, size_t length) {
+      if (failed_ || finished_ || (!started_ && !start ())) {
+         return false;
+      }
+      auto input = static_cast <const uint8_t *> (data);
+
+      while (length > 0) {
+         // whole blocks are compressed right from the input, without copying them to the block buffer
+         if (filled_ == 0 && length >= blockSize_) {
+            if (!emitBlock (input, blockSize_)) {
+               return false;
+            }
+            input += blockSize_;
+            length -= blockSize_;
+
+            continue;
+         }
+
+         if (block_.empty ()) {
+            block_.resize (blockSize_);
+         }
+         const size_t chunk = cr::min (length, blockSize_ - filled_);
+         memcpy (block_.data () + filled_, input, chunk);
+
+         filled_ += chunk;
+         input += chunk;
+         length -= chunk;
+
+         if (filled_ == blockSize_) {
+            filled_ = 0;
+
+            if (!emitBlock (block_.data (), blockSize_)) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   // compresses buffered input, and ends the frame, fails if declared content size doesn't match
+   bool finish () {
+      if (finished_) {
+         return !failed_;
+      }
+
+      if (!started_ && !start ()) {
+         return false;
+      }
+      finished_ = true;
+
+      if (filled_ > 0 && !emitBlock (block_.data (), filled_)) {
+         return false;
+      }
+      filled_ = 0;
+
+      uint8_t trailer[8] {};
+      size_t length = 4;
+
+      if (useChecksum_) {
+         Frame::put32 (trailer + length, checksum_.value ());
+         length += 4;
+      }
+
+      if (!emit (trailer, length)) {
+         return false;
+      }
+
+      if (useIndex_) {
+         uint8_t footer[Frame::kIndexFooterSize] {};
+
+         Frame::put32 (footer, static_cast <uint32_t> (index_.length () / Frame::kIndexEntrySize));
+         Frame::put32 (footer + 4, Frame::kIndexMagic);
+
+         if (!emit (index_.data (), index_.length ()) || !emit (footer, sizeof (footer))) {
+            return false;
+         }
+      }
+
+      if (contentSize_ != ULZStreamOptions::kUnknownSize && contentSize_ != consumed_) {
+         failed_ = true;
+      }
+      return !failed_;
+   }
+
+   bool failed () const {
+      return failed_;
+   }
+
+   // bytes of input taken so far
+   uint64_t consumed () const {
+      return consumed_;
+   }
+
+   // bytes of the frame written so far
+   uint64_t produced () const {
+      return produced_;
+   }
+};
+
+// decompresses framed ulz stream, pulling it in chunks from the reader, and handing out content in chunks
+// of any size, memory use is bounded by the block size of the stream
+class ULZDecoder final : public NonCopyable {
+public:
+   using Reader = Lambda <size_t (uint8_t *, size_t)>;
+
+private:
+   using Frame = detail::ULZFrame;
+
+private:
+   Reader reader_;
+   Array <uint8_t> block_ {};
+   Array <uint8_t> packed_ {};
+   detail::ULZChecksum checksum_ {};
+
+   size_t blockSize_ {};
+   size_t blockLength_ {};
+   size_t blockOffset_ {};
+   uint64_t contentSize_ { ULZStreamOptions::kUnknownSize };
+   uint64_t produced_ {};
+
+   bool useChecksum_ {};
+   bool started_ {};
+   bool finished_ {};
+   bool failed_ {};
+
+public:
+   explicit ULZDecoder (Reader reader) : reader_ (cr::move (reader)) {}
+
+   explicit ULZDecoder (File &file) : ULZDecoder ([&file] (uint8_t *data, size_t length) {
+      return file.read (data, 1, length);
+   }) {}
+
+   explicit ULZDecoder (MemFile &file) : ULZDecoder ([&file] (uint8_t *data, size_t length) {
+      return file.read (data, 1, length);
+   }) {}
+
+   ~ULZDecoder () = default;
+
+private:
+   bool fail () {
+      failed_ = true;
+      return false;
+   }
+
+   bool readExact (uint8_t *data, size_t length) {
+      while (length > 0) {
+         const auto got = reader_ (data, length);
+
+         if (got == 0 || got > length) {
+            return false;
+         }
+         data += got;
+         length -= got;
+      }
+      return true;
+   }
+
+   bool start () {
+      started_ = true;
+      uint8_t header[Frame::kMaxHeaderSize] {};
+
+      if (!readExact (header, Frame::kMinHeaderSize)) {
+         return fail ();
+      }
+      const auto length = Frame::checkHeader (header);
+
+      if (length == 0) {
+         return fail ();
+      }
+      useChecksum_ = !!(header[4] & Frame::kChecksumFlag);
+      blockSize_ = static_cast <size_t> (1) << header[5];
+
+      // block index isn't needed, when reading blocks in order, so it's left unread after the trailer
+      if (length > Frame::kMinHeaderSize) {
+         if (!readExact (header + Frame::kMinHeaderSize, length - Frame::kMinHeaderSize)) {
+            return fail ();
+         }
+         contentSize_ = Frame::get64 (header + Frame::kMinHeaderSize);
+      }
+      return true;
+   }
+
+   // end of the frame, checks the trailer against decoded content
+   bool end () {
+      finished_ = true;
+
+      if (useChecksum_) {
+         uint8_t trailer[4] {};
+
+         if (!readExact (trailer, sizeof (trailer)) || Frame::get32 (trailer) != checksum_.value ()) {
+            return fail ();
+         }
+      }
+
+      if (contentSize_ != ULZStreamOptions::kUnknownSize && contentSize_ != produced_) {
+         return fail ();
+      }
+      return true;
+   }
+
+   // decodes next block into target, that holds the whole block, returns its length, zero at the end
+   size_t decodeBlock (uint8_t *target) {
+      uint8_t header[4] {};
+
+      if (!readExact (header, sizeof (header))) {
+         fail ();
+         return 0;
+      }
+      const auto value = Frame::get32 (header);
+
+      if (value == 0) {
+         end ();
+         return 0;
+      }
+      const auto length = static_cast <size_t> (value & ~Frame::kStoredBlock);
+      size_t decoded = 0;
+
+      if (value & Frame::kStoredBlock) {
+         if (length > blockSize_ || !readExact (target, length)) {
+            fail ();
+            return 0;
+         }
+         decoded = length;
+      }
+      else {
+         const auto bound = static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (blockSize_)));
+
+         if (length > bound) {
+            fail ();
+            return 0;
+         }
+
+         if (packed_.empty ()) {
+            packed_.resize (bound);
+         }
+
+         if (!readExact (packed_.data (), length)) {
+            fail ();
+            return 0;
+         }
+         const auto result = ULZContext::uncompress (packed_.data (), static_cast <int32_t> (length), target, static_cast <int32_t> (blockSize_));
+
+         if (result <= 0) {
+            fail ();
+            return 0;
+         }
+         decoded = static_cast <size_t> (result);
+      }
+
+      if (useChecksum_) {
+         checksum_.update (target, decoded);
+      }
+      produced_ += decoded;
+
+      if (produced_ > contentSize_) {
+         fail ();
+         return 0;
+      }
+      return decoded;
+   }
+
+public:
+   // fills buffer with up to length bytes of content, returns number of bytes, zero at the end of the
+   // stream or on failure
+   size_t read (void *buffer, const size_t length) {
+      if (!started_ && !start ()) {
+         return 0;
+      }
+      auto output = static_cast <uint8_t *> (buffer);
+      size_t written = 0;
+
+      while (written < length && !failed_) {
+         if (blockOffset_ == blockLength_) {
+            if (finished_) {
+               break;
+            }
+
+            // block, that fits the caller's buffer, is decoded right there, without copying
+            if (length - written >= blockSize_) {
+               written += decodeBlock (output + written);
+               continue;
+            }
+
+            if (block_.empty ()) {
+               block_.resize (blockSize_);
+            }
+            blockLength_ = decodeBlock (block_.data ());
+            blockOffset_ = 0;
+
+            continue;
+         }
+         const size_t chunk = cr::min (length - written, blockLength_ - blockOffset_);
+         memcpy (output + written, block_.data () + blockOffset_, chunk);
+
+         blockOffset_ += chunk;
+         written += chunk;
+      }
+      return failed_ ? 0 : written;
+   }
+
+   // whole frame was read and verified
+   bool finished () const {
+      return finished_ && !failed_;
+   }
+
+   bool failed () const {
+      return failed_;
+   }
+
+   // content size declared in the header, unknown size is ULZStreamOptions::kUnknownSize
+   uint64_t contentSize () {
+      if (!started_) {
+         start ();
+      }
+      return contentSize_;
+   }
+
+   // bytes of content decoded so far
+   uint64_t produced () const {
+      return produced_;
+   }
+};
+
+// compresses and decompresses whole buffers on the thread pool, blocks of the frame are independent, so each
+// of them is a separate job, and every thread packs them with its own match tables, output of compress is
+// an indexed frame, which is readable with ulz decoder as well, and uncompress takes any frame
+class ULZParallel final {
+private:
+   using Frame = detail::ULZFrame;
+
+   // blocks decoded per thread at once
+   static constexpr size_t kBlocksPerThread = 4;
+
+   struct Block {
+      size_t frame; // offset of block length in the frame
+      size_t content; // offset of block content in the output
+      size_t length; // content length, capacity for the last block of frame without index
+      size_t packed;
+      uint32_t checksum;
+      bool exact;
+      bool failed;
+   };
+
+private:
+   // match tables are big, so they're kept per thread, not allocated per block
+   static ULZContext &local () {
+      static thread_local ULZContext instance {};
+      return instance;
+   }
+
+   static uint32_t checksumOf (const uint8_t *data, const size_t length) {
+      detail::ULZChecksum checksum;
+      checksum.update (data, length);
+
+      return checksum.value ();
+   }
+
+   // locates blocks from the index at the end of the frame, returns offset of the index, or zero
+   static size_t readIndex (const uint8_t *in, const size_t length, const size_t headerLength, const size_t blockSize, Array <Block> &blocks) {
+      if (length < headerLength + Frame::kIndexFooterSize || Frame::get32 (in + length - 4) != Frame::kIndexMagic) {
+         return 0;
+      }
+      const auto count = static_cast <size_t> (Frame::get32 (in + length - Frame::kIndexFooterSize));
+
+      if (count > (length - headerLength - Frame::kIndexFooterSize) / Frame::kIndexEntrySize) {
+         return 0;
+      }
+      const auto start = length - Frame::kIndexFooterSize - count * Frame::kIndexEntrySize;
+      size_t content = 0;
+
+      for (size_t i = 0; i < count; ++i) {
+         const auto entry = in + start + i * Frame::kIndexEntrySize;
+         const auto frame = Frame::get64 (entry);
+         const auto size = static_cast <size_t> (Frame::get32 (entry + 8));
+
+         if (frame < headerLength || frame + 4 > start || size == 0 || size > blockSize) {
+            return 0;
+         }
+         blocks.push (Block { static_cast <size_t> (frame), content, size, 0, 0, true, false });
+         content += size;
+      }
+      return start;
+   }
+
+   // locates blocks by walking their lengths, every block but the last one is full, returns offset of the
+   // end mark, or zero
+   static size_t walkBlocks (const uint8_t *in, const size_t length, const size_t headerLength, const size_t blockSize, Array <Block> &blocks) {
+      size_t offset = headerLength;
+
+      while (offset + 4 <= length) {
+         const auto value = Frame::get32 (in + offset);
+
+         if (value == 0) {
+            if (!blocks.empty ()) {
+               blocks.last ().exact = false;
+            }
+            return offset;
+         }
+         blocks.push (Block { offset, blocks.length () * blockSize, blockSize, 0, 0, true, false });
+         offset += 4 + static_cast <size_t> (value & ~Frame::kStoredBlock);
+      }
+      return 0;
+   }
+
+   // decodes block into its place in the output, end is where block payloads must stop
+   static void decodeBlock (const uint8_t *in, const size_t end, const size_t blockSize, uint8_t *out, Block &block) {
+      const auto value = Frame::get32 (in + block.frame);
+      const auto packed = static_cast <size_t> (value & ~Frame::kStoredBlock);
+
+      block.packed = packed;
+      block.failed = true;
+
+      if (value == 0 || block.frame + 4 + packed > end) {
+         return;
+      }
+      const auto payload = in + block.frame + 4;
+      auto target = out + block.content;
+
+      if (value & Frame::kStoredBlock) {
+         if (packed > block.length || (block.exact && packed != block.length)) {
+            return;
+         }
+         memcpy (target, payload, packed);
+         block.length = packed;
+      }
+      else {
+         if (packed > static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (blockSize)))) {
+            return;
+         }
+         const auto result = ULZContext::uncompress (payload, static_cast <int32_t> (packed), target, static_cast <int32_t> (block.length));
+
+         if (result <= 0 || (block.exact && static_cast <size_t> (result) != block.length)) {
+            return;
+         }
+         block.length = static_cast <size_t> (result);
+      }
+      block.checksum = checksumOf (target, block.length);
+      block.failed = false;
+   }
+
+public:
+   // compresses length bytes of data into out as an indexed frame, content size is taken from length
+   static bool compress (ThreadPool &pool, const void *data, const size_t length, Array <uint8_t> &out, const ULZStreamOptions &options = {}) {
+      const auto input = static_cast <const uint8_t *> (data);
+      const auto bits = Frame::blockBits (options.blockSize);
+      const auto blockSize = static_cast <size_t> (1) << bits;
+      const auto bound = static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (blockSize)));
+      const auto count = (length + blockSize - 1) / blockSize;
+
+      // every block is packed into its own slot, then slots are gathered into the frame in order
+      Array <uint8_t> packed;
+      Array <Block> blocks (count, Block {});
+
+      if (!packed.resize (count * bound)) {
+         return false;
+      }
+
+      parallelFor (pool, 0, count, 1, [&] (const size_t i) {
+         auto &block = blocks[i];
+
+         block.content = i * blockSize;
+         block.length = cr::min (blockSize, length - block.content);
+         block.packed = static_cast <size_t> (local ().compress (input + block.content, static_cast <int32_t> (block.length), packed.data () + i * bound, options.level));
+
+         if (options.checksum) {
+            block.checksum = checksumOf (input + block.content, block.length);
+         }
+      });
+      const auto flags = static_cast <uint8_t> ((options.checksum ? Frame::kChecksumFlag : 0) | Frame::kContentSizeFlag | Frame::kIndexFlag);
+      size_t total = Frame::kMaxHeaderSize + 4 + (options.checksum ? 4 : 0) + count * Frame::kIndexEntrySize + Frame::kIndexFooterSize;
+
+      for (const auto &block : blocks) {
+         total += 4 + cr::min (block.packed, block.length);
+      }
+      out.clear ();
+
+      if (!out.resize (total)) {
+         return false;
+      }
+      auto op = out.data ();
+      op += Frame::putHeader (op, flags, bits, length);
+
+      uint32_t checksum = 1;
+
+      for (size_t i = 0; i < count; ++i) {
+         auto &block = blocks[i];
+         block.frame = static_cast <size_t> (op - out.data ());
+
+         // blocks, that don't get smaller, are stored as is
+         if (block.packed > 0 && block.packed < block.length) {
+            Frame::put32 (op, static_cast <uint32_t> (block.packed));
+            memcpy (op + 4, packed.data () + i * bound, block.packed);
+
+            op += 4 + block.packed;
+         }
+         else {
+            Frame::put32 (op, static_cast <uint32_t> (block.length) | Frame::kStoredBlock);
+            memcpy (op + 4, input + block.content, block.length);
+
+            op += 4 + block.length;
+         }
+         checksum = detail::ULZChecksum::combine (checksum, block.checksum, block.length);
+      }
+      Frame::put32 (op, 0);
+      op += 4;
+
+      if (options.checksum) {
+         Frame::put32 (op, checksum);
+         op += 4;
+      }
+
+      for (const auto &block : blocks) {
+         Frame::putIndexEntry (op, block.frame, static_cast <uint32_t> (block.length));
+         op += Frame::kIndexEntrySize;
+      }
+      Frame::put32 (op, static_cast <uint32_t> (count));
+      Frame::put32 (op + 4, Frame::kIndexMagic);
+
+      return true;
+   }
+
+   // decompresses whole frame into out, blocks are found with the index when the frame has one, and by
+   // walking block lengths otherwise, fails on any damage, or checksum and content size mismatch
+   static bool uncompress (ThreadPool &pool, const void *data, const size_t length, Array <uint8_t> &out) {
+      const auto in = static_cast <const uint8_t *> (data);
+      out.clear ();
+
+      if (length < Frame::kMinHeaderSize) {
+         return false;
+      }
+      const auto headerLength = Frame::checkHeader (in);
+
+      if (headerLength == 0 || length < headerLength) {
+         return false;
+      }
+      const auto flags = in[4];
+      const auto blockSize = static_cast <size_t> (1) << in[5];
+      const auto contentSize = (flags & Frame::kContentSizeFlag) ? Frame::get64 (in + Frame::kMinHeaderSize) : ULZStreamOptions::kUnknownSize;
+
+      Array <Block> blocks;
+      size_t end = 0; // end mark of the frame
+
+      if (flags & Frame::kIndexFlag) {
+         const auto index = readIndex (in, length, headerLength, blockSize, blocks);
+
+         if (index == 0) {
+            return false;
+         }
+
+         // end mark follows the last block, payload lengths are checked when decoding
+         if (blocks.empty ()) {
+            end = headerLength;
+         }
+         else {
+            const auto &last = blocks.last ();
+            end = last.frame + 4 + static_cast <size_t> (Frame::get32 (in + last.frame) & ~Frame::kStoredBlock);
+         }
+
+         if (end + 4 > index) {
+            return false;
+         }
+      }
+      else {
+         end = walkBlocks (in, length, headerLength, blockSize, blocks);
+
+         if (end == 0) {
+            return false;
+         }
+      }
+
+      if (Frame::get32 (in + end) != 0 || ((flags & Frame::kChecksumFlag) && end + 8 > length)) {
+         return false;
+      }
+
+      // declared content size caps the output, blocks have to add up to it exactly
+      if (contentSize != ULZStreamOptions::kUnknownSize && !blocks.empty ()) {
+         auto &last = blocks.last ();
+
+         if (last.content >= contentSize || (last.exact && last.content + last.length != contentSize) || contentSize - last.content > last.length) {
+            return false;
+         }
+         last.length = static_cast <size_t> (contentSize - last.content);
+         last.exact = true;
+      }
+
+      // block lengths come from the frame, and a few bytes of it may claim megabytes of output, so output
+      // grows wave by wave, only after the previous wave decoded in full
+      const auto wave = cr::max <size_t> (pool.threadCount (), 1) * kBlocksPerThread;
+      uint32_t checksum = 1;
+
+      for (size_t first = 0; first < blocks.length (); first += wave) {
+         const auto last = cr::min (blocks.length (), first + wave);
+         const auto &tail = blocks[last - 1];
+
+         if (!out.resize (tail.content + tail.length)) {
+            return false;
+         }
+
+         parallelFor (pool, first, last, 1, [&] (const size_t i) {
+            decodeBlock (in, end, blockSize, out.data (), blocks[i]);
+         });
+
+         for (size_t i = first; i < last; ++i) {
+            if (blocks[i].failed) {
+               return false;
+            }
+            checksum = detail::ULZChecksum::combine (checksum, blocks[i].checksum, blocks[i].length);
+         }
+      }
+
+      // last block of the frame without index may be short
+      if (!blocks.empty ()) {
+         out.resize (blocks.last ().content + blocks.last ().length);
+      }
+
+      if ((flags & Frame::kChecksumFlag) && Frame::get32 (in + end + 4) != checksum) {
+         return false;
+      }
+      return contentSize == ULZStreamOptions::kUnknownSize || contentSize == out.length ();
+   }
+};
+
 CR_NAMESPACE_END
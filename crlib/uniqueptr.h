@@ -9,8 +9,26 @@
 
 CR_NAMESPACE_BEGIN
 
-// simple unique ptr
-template <typename T> class UniquePtr final : public NonCopyable {
+// deletes objects created with new, default deleter for unique ptr
+template <typename T> struct DefaultDelete {
+   constexpr DefaultDelete () = default;
+
+   template <typename U> constexpr DefaultDelete (const DefaultDelete <U> &) noexcept
+   { }
+
+   void operator () (T *ptr) const noexcept {
+      delete ptr;
+   }
+};
+
+template <typename T> struct DefaultDelete <T[]> {
+   void operator () (T *ptr) const noexcept {
+      delete[] ptr;
+   }
+};
+
+// simple unique ptr, object is disposed with deleter D (kept as empty base, when stateless)
+template <typename T, typename D = DefaultDelete <T>> class UniquePtr final : public NonCopyable, private D {
 private:
    T *ptr_ {};
 
@@ -20,10 +38,13 @@ public:
    constexpr explicit UniquePtr (T *ptr) : ptr_ (ptr)
    { }
 
-   constexpr UniquePtr (UniquePtr &&rhs) noexcept : ptr_ (rhs.release ())
+   constexpr UniquePtr (T *ptr, const D &deleter) : D (deleter), ptr_ (ptr)
    { }
 
-   template <typename U> constexpr UniquePtr (UniquePtr <U> &&rhs) noexcept : ptr_ (rhs.release ())
+   constexpr UniquePtr (UniquePtr &&rhs) noexcept : D (cr::move (rhs.deleter ())), ptr_ (rhs.release ())
+   { }
+
+   template <typename U, typename E> constexpr UniquePtr (UniquePtr <U, E> &&rhs) noexcept : D (cr::move (rhs.deleter ())), ptr_ (rhs.release ())
    { }
 
    ~UniquePtr () {
@@ -49,9 +70,19 @@ public:
       }
    }
 
+   constexpr D &deleter () {
+      return *this;
+   }
+
+   constexpr const D &deleter () const {
+      return *this;
+   }
+
 private:
    constexpr void destroy () {
-      delete ptr_;
+      if (ptr_) {
+         deleter () (ptr_);
+      }
       ptr_ = nullptr;
    }
 
@@ -59,12 +90,15 @@ public:
    constexpr UniquePtr &operator = (UniquePtr &&rhs) noexcept {
       if (this != &rhs) {
          reset (rhs.release ());
+         deleter () = cr::move (rhs.deleter ());
       }
       return *this;
    }
 
-   template <typename U> constexpr UniquePtr &operator = (UniquePtr <U> &&rhs) noexcept {
+   template <typename U, typename E> constexpr UniquePtr &operator = (UniquePtr <U, E> &&rhs) noexcept {
       reset (rhs.release ());
+      deleter () = cr::move (rhs.deleter ());
+
       return *this;
    }
 
@@ -87,7 +121,7 @@ public:
 };
 
 // array specialization
-template <typename T> class UniquePtr <T[]> final : public NonCopyable {
+template <typename T, typename D> class UniquePtr <T[], D> final : public NonCopyable, private D {
 private:
    T *ptr_ {};
 
@@ -125,7 +159,9 @@ public:
 
 private:
    constexpr void destroy () {
-      delete[] ptr_;
+      if (ptr_) {
+         static_cast <D &> (*this) (ptr_);
+      }
       ptr_ = nullptr;
    }
 
@@ -110,3 +110,118 @@ TEST_CASE ("Array benchmark", "[benchmark][array]") {
       };
    }
 }
+
+// many small arrays of vectors built and thrown away at once, like per-pathfind scratch data
+static constexpr size_t kNumScratchArrays = 256;
+static constexpr size_t kNumScratchElements = 64;
+
+template <typename ArrayType, typename ...Args> static size_t buildScratch (Args &...args) {
+   Array<ArrayType> arrays;
+   size_t total = 0;
+
+   for (size_t i = 0; i < kNumScratchArrays; ++i) {
+      arrays.emplace (args...);
+      auto &arr = arrays.last ();
+
+      for (size_t j = 0; j < kNumScratchElements; ++j) {
+         arr.emplace (static_cast <float> (i), static_cast <float> (j), 0.0f);
+      }
+      total += arr.length ();
+   }
+   return total;
+}
+
+TEST_CASE ("Array arena benchmark", "[benchmark][array]") {
+   BENCHMARK ("malloc-backed build and teardown") {
+      return buildScratch <Array <Vector>> ();
+   };
+
+   Arena arena;
+
+   BENCHMARK ("arena-backed build and teardown") {
+      const auto total = buildScratch <Array <Vector, ReservePolicy::Multiple, 0, ArenaAllocator>> (arena);
+      arena.reset ();
+
+      return total;
+   };
+}
+
+// short temporary lists, that mostly fit into the inline storage
+static constexpr size_t kNumShortLists = 1000;
+static constexpr size_t kShortListLength = 12;
+
+TEST_CASE ("InlineArray benchmark", "[benchmark][array]") {
+   BENCHMARK ("Array short lists") {
+      size_t total = 0;
+
+      for (size_t i = 0; i < kNumShortLists; ++i) {
+         Array<int> list;
+
+         for (size_t j = 0; j < kShortListLength; ++j) {
+            list.push (static_cast <int> (j));
+         }
+         total += list.length ();
+      }
+      return total;
+   };
+
+   BENCHMARK ("InlineArray short lists") {
+      size_t total = 0;
+
+      for (size_t i = 0; i < kNumShortLists; ++i) {
+         InlineArray<int, 16> list;
+
+         for (size_t j = 0; j < kShortListLength; ++j) {
+            list.push (static_cast <int> (j));
+         }
+         total += list.length ();
+      }
+      return total;
+   };
+}
+
+// bulk operations on a million of plain values
+static constexpr size_t kNumBulkElements = 1 << 20;
+
+TEST_CASE ("Array bulk benchmark", "[benchmark][array]") {
+   Array<int32_t> source (kNumBulkElements, 42);
+   std::vector<int32_t> sourceVec (kNumBulkElements, 42);
+
+   BENCHMARK ("cr::Array bulk insert") {
+      Array<int32_t> arr { 1, 2 };
+      arr.insert (1, source.data (), source.length ());
+
+      return arr.length ();
+   };
+
+   BENCHMARK ("std::vector bulk insert") {
+      std::vector<int32_t> vec { 1, 2 };
+      vec.insert (vec.begin () + 1, sourceVec.begin (), sourceVec.end ());
+
+      return vec.size ();
+   };
+
+   BENCHMARK ("cr::Array extend") {
+      Array<int32_t> arr;
+      arr.extend (source);
+
+      return arr.length ();
+   };
+
+   BENCHMARK ("std::vector extend") {
+      std::vector<int32_t> vec;
+      vec.insert (vec.end (), sourceVec.begin (), sourceVec.end ());
+
+      return vec.size ();
+   };
+
+   BENCHMARK ("cr::Array fill construct") {
+      Array<int32_t> arr (kNumBulkElements, 7);
+      return arr.length ();
+   };
+
+   BENCHMARK ("std::vector fill construct") {
+      std::vector<int32_t> vec (kNumBulkElements, 7);
+      return vec.size ();
+   };
+}
@@ -0,0 +1,171 @@
+// benchmark_concurrent.cpp — benchmark ConcurrentHashMap vs HashMap behind one Mutex
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+#include "benchmark_threads.h"
+
+using namespace cr;
+
+static constexpr int32_t kNumElements = 10000;
+static constexpr int32_t kOpsPerThread = 100000;
+
+// mixed workload of 90% lookups and 10% writes run from every thread
+template <typename Lookup, typename Write> static int32_t runThreads (size_t count, Lookup &&lookup, Write &&write) {
+   Array<Thread> threads;
+   int32_t hits[64] {};
+
+   for (size_t t = 0; t < count; ++t) {
+      threads.emplace ([&, t] () {
+         uint32_t seed = static_cast <uint32_t> (t) * 7919u + 1u;
+
+         for (int32_t i = 0; i < kOpsPerThread; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            const auto key = static_cast <int32_t> ((seed >> 8) % kNumElements);
+
+            if (i % 10 == 0) {
+               write (key);
+            }
+            else {
+               hits[t] += lookup (key);
+            }
+         }
+      });
+   }
+   for (auto &thread : threads) {
+      thread.join ();
+   }
+   int32_t total = 0;
+
+   for (auto &hit : hits) {
+      total += hit;
+   }
+   return total;
+}
+
+TEST_CASE ("ConcurrentHashMap benchmark", "[benchmark][concurrent]") {
+   ConcurrentHashMap<int32_t, int32_t> sharded;
+   HashMap<int32_t, int32_t> plain;
+   Mutex plainMutex;
+
+   for (int32_t i = 0; i < kNumElements; ++i) {
+      sharded.insert (i, i);
+      plain.insert (i, i);
+   }
+
+   for (const auto &count : threadCounts ()) {
+      BENCHMARK (std::string ("sharded, threads: ") + std::to_string (count)) {
+         return runThreads (count, [&] (int32_t key) {
+            return sharded.exists (key);
+         }, [&] (int32_t key) {
+            sharded.assign (key, key);
+         });
+      };
+
+      BENCHMARK (std::string ("single mutex, threads: ") + std::to_string (count)) {
+         return runThreads (count, [&] (int32_t key) {
+            MutexScopedLock lock (plainMutex);
+            return plain.exists (key);
+         }, [&] (int32_t key) {
+            MutexScopedLock lock (plainMutex);
+            plain[key] = key;
+         });
+      };
+   }
+}
+
+static constexpr int32_t kItemsPerProducer = 50000;
+
+// deque behind one mutex, the way queues were shared between threads before
+template <typename T> class LockedQueue final {
+private:
+   Mutex mutex_ {};
+   Deque <T> items_ {};
+
+public:
+   bool push (const T &value) {
+      MutexScopedLock lock (mutex_);
+      items_.emplaceLast (value);
+
+      return true;
+   }
+
+   bool pop (T &out) {
+      MutexScopedLock lock (mutex_);
+
+      if (items_.empty ()) {
+         return false;
+      }
+      out = items_.popFront ();
+      return true;
+   }
+};
+
+// producers push numbers through the queue, consumers take them out, returns sum of consumed numbers
+template <typename Queue> static int64_t runQueue (Queue &queue, size_t producers, size_t consumers) {
+   Array <Thread> threads;
+   Atomic <int64_t> received {};
+   Atomic <int64_t> sum {};
+
+   const int64_t total = static_cast <int64_t> (producers) * kItemsPerProducer;
+
+   for (size_t c = 0; c < consumers; ++c) {
+      threads.emplace ([&] () {
+         int32_t value = 0;
+         int64_t local = 0;
+
+         while (received.load (MemoryOrder::Relaxed) < total) {
+            if (queue.pop (value)) {
+               local += value;
+               received.fetchAdd (1, MemoryOrder::Relaxed);
+            }
+            else {
+               Thread::yield ();
+            }
+         }
+         sum.fetchAdd (local);
+      });
+   }
+
+   for (size_t p = 0; p < producers; ++p) {
+      threads.emplace ([&queue] () {
+         for (int32_t i = 0; i < kItemsPerProducer; ++i) {
+            while (!queue.push (i)) {
+               Thread::yield ();
+            }
+         }
+      });
+   }
+
+   for (auto &thread : threads) {
+      thread.join ();
+   }
+   return sum.load ();
+}
+
+TEST_CASE ("RingQueue benchmark", "[benchmark][concurrent]") {
+   BENCHMARK ("spsc ring, 1 -> 1") {
+      SpscQueue <int32_t> queue (1024);
+      return runQueue (queue, 1, 1);
+   };
+
+   BENCHMARK ("locked deque, 1 -> 1") {
+      LockedQueue <int32_t> queue;
+      return runQueue (queue, 1, 1);
+   };
+
+   for (const auto &count : threadCounts ()) {
+      BENCHMARK (std::string ("mpsc ring, ") + std::to_string (count) + " -> 1") {
+         MpscQueue <int32_t> queue (1024);
+         return runQueue (queue, count, 1);
+      };
+
+      BENCHMARK (std::string ("mpmc ring, ") + std::to_string (count) + " -> " + std::to_string (count)) {
+         MpmcQueue <int32_t> queue (1024);
+         return runQueue (queue, count, count);
+      };
+
+      BENCHMARK (std::string ("locked deque, ") + std::to_string (count) + " -> " + std::to_string (count)) {
+         LockedQueue <int32_t> queue;
+         return runQueue (queue, count, count);
+      };
+   }
+}
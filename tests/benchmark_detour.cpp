@@ -0,0 +1,78 @@
+// benchmark_detour.cpp — benchmark hooked call throughput, trampoline vs unpatching original on every call
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+#if !defined(CR_ARCH_NON_X86) && !(defined(CR_MACOS) && defined(CR_ARCH_X64))
+
+#if defined(CR_CXX_MSVC)
+#  define BENCH_NOINLINE __declspec(noinline)
+#else
+#  define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+using HookFn = int32_t (int32_t);
+
+static constexpr int32_t kNumCalls = 10000;
+
+// volatile accesses keep the body long enough for the patch
+BENCH_NOINLINE static int32_t hookedFunction (int32_t value) {
+   volatile int32_t result = value;
+   result = result * 3;
+   result = result + 7;
+
+   return result;
+}
+
+static Detour <HookFn> *activeDetour = nullptr;
+
+static int32_t hookFunction (int32_t value) {
+   return (*activeDetour) (value) + 1;
+}
+
+static int32_t callHooked (int32_t count) {
+   int32_t (*volatile fn) (int32_t) = hookedFunction;
+   int32_t total = 0;
+
+   for (int32_t i = 0; i < count; ++i) {
+      total += fn (i);
+   }
+   return total;
+}
+
+TEST_CASE ("Detour hooked call benchmark", "[benchmark][detour]") {
+   const auto plain = callHooked (kNumCalls);
+
+   BENCHMARK ("unhooked calls") {
+      return callHooked (kNumCalls);
+   };
+
+   {
+      Detour <HookFn> detour ("", "", hookedFunction);
+      detour.install (reinterpret_cast <void *> (hookFunction), true, false);
+      activeDetour = &detour;
+
+      REQUIRE (callHooked (kNumCalls) == plain + kNumCalls);
+
+      BENCHMARK ("hooked calls, original unpatched per call") {
+         return callHooked (kNumCalls);
+      };
+   }
+
+   {
+      Detour <HookFn> detour ("", "", hookedFunction);
+      detour.install (reinterpret_cast <void *> (hookFunction), true);
+      activeDetour = &detour;
+
+      REQUIRE (detour.hasTrampoline ());
+      REQUIRE (callHooked (kNumCalls) == plain + kNumCalls);
+
+      BENCHMARK ("hooked calls, original through trampoline") {
+         return callHooked (kNumCalls);
+      };
+   }
+   activeDetour = nullptr;
+}
+
+#endif
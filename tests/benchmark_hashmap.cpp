@@ -8,6 +8,181 @@
 using namespace cr;
 
 static constexpr size_t kNumElements = 1000;
+static constexpr size_t kNumLookupElements = 20000;
+
+// previous inline-entry layout, kept here as the baseline for control-byte probing
+namespace legacy {
+   template <typename K, typename V, typename H = Hash <K>, typename E = KeyEqual <K>> class HashMap {
+   private:
+      enum class Status : uint8_t {
+         Empty,
+         Occupied,
+         Deleted
+      };
+
+      struct Entry : NonCopyable {
+         K key {};
+         V val {};
+         uint32_t hash {};
+         Status status { Status::Empty };
+
+         Entry () = default;
+
+         Entry (Entry &&rhs) noexcept : key (cr::move (rhs.key)), val (cr::move (rhs.val)), hash (rhs.hash), status (rhs.status) {}
+
+         Entry &operator = (Entry &&rhs) noexcept {
+            key = cr::move (rhs.key);
+            val = cr::move (rhs.val);
+            hash = rhs.hash;
+            status = rhs.status;
+
+            return *this;
+         }
+      };
+
+      H hash_ {};
+      E equal_ {};
+      size_t length_ {};
+      Array <Entry> contents_ {};
+
+   private:
+      size_t findPosition (const K &key, uint32_t hashValue, bool &found) const noexcept {
+         const size_t mask = contents_.length () - 1;
+         size_t index = hashValue & mask;
+         size_t firstDeleted = static_cast <size_t> (-1);
+
+         for (size_t step = 0; step < contents_.length ();) {
+            const auto &entry = contents_[index];
+
+            if (entry.status == Status::Empty) {
+               found = false;
+               return firstDeleted != static_cast <size_t> (-1) ? firstDeleted : index;
+            }
+
+            if (entry.status == Status::Deleted) {
+               if (firstDeleted == static_cast <size_t> (-1)) {
+                  firstDeleted = index;
+               }
+            }
+            else if (entry.hash == hashValue && equal_ (entry.key, key)) {
+               found = true;
+               return index;
+            }
+            ++step;
+            index = (hashValue + step * (step + 1) / 2) & mask;
+         }
+         found = false;
+         return firstDeleted != static_cast <size_t> (-1) ? firstDeleted : 0;
+      }
+
+      void rehashTo (size_t newSize) {
+         auto oldContents = cr::move (contents_);
+         contents_.resize (newSize);
+
+         for (auto &entry : oldContents) {
+            if (entry.status != Status::Occupied) {
+               continue;
+            }
+            const size_t mask = newSize - 1;
+            size_t index = entry.hash & mask;
+
+            for (size_t step = 1; contents_[index].status == Status::Occupied; ++step) {
+               index = (entry.hash + step * (step + 1) / 2) & mask;
+            }
+            contents_[index] = cr::move (entry);
+         }
+      }
+
+   public:
+      HashMap () {
+         contents_.resize (8);
+      }
+
+      void reserve (size_t n) {
+         n = cr::bit_ceil (n);
+
+         if (n > contents_.length ()) {
+            rehashTo (n);
+         }
+      }
+
+      bool insert (const K &key, const V &val) {
+         if (length_ >= contents_.length () / 2) {
+            rehashTo (contents_.length () * 2);
+         }
+         const uint32_t hashValue = hash_ (key);
+         bool found {};
+         const size_t index = findPosition (key, hashValue, found);
+
+         if (found) {
+            return false;
+         }
+         auto &entry = contents_[index];
+
+         entry.key = key;
+         entry.val = val;
+         entry.hash = hashValue;
+         entry.status = Status::Occupied;
+         ++length_;
+
+         return true;
+      }
+
+      const V *find (const K &key) const {
+         bool found {};
+         const size_t index = findPosition (key, hash_ (key), found);
+
+         return found ? &contents_[index].val : nullptr;
+      }
+   };
+}
+
+// runs the lookup workloads, so both layouts are measured by the very same code
+template <typename IntMap, typename StringMap> static void benchmarkLookups (const std::string &name, const std::vector<int> &keys, const Array<String> &names) {
+   IntMap ints;
+   StringMap strings;
+
+   for (size_t i = 0; i < keys.size (); ++i) {
+      ints.insert (keys[i], keys[i]);
+      strings.insert (names[i], keys[i]);
+   }
+
+   BENCHMARK_ADVANCED (name + " int hit")(Catch::Benchmark::Chronometer meter) {
+      meter.measure ([&] {
+         int sum = 0;
+         for (const auto &key : keys) {
+            if (auto *val = ints.find (key)) {
+               sum += *val;
+            }
+         }
+         return sum;
+      });
+   };
+
+   BENCHMARK_ADVANCED (name + " int miss")(Catch::Benchmark::Chronometer meter) {
+      const int offset = static_cast <int> (keys.size ());
+
+      meter.measure ([&] {
+         int misses = 0;
+         for (const auto &key : keys) {
+            misses += ints.find (key + offset) == nullptr;
+         }
+         return misses;
+      });
+   };
+
+   BENCHMARK_ADVANCED (name + " string hit")(Catch::Benchmark::Chronometer meter) {
+      meter.measure ([&] {
+         int sum = 0;
+         for (const auto &key : names) {
+            if (auto *val = strings.find (key)) {
+               sum += *val;
+            }
+         }
+         return sum;
+      });
+   };
+}
 
 TEST_CASE ("HashMap benchmark", "[benchmark][hashmap]") {
    std::vector<int> keys (kNumElements);
@@ -102,3 +277,100 @@ TEST_CASE ("HashMap benchmark", "[benchmark][hashmap]") {
       };
    }
 }
+
+TEST_CASE ("HashMap layout benchmark", "[benchmark][hashmap]") {
+   std::vector<int> keys (kNumLookupElements);
+   std::iota (keys.begin (), keys.end (), 0);
+
+   Array<String> names;
+   for (const auto &key : keys) {
+      names.emplace (String ().assignf ("entity_%d.config", key));
+   }
+
+   SECTION ("control bytes") {
+      benchmarkLookups <HashMap<int, int>, HashMap<String, int>> ("cr::HashMap", keys, names);
+   }
+
+   SECTION ("inline entries") {
+      benchmarkLookups <legacy::HashMap<int, int>, legacy::HashMap<String, int>> ("legacy::HashMap", keys, names);
+   }
+}
+
+TEST_CASE ("HashMap churn benchmark", "[benchmark][hashmap]") {
+   static constexpr int kChurnLive = 1000;
+   static constexpr int kChurnCycles = 1 << 20;
+
+   SECTION ("cr::HashMap") {
+      HashMap<int, int> map;
+      int next = 0;
+
+      BENCHMARK ("insert/erase cycles") {
+         for (int i = 0; i < kChurnCycles; ++i, ++next) {
+            map.insert (next, next);
+
+            if (next >= kChurnLive) {
+               map.erase (next - kChurnLive);
+            }
+         }
+         return map.length ();
+      };
+
+      BENCHMARK ("miss after churn") {
+         int misses = 0;
+         for (int i = 0; i < kChurnLive; ++i) {
+            misses += map.find (-i - 1) == nullptr;
+         }
+         return misses;
+      };
+   }
+
+   SECTION ("std::unordered_map") {
+      std::unordered_map<int, int> map;
+      int next = 0;
+
+      BENCHMARK ("insert/erase cycles") {
+         for (int i = 0; i < kChurnCycles; ++i, ++next) {
+            map.insert ({ next, next });
+
+            if (next >= kChurnLive) {
+               map.erase (next - kChurnLive);
+            }
+         }
+         return map.size ();
+      };
+
+      BENCHMARK ("miss after churn") {
+         int misses = 0;
+         for (int i = 0; i < kChurnLive; ++i) {
+            misses += map.find (-i - 1) == map.end ();
+         }
+         return misses;
+      };
+   }
+}
+
+TEST_CASE ("HashMap heterogeneous lookup benchmark", "[benchmark][hashmap]") {
+   Array<String> names;
+   HashMap<String, int> map;
+
+   for (size_t i = 0; i < kNumElements; ++i) {
+      names.emplace (String ().assignf ("sv_command_number_%d", static_cast <int> (i)));
+      map[names.last ()] = static_cast <int> (i);
+   }
+
+   BENCHMARK ("lookup by const char *") {
+      int sum = 0;
+      for (const auto &name : names) {
+         sum += *map.find (name.chars ());
+      }
+      return sum;
+   };
+
+   BENCHMARK ("lookup by temporary String") {
+      int sum = 0;
+      for (const auto &name : names) {
+         sum += *map.find (String (name.chars ()));
+      }
+      return sum;
+   };
+}
@@ -0,0 +1,105 @@
+// benchmark_hashset.cpp — benchmark HashSet vs HashMap<K, bool> vs std::unordered_set
+#include <crlib/crlib.h>
+#include <unordered_set>
+#include <vector>
+#include <numeric>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+static constexpr size_t kNumElements = 10000;
+
+TEST_CASE ("HashSet benchmark", "[benchmark][hashset]") {
+   std::vector<int> keys (kNumElements);
+   std::iota (keys.begin (), keys.end (), 0);
+
+   SECTION ("cr::HashSet") {
+      BENCHMARK ("insert") {
+         HashSet<int> set;
+         for (const auto &key : keys) {
+            set.insert (key);
+         }
+         return set;
+      };
+
+      BENCHMARK_ADVANCED ("contains")(Catch::Benchmark::Chronometer meter) {
+         HashSet<int> set;
+         for (const auto &key : keys) {
+            set.insert (key);
+         }
+         meter.measure ([&] {
+            int hits = 0;
+            for (const auto &key : keys) {
+               hits += set.contains (key);
+            }
+            return hits;
+         });
+      };
+
+      BENCHMARK_ADVANCED ("intersect")(Catch::Benchmark::Chronometer meter) {
+         HashSet<int> odd;
+         for (const auto &key : keys) {
+            if (key & 1) {
+               odd.insert (key);
+            }
+         }
+         std::vector<HashSet<int>> sets (static_cast <size_t> (meter.runs ()));
+         for (auto &set : sets) {
+            for (const auto &key : keys) {
+               set.insert (key);
+            }
+         }
+         meter.measure ([&] (int i) {
+            return sets[i].intersect (odd);
+         });
+      };
+   }
+
+   SECTION ("cr::HashMap<int, bool>") {
+      BENCHMARK ("insert") {
+         HashMap<int, bool> map;
+         for (const auto &key : keys) {
+            map.insert (key, true);
+         }
+         return map;
+      };
+
+      BENCHMARK_ADVANCED ("contains")(Catch::Benchmark::Chronometer meter) {
+         HashMap<int, bool> map;
+         for (const auto &key : keys) {
+            map.insert (key, true);
+         }
+         meter.measure ([&] {
+            int hits = 0;
+            for (const auto &key : keys) {
+               hits += map.exists (key);
+            }
+            return hits;
+         });
+      };
+   }
+
+   SECTION ("std::unordered_set") {
+      BENCHMARK ("insert") {
+         std::unordered_set<int> set;
+         for (const auto &key : keys) {
+            set.insert (key);
+         }
+         return set;
+      };
+
+      BENCHMARK_ADVANCED ("contains")(Catch::Benchmark::Chronometer meter) {
+         std::unordered_set<int> set;
+         for (const auto &key : keys) {
+            set.insert (key);
+         }
+         meter.measure ([&] {
+            int hits = 0;
+            for (const auto &key : keys) {
+               hits += set.count (key) > 0;
+            }
+            return hits;
+         });
+      };
+   }
+}
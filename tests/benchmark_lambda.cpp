@@ -0,0 +1,251 @@
+// benchmark_lambda.cpp — benchmark call, move and job submission overhead of lambdas vs raw function pointers
+// and FunctionRef
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+static constexpr size_t kNumCallables = 256;
+static constexpr int32_t kNumCalls = 1 << 16;
+static constexpr int32_t kNumJobs = 20000;
+static constexpr int32_t kNumVisits = 4096;
+static constexpr int32_t kVisitLength = 16;
+
+static int32_t addOne (int32_t value) {
+   return value + 1;
+}
+
+static int32_t addTwo (int32_t value) {
+   return value + 2;
+}
+
+// callables are stored in arrays and picked by index, so the compiler can't see through the call
+template <typename L, typename F> static Array <L> makeCallables (F &&make) {
+   Array <L> callables;
+
+   for (size_t i = 0; i < kNumCallables; ++i) {
+      callables.emplace (make (i));
+   }
+   return callables;
+}
+
+template <typename L> static int32_t callAll (const Array <L> &callables) {
+   int32_t value = 0;
+
+   for (int32_t i = 0; i < kNumCalls; ++i) {
+      value = callables[static_cast <size_t> (i) % kNumCallables] (value);
+   }
+   return value;
+}
+
+TEST_CASE ("Lambda call overhead benchmark", "[benchmark][lambda]") {
+   using Pointer = int32_t (*) (int32_t);
+
+   const auto pointers = makeCallables <Pointer> ([] (size_t i) -> Pointer {
+      return i & 1 ? addTwo : addOne;
+   });
+
+   const auto wrapped = makeCallables <Lambda <int32_t (int32_t)>> ([] (size_t i) {
+      return Lambda <int32_t (int32_t)> (i & 1 ? addTwo : addOne);
+   });
+
+   const auto captured = makeCallables <Lambda <int32_t (int32_t)>> ([] (size_t i) {
+      const auto step = static_cast <int32_t> (i & 1) + 1;
+
+      return Lambda <int32_t (int32_t)> ([step] (int32_t value) {
+         return value + step;
+      });
+   });
+
+   // capture doesn't fit the default inline storage, so it's called through the heap
+   const auto allocated = makeCallables <Lambda <int32_t (int32_t)>> ([] (size_t i) {
+      const int64_t steps[4] { static_cast <int64_t> (i & 1) + 1, 0, 0, 0 };
+
+      return Lambda <int32_t (int32_t)> ([steps] (int32_t value) {
+         return value + static_cast <int32_t> (steps[0]);
+      });
+   });
+
+   const auto inlined = makeCallables <InlineLambda <int32_t (int32_t), 64>> ([] (size_t i) {
+      const int64_t steps[4] { static_cast <int64_t> (i & 1) + 1, 0, 0, 0 };
+
+      return InlineLambda <int32_t (int32_t), 64> ([steps] (int32_t value) {
+         return value + static_cast <int32_t> (steps[0]);
+      });
+   });
+
+   const auto expected = callAll (pointers);
+
+   REQUIRE (callAll (wrapped) == expected);
+   REQUIRE (callAll (captured) == expected);
+   REQUIRE (callAll (allocated) == expected);
+   REQUIRE (callAll (inlined) == expected);
+
+   BENCHMARK ("raw function pointer") {
+      return callAll (pointers);
+   };
+
+   BENCHMARK ("Lambda wrapping function pointer") {
+      return callAll (wrapped);
+   };
+
+   BENCHMARK ("Lambda with small capture") {
+      return callAll (captured);
+   };
+
+   BENCHMARK ("Lambda with heap capture") {
+      return callAll (allocated);
+   };
+
+   BENCHMARK ("InlineLambda with large capture") {
+      return callAll (inlined);
+   };
+}
+
+// synchronous visitors, callback is built by caller on every call, like an enumeration over entities
+static int32_t visitWithLambda (const Lambda <int32_t (int32_t)> &fn) {
+   int32_t value = 0;
+
+   for (int32_t i = 0; i < kVisitLength; ++i) {
+      value += fn (i);
+   }
+   return value;
+}
+
+static int32_t visitWithRef (FunctionRef <int32_t (int32_t)> fn) {
+   int32_t value = 0;
+
+   for (int32_t i = 0; i < kVisitLength; ++i) {
+      value += fn (i);
+   }
+   return value;
+}
+
+TEST_CASE ("FunctionRef callback parameter benchmark", "[benchmark][lambda]") {
+   int64_t a = 1, b = 2, c = 3, d = 4;
+
+   // four captured values don't fit lambda's inline storage, so every Lambda built here allocates
+   auto runLambda = [&] () {
+      int32_t total = 0;
+
+      for (int32_t i = 0; i < kNumVisits; ++i) {
+         total += visitWithLambda ([a, b, c, d, i] (int32_t value) {
+            return value + static_cast <int32_t> (a + b + c + d) + i;
+         });
+      }
+      return total;
+   };
+
+   auto runRef = [&] () {
+      int32_t total = 0;
+
+      for (int32_t i = 0; i < kNumVisits; ++i) {
+         total += visitWithRef ([a, b, c, d, i] (int32_t value) {
+            return value + static_cast <int32_t> (a + b + c + d) + i;
+         });
+      }
+      return total;
+   };
+
+   auto runSmallLambda = [&] () {
+      int32_t total = 0;
+
+      for (int32_t i = 0; i < kNumVisits; ++i) {
+         total += visitWithLambda ([&a, i] (int32_t value) {
+            return value + static_cast <int32_t> (a) + i;
+         });
+      }
+      return total;
+   };
+
+   auto runSmallRef = [&] () {
+      int32_t total = 0;
+
+      for (int32_t i = 0; i < kNumVisits; ++i) {
+         total += visitWithRef ([&a, i] (int32_t value) {
+            return value + static_cast <int32_t> (a) + i;
+         });
+      }
+      return total;
+   };
+   REQUIRE (runLambda () == runRef ());
+   REQUIRE (runSmallLambda () == runSmallRef ());
+
+   BENCHMARK ("Lambda parameter, small capture") {
+      return runSmallLambda ();
+   };
+
+   BENCHMARK ("FunctionRef parameter, small capture") {
+      return runSmallRef ();
+   };
+
+   BENCHMARK ("Lambda parameter, heap capture") {
+      return runLambda ();
+   };
+
+   BENCHMARK ("FunctionRef parameter, large capture") {
+      return runRef ();
+   };
+}
+
+TEST_CASE ("Lambda move benchmark", "[benchmark][lambda]") {
+   String text ("a string long enough to live on the heap");
+
+   Array <Lambda <int32_t ()>> trivial;
+   Array <UniqueLambda <int32_t ()>> managed;
+
+   for (size_t i = 0; i < kNumCallables; ++i) {
+      const auto step = static_cast <int32_t> (i);
+
+      trivial.emplace ([step] () { return step; });
+      managed.emplace ([step, text] () { return step + static_cast <int32_t> (text.length ()); });
+   }
+
+   // moved back and forth, so each round starts with the same array
+   BENCHMARK ("move trivially copyable lambdas") {
+      Array <Lambda <int32_t ()>> moved;
+      moved.reserve (kNumCallables);
+
+      for (auto &fn : trivial) {
+         moved.emplace (cr::move (fn));
+      }
+
+      for (size_t i = 0; i < kNumCallables; ++i) {
+         trivial[i] = cr::move (moved[i]);
+      }
+      return trivial[1] ();
+   };
+
+   BENCHMARK ("move lambdas with managed captures") {
+      Array <UniqueLambda <int32_t ()>> moved;
+      moved.reserve (kNumCallables);
+
+      for (auto &fn : managed) {
+         moved.emplace (cr::move (fn));
+      }
+
+      for (size_t i = 0; i < kNumCallables; ++i) {
+         managed[i] = cr::move (moved[i]);
+      }
+      return managed[1] ();
+   };
+}
+
+TEST_CASE ("ThreadPool job submission benchmark", "[benchmark][lambda]") {
+   ThreadPool pool;
+   int64_t sink = 0;
+
+   // pool without workers, so only enqueueing and running on calling thread is measured
+   BENCHMARK ("enqueue and run jobs with four pointer captures") {
+      int64_t a = 1, b = 2, c = 3;
+
+      for (int32_t i = 0; i < kNumJobs; ++i) {
+         pool.enqueue ([&sink, a, b, c] () {
+            sink += a + b + c;
+         });
+      }
+
+      while (pool.runPending ()) {}
+      return sink;
+   };
+}
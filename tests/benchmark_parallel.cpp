@@ -0,0 +1,89 @@
+// benchmark_parallel.cpp — benchmark parallelFor / parallelReduce vs serial loops over entities
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+#include "benchmark_threads.h"
+
+using namespace cr;
+
+static constexpr size_t kNumEntities = 512;
+static constexpr size_t kNumPoints = 1 << 16;
+static constexpr float kViewDistance = 300.0f;
+static constexpr float kMaxDistance = 1.0e30f;
+
+static Array <Vector> makePoints (size_t count) {
+   Array <Vector> points;
+   uint32_t seed = 1;
+
+   auto next = [&seed] () {
+      seed = seed * 1664525u + 1013904223u;
+      return static_cast <float> ((seed >> 8) % 4096) - 2048.0f;
+   };
+
+   for (size_t i = 0; i < count; ++i) {
+      points.emplace (next (), next (), next () * 0.1f);
+   }
+   return points;
+}
+
+// number of entities in view distance of the given one, stands for a per-bot visibility pass
+static int32_t visibleFrom (const Array <Vector> &entities, size_t self) {
+   int32_t visible = 0;
+
+   for (size_t i = 0; i < entities.length (); ++i) {
+      if (i != self && entities[self].distanceSq (entities[i]) < cr::sqrf (kViewDistance)) {
+         ++visible;
+      }
+   }
+   return visible;
+}
+
+TEST_CASE ("parallelFor visibility benchmark", "[benchmark][parallel]") {
+   const auto entities = makePoints (kNumEntities);
+   Array <int32_t> visible (kNumEntities, 0);
+
+   BENCHMARK ("serial loop") {
+      for (size_t i = 0; i < kNumEntities; ++i) {
+         visible[i] = visibleFrom (entities, i);
+      }
+      return visible[0];
+   };
+
+   for (const auto &count : threadCounts ()) {
+      ThreadPool pool (count);
+
+      BENCHMARK (std::string ("parallelFor, threads: ") + std::to_string (count)) {
+         parallelFor (pool, 0, kNumEntities, 0, [&] (size_t i) {
+            visible[i] = visibleFrom (entities, i);
+         });
+         return visible[0];
+      };
+   }
+}
+
+TEST_CASE ("parallelReduce nearest distance benchmark", "[benchmark][parallel]") {
+   const auto points = makePoints (kNumPoints);
+   const Vector origin { 10.0f, 20.0f, 0.0f };
+
+   auto nearer = [] (float a, float b) {
+      return cr::min (a, b);
+   };
+
+   BENCHMARK ("serial loop") {
+      float nearest = kMaxDistance;
+
+      for (const auto &point : points) {
+         nearest = nearer (nearest, point.distanceSq (origin));
+      }
+      return nearest;
+   };
+
+   for (const auto &count : threadCounts ()) {
+      ThreadPool pool (count);
+
+      BENCHMARK (std::string ("parallelReduce, threads: ") + std::to_string (count)) {
+         return parallelReduce (pool, points, 0, kMaxDistance, [&origin] (const Vector &point) {
+            return point.distanceSq (origin);
+         }, nearer);
+      };
+   }
+}
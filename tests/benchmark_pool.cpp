@@ -0,0 +1,64 @@
+// benchmark_pool.cpp — benchmark ObjectPool vs heap allocation of small objects
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+static constexpr size_t kNumObjects = 10000;
+static constexpr size_t kNumLive = 64;
+
+struct PoolPayload {
+   Vector origin;
+   float time;
+   int32_t index;
+
+   PoolPayload (int32_t i) : origin (static_cast <float> (i), 0.0f, 0.0f), time (0.0f), index (i) {}
+};
+
+// allocates objects keeping a small window of them alive, the way short-lived jobs churn
+template <typename Make> static int32_t churn (Make &&make) {
+   Array<decltype (make (0))> live;
+   live.resize (kNumLive);
+
+   int32_t sum = 0;
+
+   for (size_t i = 0; i < kNumObjects; ++i) {
+      auto &slot = live[i % kNumLive];
+      slot = make (static_cast <int32_t> (i));
+
+      sum += slot->index;
+   }
+   return sum;
+}
+
+TEST_CASE ("ObjectPool benchmark", "[benchmark][pool]") {
+   BENCHMARK ("makeUnique") {
+      return churn ([] (int32_t i) {
+         return makeUnique <PoolPayload> (i);
+      });
+   };
+
+   ObjectPool<PoolPayload> local;
+
+   BENCHMARK ("local pool") {
+      return churn ([&] (int32_t i) {
+         return local.make (i);
+      });
+   };
+
+   ObjectPool<PoolPayload, PoolPolicy::Shared> shared;
+
+   BENCHMARK ("shared pool") {
+      return churn ([&] (int32_t i) {
+         return shared.make (i);
+      });
+   };
+
+   ObjectPool<PoolPayload, PoolPolicy::Cached> cached;
+
+   BENCHMARK ("cached pool") {
+      return churn ([&] (int32_t i) {
+         return cached.make (i);
+      });
+   };
+}
@@ -119,3 +119,107 @@ TEST_CASE ("String benchmark", "[benchmark][string]") {
       };
    }
 }
+
+// names, keys and tokens, short enough to fit inline
+static constexpr const char *kShortStrings[] = { "bot", "de_dust2", "weapon_ak47", "item_kevlar", "T", "CT", "spawn_point", "hostage_entity" };
+static constexpr const char *kShortList = "bot,de_dust2,weapon_ak47,item_kevlar,T,CT,spawn_point,hostage_entity";
+
+TEST_CASE ("Short string benchmark", "[benchmark][string]") {
+   constexpr size_t kNumShort = sizeof (kShortStrings) / sizeof (kShortStrings[0]);
+
+   SECTION ("cr::String") {
+      BENCHMARK ("construct short") {
+         Array<String> strings;
+         for (size_t i = 0; i < kNumElements; ++i) {
+            strings.push (String (kShortStrings[i % kNumShort]));
+         }
+         return strings;
+      };
+
+      BENCHMARK_ADVANCED ("copy short")(Catch::Benchmark::Chronometer meter) {
+         Array<String> source;
+         for (size_t i = 0; i < kNumElements; ++i) {
+            source.push (String (kShortStrings[i % kNumShort]));
+         }
+         meter.measure ([&] {
+            Array<String> copies;
+            for (const auto &str : source) {
+               copies.push (str);
+            }
+            return copies;
+         });
+      };
+
+      BENCHMARK ("substr short") {
+         String name ("weapon_ak47");
+         size_t total = 0;
+
+         for (size_t i = 0; i < kNumElements; ++i) {
+            total += name.substr (i % 7).length ();
+         }
+         return total;
+      };
+
+      BENCHMARK ("split short") {
+         String list (kShortList);
+         size_t total = 0;
+
+         for (size_t i = 0; i < kNumElements / 10; ++i) {
+            total += list.split (",").length ();
+         }
+         return total;
+      };
+   }
+
+   SECTION ("std::string") {
+      BENCHMARK ("construct short") {
+         std::vector<std::string> strings;
+         for (size_t i = 0; i < kNumElements; ++i) {
+            strings.push_back (std::string (kShortStrings[i % kNumShort]));
+         }
+         return strings;
+      };
+
+      BENCHMARK_ADVANCED ("copy short")(Catch::Benchmark::Chronometer meter) {
+         std::vector<std::string> source;
+         for (size_t i = 0; i < kNumElements; ++i) {
+            source.push_back (std::string (kShortStrings[i % kNumShort]));
+         }
+         meter.measure ([&] {
+            std::vector<std::string> copies;
+            for (const auto &str : source) {
+               copies.push_back (str);
+            }
+            return copies;
+         });
+      };
+
+      BENCHMARK ("substr short") {
+         std::string name ("weapon_ak47");
+         size_t total = 0;
+
+         for (size_t i = 0; i < kNumElements; ++i) {
+            total += name.substr (i % 7).length ();
+         }
+         return total;
+      };
+
+      BENCHMARK ("split short") {
+         std::string list (kShortList);
+         size_t total = 0;
+
+         for (size_t i = 0; i < kNumElements / 10; ++i) {
+            std::vector<std::string> parts;
+            size_t start = 0, end = 0;
+
+            while ((end = list.find (',', start)) != std::string::npos) {
+               parts.push_back (list.substr (start, end - start));
+               start = end + 1;
+            }
+            parts.push_back (list.substr (start));
+            total += parts.size ();
+         }
+         return total;
+      };
+   }
+}
@@ -0,0 +1,276 @@
+// benchmark_thread.cpp — benchmark work-stealing ThreadPool vs single locked queue with micro-jobs
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+#include "benchmark_threads.h"
+
+using namespace cr;
+
+static constexpr int32_t kNumJobs = 20000;
+static constexpr int32_t kFanOut = 100;
+
+// the previous thread pool design, every worker takes jobs from one deque behind one lock
+class LockedQueuePool final : public NonCopyable {
+private:
+   bool running_ { true };
+   Signal signal_ {};
+   Deque <Thread::Func> jobs_ {};
+   Array <Thread> threads_ {};
+
+public:
+   explicit LockedQueuePool (size_t workers) {
+      for (size_t i = 0; i < workers; ++i) {
+         threads_.emplace ([this] () {
+            for (;;) {
+               Thread::Func job {};
+               {
+                  SignalScopedLock lock (signal_);
+
+                  while (running_ && jobs_.empty ()) {
+                     signal_.wait ();
+                  }
+
+                  if (!running_ && jobs_.empty ()) {
+                     return;
+                  }
+                  job = cr::move (jobs_.popFront ());
+               }
+               job ();
+            }
+         });
+      }
+   }
+
+   ~LockedQueuePool () {
+      {
+         SignalScopedLock lock (signal_);
+         running_ = false;
+         signal_.broadcast ();
+      }
+
+      for (auto &thread : threads_) {
+         thread.join ();
+      }
+   }
+
+   void enqueue (Thread::Func &&job) {
+      SignalScopedLock lock (signal_);
+
+      jobs_.emplaceLast (cr::move (job));
+      signal_.notify ();
+   }
+};
+
+// a few dozen of instructions, about the size of a path query step
+static void microJob (Atomic <int32_t> &done, int32_t seed) {
+   uint32_t value = static_cast <uint32_t> (seed);
+
+   for (int32_t i = 0; i < 32; ++i) {
+      value = value * 1664525u + 1013904223u;
+   }
+   done.fetchAdd (static_cast <int32_t> (value & 1) | 1, MemoryOrder::Relaxed);
+}
+
+static void waitFor (Atomic <int32_t> &done, int32_t expected) {
+   while (done.load (MemoryOrder::Relaxed) < expected) {
+      cpuRelax ();
+   }
+}
+
+// all the jobs are enqueued from outside of the pool
+template <typename Pool> static int32_t runExternal (Pool &pool) {
+   Atomic <int32_t> done {};
+
+   for (int32_t i = 0; i < kNumJobs; ++i) {
+      pool.enqueue ([&done, i] () {
+         microJob (done, i);
+      });
+   }
+   waitFor (done, kNumJobs);
+   return done.load ();
+}
+
+// jobs spawn more jobs, like per-bot think tasks issuing path queries
+template <typename Pool> static int32_t runFanOut (Pool &pool) {
+   Atomic <int32_t> done {};
+
+   for (int32_t i = 0; i < kNumJobs / kFanOut; ++i) {
+      pool.enqueue ([&pool, &done, i] () {
+         for (int32_t j = 0; j < kFanOut; ++j) {
+            pool.enqueue ([&done, i, j] () {
+               microJob (done, i * kFanOut + j);
+            });
+         }
+      });
+   }
+   waitFor (done, kNumJobs);
+   return done.load ();
+}
+
+// per-frame fan-out joined with task group, waiting thread helps running the jobs
+static int32_t runGroupFrame (ThreadPool &pool) {
+   Atomic <int32_t> done {};
+   TaskGroup group (pool);
+
+   for (int32_t i = 0; i < kNumJobs / 10; ++i) {
+      group.run ([&done, i] () {
+         microJob (done, i);
+      });
+   }
+   group.wait ();
+   return done.load ();
+}
+
+// same, joined with the hand-made counter and signal, callers had to use before
+static int32_t runSignalFrame (ThreadPool &pool) {
+   Atomic <int32_t> done {};
+   Atomic <int32_t> pending { kNumJobs / 10 };
+   Signal finished {};
+
+   for (int32_t i = 0; i < kNumJobs / 10; ++i) {
+      pool.enqueue ([&, i] () {
+         microJob (done, i);
+
+         SignalScopedLock lock (finished);
+
+         if (pending.fetchSub (1) == 1) {
+            finished.broadcast ();
+         }
+      });
+   }
+   SignalScopedLock lock (finished);
+
+   while (pending.load () > 0) {
+      finished.wait ();
+   }
+   return done.load ();
+}
+
+TEST_CASE ("ThreadPool micro-job benchmark", "[benchmark][thread]") {
+   for (const auto &count : threadCounts ()) {
+      ThreadPool stealing (count);
+      LockedQueuePool locked (count);
+
+      BENCHMARK (std::string ("work-stealing, external, threads: ") + std::to_string (count)) {
+         return runExternal (stealing);
+      };
+
+      BENCHMARK (std::string ("locked queue, external, threads: ") + std::to_string (count)) {
+         return runExternal (locked);
+      };
+
+      BENCHMARK (std::string ("work-stealing, fan-out, threads: ") + std::to_string (count)) {
+         return runFanOut (stealing);
+      };
+
+      BENCHMARK (std::string ("locked queue, fan-out, threads: ") + std::to_string (count)) {
+         return runFanOut (locked);
+      };
+   }
+}
+
+TEST_CASE ("TaskGroup join benchmark", "[benchmark][thread]") {
+   for (const auto &count : threadCounts ()) {
+      ThreadPool pool (count);
+
+      BENCHMARK (std::string ("task group, threads: ") + std::to_string (count)) {
+         return runGroupFrame (pool);
+      };
+
+      BENCHMARK (std::string ("counter and signal, threads: ") + std::to_string (count)) {
+         return runSignalFrame (pool);
+      };
+   }
+}
+
+static constexpr int32_t kLockIterations = 100000;
+
+// cost of taking and releasing a lock nobody else wants
+template <typename Lock> static int32_t lockUncontended (Lock &lock) {
+   int32_t counter = 0;
+
+   for (int32_t i = 0; i < kLockIterations; ++i) {
+      ScopedLock <Lock> guard (lock);
+      ++counter;
+   }
+   return counter;
+}
+
+// every thread increments shared counter under the lock, the critical section is tiny
+template <typename Lock> static int32_t lockContended (Lock &lock, size_t count) {
+   int32_t counter = 0;
+   Array <Thread> threads;
+
+   for (size_t t = 0; t < count; ++t) {
+      threads.emplace ([&] () {
+         for (int32_t i = 0; i < kLockIterations / static_cast <int32_t> (count); ++i) {
+            ScopedLock <Lock> guard (lock);
+            ++counter;
+         }
+      });
+   }
+
+   for (auto &thread : threads) {
+      thread.join ();
+   }
+   return counter;
+}
+
+TEST_CASE ("Lock uncontended benchmark", "[benchmark][thread]") {
+   Mutex mutex;
+   SpinLock spin;
+   AdaptiveMutex adaptive;
+   SharedMutex shared;
+
+   BENCHMARK ("mutex") {
+      return lockUncontended (mutex);
+   };
+
+   BENCHMARK ("spin lock") {
+      return lockUncontended (spin);
+   };
+
+   BENCHMARK ("adaptive mutex") {
+      return lockUncontended (adaptive);
+   };
+
+   BENCHMARK ("shared mutex, exclusive") {
+      return lockUncontended (shared);
+   };
+
+   BENCHMARK ("shared mutex, shared") {
+      int32_t counter = 0;
+
+      for (int32_t i = 0; i < kLockIterations; ++i) {
+         ScopedSharedLock <SharedMutex> guard (shared);
+         ++counter;
+      }
+      return counter;
+   };
+}
+
+TEST_CASE ("Lock contended benchmark", "[benchmark][thread]") {
+   Mutex mutex;
+   SpinLock spin;
+   AdaptiveMutex adaptive;
+   SharedMutex shared;
+
+   for (const auto &count : threadCounts ()) {
+      const auto threads = cr::max <size_t> (count, 2);
+
+      BENCHMARK (std::string ("mutex, threads: ") + std::to_string (threads)) {
+         return lockContended (mutex, threads);
+      };
+
+      BENCHMARK (std::string ("spin lock, threads: ") + std::to_string (threads)) {
+         return lockContended (spin, threads);
+      };
+
+      BENCHMARK (std::string ("adaptive mutex, threads: ") + std::to_string (threads)) {
+         return lockContended (adaptive, threads);
+      };
+
+      BENCHMARK (std::string ("shared mutex, threads: ") + std::to_string (threads)) {
+         return lockContended (shared, threads);
+      };
+   }
+}
@@ -0,0 +1,17 @@
+// benchmark_threads.h — thread counts shared by the multi-threaded benchmarks
+#pragma once
+
+#include <crlib/crlib.h>
+
+// powers of two up to the number of hardware threads (capped at 64), and that number itself
+static inline cr::Array <size_t> threadCounts () {
+   cr::Array <size_t> counts;
+   const auto hardware = cr::clamp <size_t> (static_cast <size_t> (cr::plat.hardwareConcurrency ()), 1, 64);
+
+   for (size_t count = 1; count < hardware; count *= 2) {
+      counts.push (count);
+   }
+   counts.push (hardware);
+
+   return counts;
+}
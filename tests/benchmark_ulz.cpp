@@ -0,0 +1,260 @@
+// benchmark_ulz.cpp — benchmark ulz block-parallel compression and decompression scaling with threads,
+// per-packet compression with reused contexts, ratio and speed of compression levels, and throughput of
+// match extension and copies
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+#include "benchmark_threads.h"
+
+using namespace cr;
+
+static constexpr size_t kContentSize = 2 << 20;
+static constexpr size_t kBlockSize = 128 << 10; // sixteen blocks, enough to keep a few threads busy
+static constexpr size_t kPacketSize = 200;
+static constexpr size_t kNumPackets = 1024;
+static constexpr size_t kCorpusSize = 64 << 10;
+static constexpr size_t kThroughputSize = 1 << 20;
+
+// text with some noise, compresses a few times, like level and navigation data
+static Array <uint8_t> makeContent (size_t length) {
+   Array <uint8_t> data (length, 0);
+   uint32_t seed = 12345;
+
+   for (size_t i = 0; i < length; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      const auto noise = static_cast <uint8_t> (seed >> 24);
+
+      data[i] = noise > 8 ? static_cast <uint8_t> ("navmesh graph data "[i % 19]) : noise;
+   }
+   return data;
+}
+
+// bot chatter and config like text, made of a small vocabulary
+static Array <uint8_t> makeText (size_t length) {
+   static const char *words[] = {
+      "the ", "bot ", "waypoint ", "graph ", "navmesh ", "node ", "edge ", "path ", "cost ", "visible ", "team ",
+      "spawn ", "of ", "and ", "to ", "in ", "a ", "is ", "for ", "with ", "route ", "danger "
+   };
+   Array <uint8_t> data;
+   uint32_t seed = 7;
+
+   while (data.length () < length) {
+      seed = seed * 1664525u + 1013904223u;
+      const auto word = words[(seed >> 16) % (sizeof (words) / sizeof (words[0]))];
+
+      data.insert (data.length (), reinterpret_cast <const uint8_t *> (word), strlen (word));
+
+      if (((seed >> 8) & 15) == 0) {
+         data.push (static_cast <uint8_t> ('\n'));
+      }
+   }
+   data.resize (length);
+   return data;
+}
+
+// records of waypoint graph file, positions on a grid, flags, and links to neighbours
+static Array <uint8_t> makeGraph (size_t length) {
+   struct Node {
+      float origin[3];
+      int32_t flags;
+      int32_t links[8];
+      float radius;
+   };
+   Array <uint8_t> data;
+   uint32_t seed = 3;
+
+   for (int32_t i = 0; data.length () < length; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      Node node {};
+
+      node.origin[0] = static_cast <float> ((i % 64) * 64);
+      node.origin[1] = static_cast <float> ((i / 64) * 64);
+      node.origin[2] = static_cast <float> ((seed >> 20) % 16);
+      node.flags = static_cast <int32_t> ((seed >> 12) & 3);
+      node.radius = 32.0f;
+
+      for (int32_t k = 0; k < 8; ++k) {
+         node.links[k] = k < static_cast <int32_t> ((seed >> 4) & 7) ? i + k - 3 : -1;
+      }
+      data.insert (data.length (), reinterpret_cast <const uint8_t *> (&node), sizeof (node));
+   }
+   data.resize (length);
+   return data;
+}
+
+// copies of previous page with a changed byte now and then, so most of it is long matches
+static Array <uint8_t> makeRepeats (size_t length) {
+   constexpr size_t kPage = 4096;
+
+   Array <uint8_t> data (length, 0);
+   uint32_t seed = 9;
+
+   for (size_t i = 0; i < length; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+
+      if (i < kPage || (seed >> 25) == 0) {
+         data[i] = static_cast <uint8_t> (seed >> 24);
+      }
+      else {
+         data[i] = data[i - kPage + ((i / kPage) & 1)];
+      }
+   }
+   return data;
+}
+
+TEST_CASE ("ULZ block-parallel throughput benchmark", "[benchmark][ulz]") {
+   const auto content = makeContent (kContentSize);
+
+   ULZStreamOptions options;
+   options.blockSize = kBlockSize;
+
+   ThreadPool serial;
+   Array <uint8_t> packed;
+   Array <uint8_t> restored;
+
+   REQUIRE (ULZParallel::compress (serial, content.data (), content.length (), packed, options));
+   REQUIRE (ULZParallel::uncompress (serial, packed.data (), packed.length (), restored));
+   REQUIRE (restored.length () == content.length ());
+
+   // single-threaded baseline, same frame through the streaming encoder
+   BENCHMARK ("ULZEncoder, one thread") {
+      size_t produced = 0;
+
+      ULZEncoder encoder ([&produced] (const uint8_t *, size_t length) {
+         produced += length;
+         return true;
+      }, options);
+
+      encoder.write (content.data (), content.length ());
+      encoder.finish ();
+
+      return produced;
+   };
+
+   BENCHMARK ("ULZDecoder, one thread") {
+      size_t position = 0;
+
+      ULZDecoder decoder ([&packed, &position] (uint8_t *data, size_t length) {
+         const auto chunk = cr::min (length, packed.length () - position);
+         memcpy (data, packed.data () + position, chunk);
+
+         position += chunk;
+         return chunk;
+      });
+
+      return decoder.read (restored.data (), restored.length ());
+   };
+
+   for (const auto &count : threadCounts ()) {
+      ThreadPool pool (count);
+
+      BENCHMARK (std::string ("compress, threads: ") + std::to_string (count)) {
+         ULZParallel::compress (pool, content.data (), content.length (), packed, options);
+         return packed.length ();
+      };
+
+      BENCHMARK (std::string ("uncompress, threads: ") + std::to_string (count)) {
+         ULZParallel::uncompress (pool, packed.data (), packed.length (), restored);
+         return restored.length ();
+      };
+   }
+}
+
+TEST_CASE ("ULZ context packet compression benchmark", "[benchmark][ulz]") {
+   const auto content = makeContent (kPacketSize * kNumPackets);
+   Array <uint8_t> packed (static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (kPacketSize))), 0);
+
+   auto compressPackets = [&] (ULZContext &context) {
+      int32_t total = 0;
+
+      for (size_t i = 0; i < kNumPackets; ++i) {
+         total += context.compress (content.data () + i * kPacketSize, static_cast <int32_t> (kPacketSize), packed.data ());
+      }
+      return total;
+   };
+   ULZContext small;
+
+   // tables of this one are grown to full size by a large input first
+   ULZContext grown;
+   Array <uint8_t> large (static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (kContentSize))), 0);
+   grown.compress (makeContent (kContentSize).data (), static_cast <int32_t> (kContentSize), large.data ());
+
+   REQUIRE (compressPackets (small) == compressPackets (grown));
+
+   BENCHMARK ("200-byte packets, context sized by packets") {
+      return compressPackets (small);
+   };
+
+   BENCHMARK ("200-byte packets, context grown by large input") {
+      return compressPackets (grown);
+   };
+}
+
+TEST_CASE ("ULZ compression levels ratio and speed benchmark", "[benchmark][ulz]") {
+   struct Corpus {
+      const char *name;
+      Array <uint8_t> data;
+   };
+   Corpus corpora[] = {
+      { "text", makeText (kCorpusSize) },
+      { "graph", makeGraph (kCorpusSize) },
+      { "noisy text", makeContent (kCorpusSize) },
+   };
+
+   const Twin <ULZLevel, const char *> levels[] = {
+      { ULZLevel::Fast, "fast" },
+      { ULZLevel::Default, "default" },
+      { ULZLevel::High, "high" },
+   };
+   ULZContext context;
+
+   Array <uint8_t> packed (static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (kCorpusSize))), 0);
+   Array <uint8_t> restored (kCorpusSize, 0);
+
+   // ratio goes into the name, so output reads as a table of ratio and speed per corpus and level
+   for (const auto &corpus : corpora) {
+      for (const auto &level : levels) {
+         const auto length = context.compress (corpus.data.data (), static_cast <int32_t> (kCorpusSize), packed.data (), level.first);
+         const auto ratio = static_cast <double> (kCorpusSize) / static_cast <double> (length);
+
+         REQUIRE (ULZContext::uncompress (packed.data (), length, restored.data (), static_cast <int32_t> (kCorpusSize)) == static_cast <int32_t> (kCorpusSize));
+
+         BENCHMARK (std::string (strings.format ("compress %s, %s, ratio %.2f", corpus.name, level.second, ratio))) {
+            return context.compress (corpus.data.data (), static_cast <int32_t> (kCorpusSize), packed.data (), level.first);
+         };
+
+         BENCHMARK (std::string (strings.format ("uncompress %s, %s", corpus.name, level.second))) {
+            return ULZContext::uncompress (packed.data (), length, restored.data (), static_cast <int32_t> (kCorpusSize));
+         };
+      }
+   }
+}
+
+TEST_CASE ("ULZ match extension and copy throughput benchmark", "[benchmark][ulz]") {
+   struct Corpus {
+      const char *name;
+      Array <uint8_t> data;
+   };
+   Corpus corpora[] = {
+      { "text", makeText (kThroughputSize) },
+      { "long matches", makeRepeats (kThroughputSize) },
+   };
+   ULZContext context;
+
+   Array <uint8_t> packed (static_cast <size_t> (ULZContext::bound (static_cast <int32_t> (kThroughputSize))), 0);
+   Array <uint8_t> restored (kThroughputSize, 0);
+
+   for (const auto &corpus : corpora) {
+      const auto length = context.compress (corpus.data.data (), static_cast <int32_t> (kThroughputSize), packed.data ());
+
+      REQUIRE (ULZContext::uncompress (packed.data (), length, restored.data (), static_cast <int32_t> (kThroughputSize)) == static_cast <int32_t> (kThroughputSize));
+      REQUIRE (memcmp (restored.data (), corpus.data.data (), kThroughputSize) == 0);
+
+      BENCHMARK (std::string ("compress 1 MB of ") + corpus.name) {
+         return context.compress (corpus.data.data (), static_cast <int32_t> (kThroughputSize), packed.data ());
+      };
+
+      BENCHMARK (std::string ("uncompress 1 MB of ") + corpus.name) {
+         return ULZContext::uncompress (packed.data (), length, restored.data (), static_cast <int32_t> (kThroughputSize));
+      };
+   }
+}
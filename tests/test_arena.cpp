@@ -0,0 +1,117 @@
+// test_arena.cpp — tests for crlib/arena.h (Arena, ArenaAllocator) and arena-backed containers
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+// ---------------------------------------------------------------------------
+// Arena — raw allocations
+// ---------------------------------------------------------------------------
+TEST_CASE("Arena allocations are aligned and usable", "[arena]") {
+    Arena arena(256);
+
+    auto c = arena.allocate<char>(3);
+    auto d = arena.allocate<double>(4);
+    auto v = arena.allocate(32, 64);
+
+    REQUIRE(c != nullptr);
+    REQUIRE(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(v) % 64 == 0);
+
+    for (int i = 0; i < 4; ++i) {
+        d[i] = i * 1.5;
+    }
+    REQUIRE(d[3] == 4.5);
+}
+
+TEST_CASE("Arena grows past the chunk size", "[arena]") {
+    Arena arena(64);
+
+    auto big = arena.allocate<int>(1000);
+    for (int i = 0; i < 1000; ++i) {
+        big[i] = i;
+    }
+    auto small = arena.allocate<int>(8);
+    small[0] = 42;
+
+    REQUIRE(big[999] == 999);
+    REQUIRE(small[0] == 42);
+    REQUIRE(arena.used() >= 1008 * sizeof(int));
+}
+
+TEST_CASE("Arena rewind reuses memory allocated after the mark", "[arena]") {
+    Arena arena(128);
+    arena.allocate<int>(4);
+
+    auto mark = arena.mark();
+    const auto used = arena.used();
+
+    auto first = arena.allocate<int>(200);
+    arena.rewind(mark);
+    REQUIRE(arena.used() == used);
+
+    auto second = arena.allocate<int>(200);
+    REQUIRE(first == second);
+}
+
+TEST_CASE("Arena reset drops everything", "[arena]") {
+    Arena arena(128);
+    for (int i = 0; i < 10; ++i) {
+        arena.allocate<int>(100);
+    }
+    REQUIRE(arena.used() > 0u);
+
+    arena.reset();
+    REQUIRE(arena.used() == 0u);
+
+    arena.trim();
+    REQUIRE(arena.allocate<int>(10) != nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// ArenaAllocator — containers backed by an arena
+// ---------------------------------------------------------------------------
+TEST_CASE("Array can allocate from an arena", "[arena]") {
+    Arena arena;
+    Array<int, ReservePolicy::Multiple, 0, ArenaAllocator> arr(arena);
+
+    for (int i = 0; i < 1000; ++i) {
+        arr.push(i);
+    }
+    REQUIRE(arr.length() == 1000u);
+    REQUIRE(arr[500] == 500);
+    REQUIRE(&arr.allocator().arena() == &arena);
+
+    auto moved = cr::move(arr);
+    REQUIRE(moved.length() == 1000u);
+    REQUIRE(&moved.allocator().arena() == &arena);
+}
+
+TEST_CASE("Arena-backed containers keep non-trivial values", "[arena]") {
+    Arena arena;
+    {
+        Deque<String, ArenaAllocator> dq(arena);
+        BinaryHeap<int, ArenaAllocator> heap(arena);
+        HashMap<String, int, Hash<String>, KeyEqual<String>, ArenaAllocator> map(arena);
+        HashSet<int, Hash<int>, KeyEqual<int>, ArenaAllocator> set(arena);
+
+        for (int i = 0; i < 100; ++i) {
+            dq.emplaceLast(strings.format("value %d", i));
+            heap.push(100 - i);
+            map[strings.format("key %d", i)] = i;
+            set.insert(i);
+        }
+        REQUIRE(dq.front() == "value 0");
+        REQUIRE(heap.top() == 1);
+        REQUIRE(map["key 42"] == 42);
+        REQUIRE(set.contains(99));
+        REQUIRE(set.length() == 100u);
+    }
+    REQUIRE(arena.used() > 0u);
+    arena.reset();
+}
+
+TEST_CASE("Default allocator keeps container layout", "[arena]") {
+    REQUIRE(sizeof(Array<int>) == 3 * sizeof(size_t));
+    REQUIRE(sizeof(Deque<int>) == 4 * sizeof(size_t));
+}
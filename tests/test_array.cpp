@@ -343,6 +343,182 @@ TEST_CASE("SmallArray pre-allocates 64-element capacity", "[array]") {
     REQUIRE(sa.empty());
 }
 
+// ---------------------------------------------------------------------------
+// Bulk paths for trivially copyable and other types
+// ---------------------------------------------------------------------------
+namespace {
+    struct Defaulted {
+        int value = 5;
+    };
+}
+
+TEST_CASE("Array amount constructor fills with copies", "[array]") {
+    Array<int> ints(1000u, 7);
+    REQUIRE(ints.length() == 1000u);
+    REQUIRE(ints[0] == 7);
+    REQUIRE(ints[999] == 7);
+
+    Array<char> chars(33u, 'z');
+    REQUIRE(chars[32] == 'z');
+
+    Array<String> strings(3u, String("s"));
+    REQUIRE(strings.length() == 3u);
+    REQUIRE(strings[2] == "s");
+}
+
+TEST_CASE("Array fill overwrites every element", "[array]") {
+    Array<Vector> vectors(5u, Vector(1.0f, 2.0f, 3.0f));
+    vectors.fill(Vector(4.0f, 5.0f, 6.0f));
+    for (const auto &v : vectors) {
+        REQUIRE(v == Vector(4.0f, 5.0f, 6.0f));
+    }
+
+    Array<String> strings { "a", "b" };
+    strings.fill("c");
+    REQUIRE(strings.length() == 2u);
+    REQUIRE(strings[1] == "c");
+}
+
+TEST_CASE("Array resize value-initializes new elements", "[array]") {
+    Array<int> ints { 1, 2 };
+    REQUIRE(ints.resize(100u));
+    REQUIRE(ints[1] == 2);
+    REQUIRE(ints[2] == 0);
+    REQUIRE(ints[99] == 0);
+
+    Array<Defaulted> defaulted;
+    REQUIRE(defaulted.resize(10u));
+    REQUIRE(defaulted[9].value == 5);
+
+    REQUIRE(ints.resize(1u));
+    REQUIRE(ints.length() == 1u);
+}
+
+TEST_CASE("Array range insert and extend of trivially copyable types", "[array]") {
+    Array<int> a { 1, 5 };
+    int middle[] = { 2, 3, 4 };
+
+    REQUIRE(a.insert(1u, middle, 3u));
+    REQUIRE(a.length() == 5u);
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(a[i] == i + 1);
+    }
+
+    Array<int> tail { 6, 7 };
+    REQUIRE(a.extend(tail));
+
+    InlineArray<int, 4> more { 8, 9 };
+    REQUIRE(a.extend(more));
+    REQUIRE(a.length() == 9u);
+    REQUIRE(a[8] == 9);
+
+    Array<int> b { 100 };
+    REQUIRE(b.assign(a));
+    REQUIRE(b.length() == 9u);
+    REQUIRE(b[0] == 1);
+}
+
+// ---------------------------------------------------------------------------
+// InlineArray
+// ---------------------------------------------------------------------------
+TEST_CASE("InlineArray keeps first N elements inline", "[array]") {
+    InlineArray<int, 4> a;
+    REQUIRE(a.empty());
+    REQUIRE(a.capacity() == 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(a.push(i));
+    }
+    REQUIRE(a.isInline());
+    REQUIRE(a.length() == 4u);
+
+    a.push(4);
+    REQUIRE_FALSE(a.isInline());
+    REQUIRE(a.capacity() >= 5u);
+
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(a[i] == i);
+    }
+}
+
+TEST_CASE("InlineArray insert, erase and iteration", "[array]") {
+    InlineArray<String, 3> a { "b", "d" };
+
+    REQUIRE(a.insert(0u, String("a")));
+    REQUIRE(a.insert(2u, String("c")));
+    REQUIRE(a.length() == 4u);
+
+    String joined;
+    for (const auto &str : a) {
+        joined += str;
+    }
+    REQUIRE(joined == "abcd");
+
+    REQUIRE(a.erase(1u, 2u));
+    REQUIRE(a.length() == 2u);
+    REQUIRE(a.first() == "a");
+    REQUIRE(a.last() == "d");
+
+    REQUIRE(a.emplace("e"));
+    REQUIRE(a.pop() == "e");
+    REQUIRE(a.shift());
+    REQUIRE(a[0] == "d");
+}
+
+TEST_CASE("InlineArray move transfers inline and heap contents", "[array]") {
+    InlineArray<String, 2> small { "x" };
+    InlineArray<String, 2> moved = cr::move(small);
+
+    REQUIRE(small.empty());
+    REQUIRE(moved.isInline());
+    REQUIRE(moved[0] == "x");
+
+    InlineArray<String, 2> big { "a", "b", "c" };
+    const auto data = big.data();
+
+    moved = cr::move(big);
+    REQUIRE(big.empty());
+    REQUIRE(big.isInline());
+    REQUIRE(moved.length() == 3u);
+    REQUIRE(moved.data() == data);
+    REQUIRE(moved[2] == "c");
+
+    big.push("reused");
+    REQUIRE(big[0] == "reused");
+}
+
+TEST_CASE("InlineArray resize and clear destroy elements", "[array]") {
+    InlineArray<String, 4> a;
+    REQUIRE(a.resize(6u));
+    REQUIRE(a.length() == 6u);
+    REQUIRE(a[5].empty());
+
+    REQUIRE(a.resize(2u));
+    REQUIRE(a.length() == 2u);
+
+    a.clear();
+    REQUIRE(a.empty());
+}
+
+TEST_CASE("InlineArray extend with itself doubles contents", "[array]") {
+    InlineArray<String, 4> a;
+    a.push("first string long enough to live on the heap");
+    a.push("second");
+    a.push("third");
+
+    // spills out of inline storage, so the source moves while being copied
+    REQUIRE(a.extend(a));
+    REQUIRE(a.length() == 6u);
+    REQUIRE_FALSE(a.isInline());
+    REQUIRE(a[3] == "first string long enough to live on the heap");
+    REQUIRE(a[5] == "third");
+
+    REQUIRE(a.extend(a));
+    REQUIRE(a.length() == 12u);
+    REQUIRE(a[11] == "third");
+    REQUIRE(a[6] == a[0]);
+}
+
 // ---------------------------------------------------------------------------
 // insert with count=0 edge case
 // ---------------------------------------------------------------------------
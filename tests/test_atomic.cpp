@@ -0,0 +1,94 @@
+// test_atomic.cpp — tests for crlib/atomic.h (Atomic, atomicFence)
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+// ---------------------------------------------------------------------------
+// Atomic — single thread semantics
+// ---------------------------------------------------------------------------
+TEST_CASE("Atomic load and store", "[atomic]") {
+    Atomic<int32_t> value { 5 };
+    REQUIRE(value.load() == 5);
+
+    value.store(7, MemoryOrder::Release);
+    REQUIRE(value.load(MemoryOrder::Acquire) == 7);
+}
+
+TEST_CASE("Atomic exchange returns previous value", "[atomic]") {
+    Atomic<uint64_t> value { 1 };
+    REQUIRE(value.exchange(2) == 1);
+    REQUIRE(value.load() == 2);
+}
+
+TEST_CASE("Atomic compareExchange updates expected on failure", "[atomic]") {
+    Atomic<int32_t> value { 10 };
+
+    int32_t expected = 3;
+    REQUIRE_FALSE(value.compareExchange(expected, 20));
+    REQUIRE(expected == 10);
+
+    REQUIRE(value.compareExchange(expected, 20));
+    REQUIRE(value.load() == 20);
+}
+
+TEST_CASE("Atomic arithmetic and bitwise operations return previous value", "[atomic]") {
+    Atomic<uint32_t> value { 6 };
+
+    REQUIRE(value.fetchAdd(4) == 6);
+    REQUIRE(value.fetchSub(2) == 10);
+    REQUIRE(value.fetchAnd(0xc) == 8);
+    REQUIRE(value.fetchOr(1) == 8);
+    REQUIRE(value.load() == 9);
+}
+
+TEST_CASE("Atomic works with pointers and booleans", "[atomic]") {
+    int a = 1, b = 2;
+    Atomic<int *> ptr { &a };
+
+    int *expected = &a;
+    while (!ptr.compareExchangeWeak(expected, &b)) {
+        REQUIRE(expected == &a);
+    }
+    REQUIRE(*ptr.load() == 2);
+
+    Atomic<bool> flag;
+    REQUIRE_FALSE(flag.exchange(true));
+    REQUIRE(flag.load());
+}
+
+// ---------------------------------------------------------------------------
+// Atomic — concurrent updates
+// ---------------------------------------------------------------------------
+TEST_CASE("Atomic fetchAdd from many threads loses no updates", "[atomic]") {
+    Atomic<int64_t> counter;
+    Array<Thread> threads;
+
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace([&counter]() {
+            for (int j = 0; j < 10000; ++j) {
+                counter.fetchAdd(1, MemoryOrder::Relaxed);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(counter.load() == 40000);
+}
+
+TEST_CASE("Atomic release store publishes data to acquire load", "[atomic]") {
+    int payload = 0;
+    Atomic<bool> ready;
+
+    Thread producer([&]() {
+        payload = 42;
+        ready.store(true, MemoryOrder::Release);
+    });
+
+    while (!ready.load(MemoryOrder::Acquire)) {
+        cpuRelax();
+    }
+    REQUIRE(payload == 42);
+    producer.join();
+}
@@ -0,0 +1,299 @@
+// test_concurrent.cpp — tests for crlib/concurrent.h
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+// ---------------------------------------------------------------------------
+// ConcurrentHashMap — single-threaded semantics
+// ---------------------------------------------------------------------------
+TEST_CASE("ConcurrentHashMap insert, find and erase", "[concurrent]") {
+    ConcurrentHashMap<int32_t, int32_t> m;
+    REQUIRE(m.empty());
+
+    REQUIRE(m.insert(1, 10));
+    REQUIRE_FALSE(m.insert(1, 11));
+    REQUIRE(m.insert(2, 20));
+    REQUIRE(m.length() == 2u);
+
+    int32_t value = 0;
+    REQUIRE(m.find(1, value));
+    REQUIRE(value == 10);
+    REQUIRE_FALSE(m.find(3, value));
+
+    REQUIRE(m.erase(1) == 1u);
+    REQUIRE(m.erase(1) == 0u);
+    REQUIRE_FALSE(m.exists(1));
+    REQUIRE(m.exists(2));
+}
+
+TEST_CASE("ConcurrentHashMap assign overwrites existing values", "[concurrent]") {
+    ConcurrentHashMap<String, String> m;
+    m.assign("key", "first");
+    m.assign("key", String("second"));
+
+    String value;
+    REQUIRE(m.find("key", value));
+    REQUIRE(value == "second");
+    REQUIRE(m.length() == 1u);
+}
+
+TEST_CASE("ConcurrentHashMap visit modifies the value in place", "[concurrent]") {
+    ConcurrentHashMap<String, int> m;
+    m.insert("hits", 0);
+
+    REQUIRE(m.visit(StringRef("hits"), [](int &v) { v += 5; }));
+    REQUIRE_FALSE(m.visit(StringRef("misses"), [](int &v) { v += 5; }));
+
+    int value = 0;
+    REQUIRE(m.find(StringRef("hits"), value));
+    REQUIRE(value == 5);
+}
+
+TEST_CASE("ConcurrentHashMap forEach visits entries of every shard", "[concurrent]") {
+    ConcurrentHashMap<int32_t, int32_t, Hash<int32_t>, KeyEqual<int32_t>, 4> m;
+    for (int32_t i = 0; i < 100; ++i) {
+        m.insert(i, i);
+    }
+    int32_t sum = 0;
+    size_t count = 0;
+
+    m.forEach([&](const int32_t &, int32_t &v) {
+        sum += v;
+        ++count;
+    });
+    REQUIRE(count == 100u);
+    REQUIRE(sum == 4950);
+
+    m.clear();
+    REQUIRE(m.empty());
+}
+
+// ---------------------------------------------------------------------------
+// ConcurrentHashMap — concurrent writers and readers
+// ---------------------------------------------------------------------------
+TEST_CASE("ConcurrentHashMap survives concurrent writers and readers", "[concurrent]") {
+    constexpr int32_t kThreads = 4;
+    constexpr int32_t kPerThread = 5000;
+
+    ConcurrentHashMap<int32_t, int32_t> m;
+    Array<Thread> threads;
+
+    for (int32_t t = 0; t < kThreads; ++t) {
+        threads.emplace([&m, t]() {
+            for (int32_t i = 0; i < kPerThread; ++i) {
+                const int32_t key = t * kPerThread + i;
+                m.insert(key, key * 2);
+
+                int32_t value = 0;
+                m.find(key / 2, value);
+
+                if (i % 2) {
+                    m.erase(key);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    REQUIRE(m.length() == static_cast<size_t>(kThreads * kPerThread / 2));
+
+    for (int32_t key = 0; key < kThreads * kPerThread; ++key) {
+        int32_t value = 0;
+        const bool found = m.find(key, value);
+
+        REQUIRE(found == ((key % kPerThread) % 2 == 0));
+        if (found) {
+            REQUIRE(value == key * 2);
+        }
+    }
+}
+
+TEST_CASE("ConcurrentHashMap readers share a shard with a writer", "[concurrent]") {
+    constexpr int32_t kReaders = 3;
+    constexpr int32_t kKeys = 2000;
+
+    // single shard, so every reader and the writer go through the same lock
+    ConcurrentHashMap<int32_t, int32_t, Hash<int32_t>, KeyEqual<int32_t>, 1> m;
+    Atomic<int32_t> mismatches;
+
+    Array<Thread> threads;
+    threads.emplace([&m]() {
+        for (int32_t key = 0; key < kKeys; ++key) {
+            m.insert(key, key * 3);
+        }
+    });
+
+    for (int32_t r = 0; r < kReaders; ++r) {
+        threads.emplace([&m, &mismatches]() {
+            for (int32_t round = 0; round < 5; ++round) {
+                for (int32_t key = 0; key < kKeys; ++key) {
+                    int32_t value = 0;
+
+                    if (m.find(key, value) && value != key * 3) {
+                        mismatches.fetchAdd(1);
+                    }
+                    if (m.exists(key) && m.length() == 0) {
+                        mismatches.fetchAdd(1);
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    REQUIRE(mismatches.load() == 0);
+    REQUIRE(m.length() == static_cast<size_t>(kKeys));
+}
+
+TEST_CASE("ConcurrentHashMap visit increments atomically across threads", "[concurrent]") {
+    constexpr int32_t kThreads = 4;
+    constexpr int32_t kIncrements = 10000;
+
+    ConcurrentHashMap<String, int32_t> m;
+    m.insert("counter", 0);
+
+    Array<Thread> threads;
+    for (int32_t t = 0; t < kThreads; ++t) {
+        threads.emplace([&m]() {
+            for (int32_t i = 0; i < kIncrements; ++i) {
+                m.visit("counter", [](int32_t &v) { ++v; });
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    int32_t value = 0;
+    REQUIRE(m.find("counter", value));
+    REQUIRE(value == kThreads * kIncrements);
+}
+
+// ---------------------------------------------------------------------------
+// RingQueue — single thread semantics
+// ---------------------------------------------------------------------------
+TEST_CASE("RingQueue is fifo and bounded", "[concurrent]") {
+    MpmcQueue<int32_t> q(5);
+    REQUIRE(q.capacity() == 8);
+    REQUIRE(q.empty());
+
+    for (int32_t i = 0; i < 8; ++i) {
+        REQUIRE(q.push(i));
+    }
+    REQUIRE_FALSE(q.push(8));
+    REQUIRE(q.length() == 8);
+
+    int32_t value = -1;
+    for (int32_t i = 0; i < 8; ++i) {
+        REQUIRE(q.pop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(q.pop(value));
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("RingQueue wraps around many times", "[concurrent]") {
+    SpscQueue<int32_t> q(4);
+    int32_t value = 0;
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        REQUIRE(q.push(i));
+        REQUIRE(q.push(i + 1));
+        REQUIRE(q.pop(value));
+        REQUIRE(value == i);
+        REQUIRE(q.pop(value));
+        REQUIRE(value == i + 1);
+    }
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("RingQueue moves non-trivial values and destroys leftovers", "[concurrent]") {
+    MpscQueue<String> q(4);
+
+    REQUIRE(q.emplace("a string long enough to live on the heap"));
+    REQUIRE(q.push(String("short")));
+    REQUIRE(q.push("left behind, destroyed by the queue"));
+
+    String out;
+    REQUIRE(q.pop(out));
+    REQUIRE(out == "a string long enough to live on the heap");
+
+    REQUIRE(q.pop());
+    REQUIRE(q.length() == 1);
+}
+
+// ---------------------------------------------------------------------------
+// RingQueue — stress
+// ---------------------------------------------------------------------------
+namespace {
+    template <QueuePolicy P> void stressRingQueue(int32_t producers, int32_t consumers) {
+        constexpr int64_t kPerProducer = 50000;
+
+        RingQueue<int64_t, P> q(256);
+        Atomic<int64_t> sum;
+        Atomic<int64_t> received;
+        Array<int32_t> lastSeen(static_cast<size_t>(producers * consumers), -1);
+        Atomic<int32_t> outOfOrder;
+
+        Array<Thread> threads;
+
+        for (int32_t c = 0; c < consumers; ++c) {
+            threads.emplace([&, c]() {
+                int64_t value = 0;
+
+                while (received.load(MemoryOrder::Relaxed) < producers * kPerProducer) {
+                    if (!q.pop(value)) {
+                        Thread::yield();
+                        continue;
+                    }
+                    const auto producer = static_cast<int32_t>(value / kPerProducer);
+                    const auto sequence = static_cast<int32_t>(value % kPerProducer);
+
+                    // values of one producer reach each consumer in order
+                    auto &last = lastSeen[static_cast<size_t>(c * producers + producer)];
+                    if (sequence <= last) {
+                        outOfOrder.fetchAdd(1);
+                    }
+                    last = sequence;
+
+                    sum.fetchAdd(value, MemoryOrder::Relaxed);
+                    received.fetchAdd(1, MemoryOrder::Relaxed);
+                }
+            });
+        }
+
+        for (int32_t p = 0; p < producers; ++p) {
+            threads.emplace([&q, p]() {
+                for (int64_t i = 0; i < kPerProducer; ++i) {
+                    while (!q.push(p * kPerProducer + i)) {
+                        Thread::yield();
+                    }
+                }
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        const int64_t total = producers * kPerProducer;
+
+        REQUIRE(received.load() == total);
+        REQUIRE(sum.load() == total * (total - 1) / 2);
+        REQUIRE(outOfOrder.load() == 0);
+        REQUIRE(q.empty());
+    }
+}
+
+TEST_CASE("RingQueue stress delivers every value exactly once", "[concurrent]") {
+    SECTION("spsc") {
+        stressRingQueue<QueuePolicy::Spsc>(1, 1);
+    }
+    SECTION("mpsc") {
+        stressRingQueue<QueuePolicy::Mpsc>(4, 1);
+    }
+    SECTION("mpmc") {
+        stressRingQueue<QueuePolicy::Mpmc>(4, 4);
+    }
+}
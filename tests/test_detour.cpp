@@ -1,9 +1,9 @@
 // test_detour.cpp — tests for crlib/detour.h (Detour<T>)
 //
-// NOTE: We do NOT actually install any hooks because patching executable
-// memory during unit tests is risky and platform-dependent. Instead we
-// verify the default/initial state of the Detour object and the behaviour
-// of the shim on unsupported platforms.
+// NOTE: Most tests do NOT call hooked functions, they verify the state of
+// the Detour object and the behaviour of the shim on unsupported platforms.
+// Hooked calls are tested on functions made for it, that are long enough
+// to take the patch.
 //
 #include <crlib/crlib.h>
 #include "catch2/catch_amalgamated.hpp"
@@ -174,4 +174,153 @@ TEST_CASE("Detour constructor with parameters initializes correctly", "[detour]"
     d.install(reinterpret_cast<void*>(replacementFunction), false);
     REQUIRE(d.valid());
 }
+
+// ---------------------------------------------------------------------------
+// Length disassembler
+// ---------------------------------------------------------------------------
+static detail::DetourInstruction decode(std::initializer_list<uint8_t> bytes) {
+    uint8_t code[32] {};
+    size_t i = 0;
+
+    for (auto byte : bytes) {
+        code[i++] = byte;
+    }
+    return detail::decodeInstruction(code);
+}
+
+TEST_CASE("Detour decoder measures common prologue instructions", "[detour]") {
+    REQUIRE(decode({ 0x55 }).length == 1);                                // push ebp/rbp
+    REQUIRE(decode({ 0x89, 0xe5 }).length == 2);                          // mov ebp, esp
+    REQUIRE(decode({ 0x83, 0xec, 0x20 }).length == 3);                    // sub esp, 0x20
+    REQUIRE(decode({ 0x81, 0xec, 0x00, 0x01, 0x00, 0x00 }).length == 6);  // sub esp, 0x100
+    REQUIRE(decode({ 0x8b, 0x44, 0x24, 0x04 }).length == 4);              // mov eax, [esp + 4]
+    REQUIRE(decode({ 0x8b, 0x84, 0x24, 0x00, 0x01, 0x00, 0x00 }).length == 7); // mov eax, [esp + 0x100]
+    REQUIRE(decode({ 0x31, 0xc0 }).length == 2);                          // xor eax, eax
+    REQUIRE(decode({ 0xb8, 0x01, 0x00, 0x00, 0x00 }).length == 5);        // mov eax, 1
+    REQUIRE(decode({ 0x66, 0xb8, 0x01, 0x00 }).length == 4);              // mov ax, 1
+    REQUIRE(decode({ 0xc7, 0x45, 0xfc, 0x00, 0x00, 0x00, 0x00 }).length == 7); // mov dword [ebp - 4], 0
+    REQUIRE(decode({ 0xf3, 0x0f, 0x1e, 0xfa }).length == 4);              // endbr64
+    REQUIRE(decode({ 0x0f, 0x1f, 0x44, 0x00, 0x00 }).length == 5);        // nop dword [eax + eax]
+    REQUIRE(decode({ 0x66, 0x2e, 0x0f, 0x1f, 0x84, 0, 0, 0, 0, 0 }).length == 10); // cs nop word
+    REQUIRE(decode({ 0xf6, 0xc1, 0x01 }).length == 3);                    // test cl, 1
+    REQUIRE(decode({ 0xf7, 0xd8 }).length == 2);                          // neg eax
+    REQUIRE(decode({ 0xc3 }).length == 1);                                // ret
+}
+
+TEST_CASE("Detour decoder reports relative operands", "[detour]") {
+    auto call = decode({ 0xe8, 0x10, 0x00, 0x00, 0x00 });
+    REQUIRE(call.length == 5);
+    REQUIRE(call.relative == 1);
+
+    auto jcc = decode({ 0x0f, 0x84, 0x10, 0x00, 0x00, 0x00 });
+    REQUIRE(jcc.length == 6);
+    REQUIRE(jcc.relative == 2);
+
+    REQUIRE(decode({ 0x89, 0xe5 }).relative == 0);
+}
+
+TEST_CASE("Detour decoder refuses short branches and unknown opcodes", "[detour]") {
+    REQUIRE(decode({ 0xeb, 0x10 }).length == 0);  // jmp rel8
+    REQUIRE(decode({ 0x74, 0x10 }).length == 0);  // je rel8
+    REQUIRE(decode({ 0xe2, 0x10 }).length == 0);  // loop
+    REQUIRE(decode({ 0x0f, 0x38, 0x00, 0xc0 }).length == 0);
+}
+
+#if defined(CR_ARCH_X64)
+TEST_CASE("Detour decoder handles rex prefixes and rip-relative operands", "[detour]") {
+    REQUIRE(decode({ 0x48, 0x89, 0xe5 }).length == 3);                    // mov rbp, rsp
+    REQUIRE(decode({ 0x48, 0x83, 0xec, 0x28 }).length == 4);              // sub rsp, 0x28
+    REQUIRE(decode({ 0x41, 0x57 }).length == 2);                          // push r15
+    REQUIRE(decode({ 0x48, 0xb8, 1, 2, 3, 4, 5, 6, 7, 8 }).length == 10); // mov rax, imm64
+
+    auto load = decode({ 0x48, 0x8b, 0x05, 0x10, 0x00, 0x00, 0x00 });     // mov rax, [rip + 0x10]
+    REQUIRE(load.length == 7);
+    REQUIRE(load.relative == 3);
+
+    auto store = decode({ 0xc7, 0x05, 0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00 }); // mov dword [rip + 0x10], 1
+    REQUIRE(store.length == 10);
+    REQUIRE(store.relative == 2);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Hooked calls
+// ---------------------------------------------------------------------------
+#if defined(CR_CXX_MSVC)
+#  define TEST_NOINLINE __declspec(noinline)
+#else
+#  define TEST_NOINLINE __attribute__((noinline))
+#endif
+
+// volatile accesses keep the body long enough for the patch
+TEST_NOINLINE static int hookTarget(int x) {
+    volatile int value = x;
+    value = value * 3;
+    value = value + 7;
+    value = value ^ 5;
+    return value;
+}
+
+static Detour<IntFn> *activeHook = nullptr;
+
+static int hookReplacement(int x) {
+    return (*activeHook)(x) + 1000;
+}
+
+static int callTarget(int x) {
+    int (*volatile fn)(int) = hookTarget;
+    return fn(x);
+}
+
+TEST_CASE("Detour hooked function calls original through trampoline", "[detour]") {
+    const int expected = callTarget(10);
+
+    Detour<IntFn> d("", "", hookTarget);
+    d.install(reinterpret_cast<void*>(hookReplacement), true);
+    activeHook = &d;
+
+    REQUIRE(d.hasTrampoline());
+    REQUIRE(d.detoured());
+
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(callTarget(10) == expected + 1000);
+        REQUIRE(d.detoured());
+    }
+    REQUIRE(d(10) == expected);
+
+    REQUIRE(d.restore());
+    REQUIRE(callTarget(10) == expected);
+    activeHook = nullptr;
+}
+
+TEST_CASE("Detour without trampoline unpatches around original call", "[detour]") {
+    const int expected = callTarget(4);
+
+    Detour<IntFn> d("", "", hookTarget);
+    d.install(reinterpret_cast<void*>(hookReplacement), true, false);
+    activeHook = &d;
+
+    REQUIRE_FALSE(d.hasTrampoline());
+    REQUIRE(callTarget(4) == expected + 1000);
+    REQUIRE(d.detoured());
+
+    REQUIRE(d.restore());
+    REQUIRE(callTarget(4) == expected);
+    activeHook = nullptr;
+}
+
+TEST_CASE("Detour reinstall replaces trampoline", "[detour]") {
+    const int expected = callTarget(1);
+
+    Detour<IntFn> d("", "", hookTarget);
+    d.install(reinterpret_cast<void*>(hookReplacement), false);
+    d.install(reinterpret_cast<void*>(hookReplacement), true);
+    activeHook = &d;
+
+    REQUIRE(d.hasTrampoline());
+    REQUIRE(callTarget(1) == expected + 1000);
+
+    d.restore();
+    activeHook = nullptr;
+}
 #endif
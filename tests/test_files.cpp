@@ -378,6 +378,30 @@ TEST_CASE("FileEnumerator finds the file we just created", "[files]") {
     plat.removeFile(fname);
 }
 
+TEST_CASE("FileEnumerator forEach visits every match", "[files]") {
+    const char *names[] = { "crlib_test_each_a.tmp", "crlib_test_each_b.tmp" };
+
+    for (auto name : names) {
+        File fw(name, "w");
+        fw.puts("x");
+    }
+    FileEnumerator fe("crlib_test_each_*.tmp");
+    int found = 0;
+
+    const auto visited = fe.forEach([&found](const String &match) {
+        if (match.contains("crlib_test_each_")) {
+            ++found;
+        }
+    });
+    REQUIRE(visited == 2);
+    REQUIRE(found == 2);
+    REQUIRE(!fe);
+
+    for (auto name : names) {
+        plat.removeFile(name);
+    }
+}
+
 TEST_CASE("FileEnumerator with no matches is not valid from the start", "[files]") {
     FileEnumerator fe("crlib_this_file_does_not_exist_xyz_123.zzz");
     // On Windows: handle == INVALID_HANDLE_VALUE => stillValid() == false
@@ -386,6 +386,20 @@ TEST_CASE("HashMap handles multiple erase and reinsert cycles", "[hashmap]") {
     }
 }
 
+TEST_CASE("HashMap reserve makes room for n entries without rehashing", "[hashmap]") {
+    for (int32_t n : { 7, 8, 14, 15, 56, 57, 100, 112, 113, 1000 }) {
+        HashMap<int32_t, int32_t> m;
+        m.reserve(static_cast<size_t>(n));
+
+        const size_t cap = m.capacity();
+        for (int32_t i = 0; i < n; ++i) {
+            m[i] = i;
+        }
+        REQUIRE(m.capacity() == cap);
+        REQUIRE(m.length() == static_cast<size_t>(n));
+    }
+}
+
 // ---------------------------------------------------------------------------
 // reserve when smaller than current (no-op)
 // ---------------------------------------------------------------------------
@@ -459,3 +473,228 @@ TEST_CASE("HashMap erase on empty map returns 0", "[hashmap]") {
     m.clear();
     REQUIRE(m.erase("anything") == 0u);
 }
+
+// ---------------------------------------------------------------------------
+// Group probing — collisions spanning several control groups
+// ---------------------------------------------------------------------------
+TEST_CASE("HashMap resolves collisions spanning multiple groups", "[hashmap]") {
+    struct CollidingHash {
+        uint32_t operator()(int32_t) const noexcept {
+            return 7;
+        }
+    };
+
+    HashMap<int32_t, int32_t, CollidingHash> m;
+    for (int32_t i = 0; i < 100; ++i) {
+        m[i] = i * 3;
+    }
+    REQUIRE(m.length() == 100u);
+
+    for (int32_t i = 0; i < 100; i += 3) {
+        REQUIRE(m.erase(i) == 1u);
+    }
+    for (int32_t i = 0; i < 100; ++i) {
+        if (i % 3 == 0) {
+            REQUIRE_FALSE(m.exists(i));
+        }
+        else {
+            REQUIRE(m.find(i) != nullptr);
+            REQUIRE(*m.find(i) == i * 3);
+        }
+    }
+}
+
+TEST_CASE("HashMap finds keys sharing the same control byte", "[hashmap]") {
+    // identical low bits produce equal 7-bit tags, so only key comparison tells them apart
+    HashMap<int32_t, int32_t, EmptyHash<int32_t>> m;
+    for (int32_t i = 0; i < 64; ++i) {
+        m[i << 16] = i;
+    }
+    REQUIRE(m.length() == 64u);
+
+    for (int32_t i = 0; i < 64; ++i) {
+        REQUIRE(m[i << 16] == i);
+    }
+    REQUIRE_FALSE(m.exists(65 << 16));
+}
+
+// ---------------------------------------------------------------------------
+// Entries are constructed and destroyed only for occupied slots
+// ---------------------------------------------------------------------------
+TEST_CASE("HashMap destroys every value it constructed", "[hashmap]") {
+    static int alive = 0;
+
+    struct Tracked {
+        Tracked() { ++alive; }
+        Tracked(Tracked &&) noexcept { ++alive; }
+        Tracked &operator=(Tracked &&) noexcept { return *this; }
+        ~Tracked() { --alive; }
+    };
+
+    {
+        HashMap<int32_t, Tracked> m;
+        REQUIRE(alive == 0);
+
+        for (int32_t i = 0; i < 100; ++i) {
+            m[i];
+        }
+        REQUIRE(alive == 100);
+
+        for (int32_t i = 0; i < 50; ++i) {
+            m.erase(i);
+        }
+        REQUIRE(alive == 50);
+
+        m.clear();
+        REQUIRE(alive == 0);
+
+        m[1];
+        m[2];
+        REQUIRE(alive == 2);
+    }
+    REQUIRE(alive == 0);
+}
+
+TEST_CASE("HashMap keeps a moved-from map usable", "[hashmap]") {
+    HashMap<String, int> a;
+    a["one"] = 1;
+
+    HashMap<String, int> b(cr::move(a));
+    REQUIRE(a.capacity() == 0u);
+    REQUIRE_FALSE(a.exists("one"));
+    REQUIRE(a.find("one") == nullptr);
+    REQUIRE(a.erase("one") == 0u);
+
+    a["two"] = 2;
+    REQUIRE(a.length() == 1u);
+    REQUIRE(a["two"] == 2);
+    REQUIRE(b["one"] == 1);
+}
+
+// ---------------------------------------------------------------------------
+// Churn — tombstones must not accumulate
+// ---------------------------------------------------------------------------
+TEST_CASE("HashMap capacity stays bounded under insert/erase churn", "[hashmap]") {
+    HashMap<int32_t, int32_t> m;
+    constexpr int32_t kLive = 100;
+
+    for (int32_t i = 0; i < 200000; ++i) {
+        m[i] = i;
+
+        if (i >= kLive) {
+            REQUIRE(m.erase(i - kLive) == 1u);
+        }
+    }
+    REQUIRE(m.length() == static_cast<size_t>(kLive));
+    REQUIRE(m.capacity() <= 512u);
+
+    for (int32_t i = 200000 - kLive; i < 200000; ++i) {
+        REQUIRE(m.exists(i));
+    }
+    REQUIRE_FALSE(m.exists(200000 - kLive - 1));
+}
+
+TEST_CASE("HashMap compacts tombstones in place keeping values intact", "[hashmap]") {
+    HashMap<int32_t, String> m;
+    constexpr int32_t kLive = 100;
+    int32_t next = 0;
+
+    auto churn = [&](int32_t rounds) {
+        for (int32_t i = 0; i < rounds; ++i, ++next) {
+            m[next] = String().assignf("%d", next);
+
+            if (next >= kLive) {
+                REQUIRE(m.erase(next - kLive) == 1u);
+            }
+        }
+    };
+    churn(10000);
+    const size_t cap = m.capacity();
+
+    // enough rounds for tombstones to reach the growth limit several times
+    churn(100000);
+    REQUIRE(m.capacity() == cap);
+    REQUIRE(m.length() == static_cast<size_t>(kLive));
+
+    for (int32_t i = next - kLive; i < next; ++i) {
+        auto *val = m.find(i);
+        REQUIRE(val != nullptr);
+        REQUIRE(*val == String().assignf("%d", i));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Heterogeneous lookup
+// ---------------------------------------------------------------------------
+TEST_CASE("HashMap<String> looks up by StringRef and const char*", "[hashmap]") {
+    HashMap<String, int> m;
+    m["alpha"] = 1;
+    m["beta"] = 2;
+
+    const char *key = "alpha";
+    REQUIRE(m.exists(key));
+    REQUIRE(m.exists(StringRef("beta")));
+    REQUIRE_FALSE(m.exists(StringRef("gamma")));
+
+    REQUIRE(m.find(StringRef("alpha")) != nullptr);
+    REQUIRE(*m.find(key) == 1);
+
+    const auto &cm = m;
+    REQUIRE(*cm.find(StringRef("beta")) == 2);
+
+    m[StringRef("gamma")] = 3;
+    REQUIRE(m.length() == 3u);
+    REQUIRE(m[String("gamma")] == 3);
+
+    REQUIRE(m.erase(StringRef("alpha")) == 1u);
+    REQUIRE(m.erase(key) == 0u);
+    REQUIRE(m.length() == 2u);
+}
+
+TEST_CASE("HashMap<StringRef> looks up by String", "[hashmap]") {
+    HashMap<StringRef, int> m;
+    m[StringRef("hello")] = 5;
+
+    String owned("hello");
+    REQUIRE(m.exists(owned));
+    REQUIRE(*m.find(owned) == 5);
+}
+
+TEST_CASE("HashMap transparent lookup never converts the probe to a key", "[hashmap]") {
+    static int conversions = 0;
+
+    struct Key {
+        int32_t id {};
+
+        Key() = default;
+        Key(int32_t id) : id(id) { ++conversions; }
+
+        bool operator==(const Key &rhs) const { return id == rhs.id; }
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+
+        uint32_t operator()(const Key &key) const noexcept { return Hash<int32_t>{}(key.id); }
+        uint32_t operator()(int32_t id) const noexcept { return Hash<int32_t>{}(id); }
+    };
+
+    struct KeyEq {
+        using is_transparent = void;
+
+        bool operator()(const Key &a, const Key &b) const noexcept { return a.id == b.id; }
+        bool operator()(const Key &a, int32_t b) const noexcept { return a.id == b; }
+    };
+
+    HashMap<Key, int, KeyHash, KeyEq> m;
+    m[1] = 10;
+    m[2] = 20;
+    REQUIRE(conversions == 2);
+
+    REQUIRE(m.exists(1));
+    REQUIRE(*m.find(2) == 20);
+    REQUIRE(m.find(3) == nullptr);
+    REQUIRE(m.erase(1) == 1u);
+    REQUIRE(m[2] == 20);
+    REQUIRE(conversions == 2);
+}
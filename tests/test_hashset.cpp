@@ -0,0 +1,195 @@
+// test_hashset.cpp — tests for crlib/hashset.h
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+// ---------------------------------------------------------------------------
+// Construction / empty state
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet default construction is empty", "[hashset]") {
+    HashSet<int32_t> s;
+    REQUIRE(s.empty());
+    REQUIRE(s.length() == 0u);
+    REQUIRE(s.capacity() > 0u);
+}
+
+TEST_CASE("HashSet initializer-list construction skips duplicates", "[hashset]") {
+    HashSet<int32_t> s { 1, 2, 3, 2, 1 };
+    REQUIRE(s.length() == 3u);
+    REQUIRE(s.contains(1));
+    REQUIRE(s.contains(2));
+    REQUIRE(s.contains(3));
+}
+
+// ---------------------------------------------------------------------------
+// insert / contains / erase
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet insert returns false for duplicate key", "[hashset]") {
+    HashSet<String> s;
+    REQUIRE(s.insert("alpha"));
+    REQUIRE_FALSE(s.insert("alpha"));
+
+    String beta("beta");
+    REQUIRE(s.insert(beta));
+    REQUIRE(s.insert(String("gamma")));
+    REQUIRE(s.length() == 3u);
+}
+
+TEST_CASE("HashSet erase removes an existing key", "[hashset]") {
+    HashSet<int32_t> s { 10, 20, 30 };
+    REQUIRE(s.erase(20) == 1u);
+    REQUIRE(s.erase(20) == 0u);
+    REQUIRE(s.length() == 2u);
+    REQUIRE_FALSE(s.contains(20));
+    REQUIRE(s.contains(10));
+}
+
+TEST_CASE("HashSet<String> looks up by StringRef and const char*", "[hashset]") {
+    HashSet<String> s;
+    s.insert("command");
+
+    REQUIRE(s.contains(StringRef("command")));
+    REQUIRE(s.contains("command"));
+    REQUIRE_FALSE(s.contains("other"));
+    REQUIRE(s.erase(StringRef("command")) == 1u);
+    REQUIRE(s.empty());
+}
+
+TEST_CASE("HashSet handles many insertions and erasures", "[hashset]") {
+    HashSet<int32_t> s;
+    for (int32_t i = 0; i < 1000; ++i) {
+        REQUIRE(s.insert(i));
+    }
+    for (int32_t i = 0; i < 1000; i += 2) {
+        REQUIRE(s.erase(i) == 1u);
+    }
+    REQUIRE(s.length() == 500u);
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        REQUIRE(s.contains(i) == (i % 2 == 1));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Bulk insert
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet inserts a range of keys", "[hashset]") {
+    Array<String> names;
+    names.emplace("a");
+    names.emplace("b");
+    names.emplace("a");
+
+    HashSet<String> s;
+    REQUIRE(s.insert(names) == 2u);
+    REQUIRE(s.length() == 2u);
+    REQUIRE(s.contains("a"));
+    REQUIRE(s.contains("b"));
+}
+
+// ---------------------------------------------------------------------------
+// Iteration
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet iteration visits every key once", "[hashset]") {
+    HashSet<int32_t> s { 1, 2, 3, 4 };
+
+    int32_t sum = 0;
+    int32_t count = 0;
+    for (const auto &key : s) {
+        sum += key;
+        ++count;
+    }
+    REQUIRE(count == 4);
+    REQUIRE(sum == 10);
+}
+
+// ---------------------------------------------------------------------------
+// Set algebra
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet unite adds keys of the other set", "[hashset]") {
+    HashSet<int32_t> a { 1, 2, 3 };
+    HashSet<int32_t> b { 3, 4, 5 };
+
+    REQUIRE(a.unite(b) == 2u);
+    REQUIRE(a.length() == 5u);
+    for (int32_t i = 1; i <= 5; ++i) {
+        REQUIRE(a.contains(i));
+    }
+    REQUIRE(b.length() == 3u);
+    REQUIRE(a.unite(a) == 0u);
+}
+
+TEST_CASE("HashSet unite and unionOf size the table once for all the keys", "[hashset]") {
+    HashSet<int32_t> a;
+    HashSet<int32_t> b;
+
+    // 120 keys are past growth limit of a 128 slot table, so reserving 120 slots alone isn't enough
+    for (int32_t i = 0; i < 60; ++i) {
+        a.insert(i);
+        b.insert(1000 + i);
+    }
+    HashSet<int32_t> expected;
+    expected.reserve(120);
+
+    auto u = HashSet<int32_t>::unionOf(a, b);
+    REQUIRE(u.length() == 120u);
+    REQUIRE(u.capacity() == 256u);
+    REQUIRE(u.capacity() == expected.capacity());
+
+    REQUIRE(a.unite(b) == 60u);
+    REQUIRE(a.capacity() == expected.capacity());
+}
+
+TEST_CASE("HashSet intersect keeps only common keys", "[hashset]") {
+    HashSet<int32_t> a { 1, 2, 3, 4 };
+    HashSet<int32_t> b { 3, 4, 5 };
+
+    REQUIRE(a.intersect(b) == 2u);
+    REQUIRE(a.length() == 2u);
+    REQUIRE(a.contains(3));
+    REQUIRE(a.contains(4));
+    REQUIRE_FALSE(a.contains(1));
+}
+
+TEST_CASE("HashSet unionOf and intersectionOf leave operands untouched", "[hashset]") {
+    HashSet<String> a { String("x"), String("y") };
+    HashSet<String> b { String("y"), String("z") };
+
+    auto u = HashSet<String>::unionOf(a, b);
+    REQUIRE(u.length() == 3u);
+    REQUIRE(u.contains("x"));
+    REQUIRE(u.contains("z"));
+
+    auto i = HashSet<String>::intersectionOf(a, b);
+    REQUIRE(i.length() == 1u);
+    REQUIRE(i.contains("y"));
+
+    REQUIRE(a.length() == 2u);
+    REQUIRE(b.length() == 2u);
+}
+
+// ---------------------------------------------------------------------------
+// Move / clear
+// ---------------------------------------------------------------------------
+TEST_CASE("HashSet move transfers keys", "[hashset]") {
+    HashSet<int32_t> a { 7, 8 };
+    HashSet<int32_t> b(cr::move(a));
+
+    REQUIRE(b.length() == 2u);
+    REQUIRE(a.empty());
+
+    HashSet<int32_t> c;
+    c = cr::move(b);
+    REQUIRE(c.contains(7));
+    REQUIRE(b.empty());
+}
+
+TEST_CASE("HashSet clear removes all keys", "[hashset]") {
+    HashSet<String> s { String("a"), String("b") };
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.contains("a"));
+
+    s.insert("c");
+    REQUIRE(s.length() == 1u);
+}
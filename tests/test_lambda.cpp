@@ -337,3 +337,164 @@ TEST_CASE("Lambda move assignment replaces SBO with heap lambda", "[lambda]") {
     REQUIRE(sboLambda() == 500);
     REQUIRE_FALSE(bool(heapLambda));
 }
+
+// ---------------------------------------------------------------------------
+// Inline storage size, bytewise copies and move-only lambdas
+// ---------------------------------------------------------------------------
+TEST_CASE("InlineLambda keeps captures up to its size inline", "[lambda]") {
+    struct Capture {
+        int64_t data[8] {};
+    };
+    auto fn = [c = Capture {}] { return c.data[0]; };
+
+    STATIC_REQUIRE_FALSE(Lambda<int64_t()>::storesInline<decltype(fn)>());
+    STATIC_REQUIRE(InlineLambda<int64_t(), sizeof(Capture)>::storesInline<decltype(fn)>());
+
+    InlineLambda<int64_t(), sizeof(Capture)> inlined(fn);
+    REQUIRE(inlined() == 0);
+}
+
+TEST_CASE("InlineLambda copies of trivially copyable callables are independent", "[lambda]") {
+    int a = 1, b = 2, c = 3;
+    InlineLambda<int(), 48> first([a, b, c] { return a + b + c; });
+    InlineLambda<int(), 48> copy(first);
+    InlineLambda<int(), 48> moved(cr::move(first));
+
+    REQUIRE(copy() == 6);
+    REQUIRE(moved() == 6);
+    REQUIRE_FALSE(bool(first));
+}
+
+TEST_CASE("Lambda destroys inline callables exactly once", "[lambda]") {
+    int destroyed = 0;
+
+    struct Tracker {
+        int *destroyed;
+        Tracker (int *d) : destroyed (d) {}
+        Tracker (const Tracker &o) : destroyed (o.destroyed) {}
+        ~Tracker () { ++*destroyed; }
+        int operator() () const { return 5; }
+    };
+
+    {
+        Lambda<int()> fn(Tracker { &destroyed });
+        destroyed = 0;
+
+        Lambda<int()> copy(fn);
+        Lambda<int()> moved(cr::move(fn));
+
+        REQUIRE(copy() == 5);
+        REQUIRE(moved() == 5);
+        REQUIRE(destroyed == 1); // moved-from source
+    }
+    REQUIRE(destroyed == 3);
+}
+
+TEST_CASE("Lambda calls mutable callables", "[lambda]") {
+    Lambda<int()> counter([n = 0] () mutable { return ++n; });
+
+    REQUIRE(counter() == 1);
+    REQUIRE(counter() == 2);
+}
+
+TEST_CASE("UniqueLambda holds move-only callables", "[lambda]") {
+    auto value = cr::makeUnique<int>(41);
+    UniqueLambda<int()> fn([value = cr::move(value)] { return *value + 1; });
+
+    REQUIRE(fn() == 42);
+
+    UniqueLambda<int()> moved(cr::move(fn));
+    REQUIRE_FALSE(bool(fn));
+    REQUIRE(moved() == 42);
+
+    UniqueLambda<int()> assigned;
+    assigned = cr::move(moved);
+    REQUIRE(assigned() == 42);
+}
+
+TEST_CASE("UniqueLambda holds large move-only callables on the heap", "[lambda]") {
+    struct BigCapture {
+        int data[64] {};
+    };
+    auto big = cr::makeUnique<BigCapture>();
+    big->data[10] = 11;
+
+    auto callable = [big = cr::move(big), pad = BigCapture {}] { return big->data[10] + pad.data[0]; };
+    STATIC_REQUIRE_FALSE(UniqueLambda<int()>::storesInline<decltype(callable)>());
+
+    UniqueLambda<int()> fn(cr::move(callable));
+    UniqueLambda<int()> moved(cr::move(fn));
+
+    REQUIRE(moved() == 11);
+}
+
+TEST_CASE("UniqueLambda is not copyable", "[lambda]") {
+    STATIC_REQUIRE_FALSE(__is_constructible(UniqueLambda<void()>, const UniqueLambda<void()> &));
+    STATIC_REQUIRE(__is_constructible(Lambda<void()>, const Lambda<void()> &));
+}
+
+TEST_CASE("UniqueLambda wraps a copyable lambda", "[lambda]") {
+    Lambda<int(int)> twice([](int x) { return x * 2; });
+    UniqueLambda<int(int), 64> fn(twice);
+
+    REQUIRE(fn(21) == 42);
+    REQUIRE(twice(4) == 8);
+}
+
+// ---------------------------------------------------------------------------
+// FunctionRef
+// ---------------------------------------------------------------------------
+static int applyTwice(FunctionRef<int(int)> fn, int value) {
+    return fn(fn(value));
+}
+
+TEST_CASE("FunctionRef is two pointers in size and empty by default", "[lambda]") {
+    STATIC_REQUIRE(sizeof(FunctionRef<void()>) == sizeof(void *) * 2);
+
+    FunctionRef<void()> empty;
+    REQUIRE_FALSE(bool(empty));
+
+    FunctionRef<void()> null(nullptr);
+    REQUIRE_FALSE(bool(null));
+}
+
+TEST_CASE("FunctionRef calls temporary lambdas passed as parameter", "[lambda]") {
+    int offset = 3;
+    REQUIRE(applyTwice([offset](int x) { return x + offset; }, 1) == 7);
+}
+
+TEST_CASE("FunctionRef calls functions and function pointers", "[lambda]") {
+    REQUIRE(applyTwice(+[](int x) { return x * 3; }, 2) == 18);
+
+    FunctionRef<int(int, int)> fn(staticFunc);
+    REQUIRE(fn(6, 7) == 42);
+
+    int (*pointer)(int, int) = staticFunc;
+    FunctionRef<int(int, int)> fromPointer(pointer);
+    REQUIRE(fromPointer(2, 5) == 10);
+
+    pointer = nullptr;
+    FunctionRef<int(int, int)> fromNull(pointer);
+    REQUIRE_FALSE(bool(fromNull));
+}
+
+TEST_CASE("FunctionRef refers to the callable instead of copying it", "[lambda]") {
+    int calls = 0;
+    auto counter = [&calls, n = 0]() mutable { ++calls; return ++n; };
+
+    FunctionRef<int()> ref(counter);
+    FunctionRef<int()> copy(ref);
+
+    REQUIRE(ref() == 1);
+    REQUIRE(copy() == 2);
+    REQUIRE(counter() == 3);
+    REQUIRE(calls == 3);
+}
+
+TEST_CASE("FunctionRef refers to a Lambda and const callables", "[lambda]") {
+    Lambda<int(int)> twice([](int x) { return x * 2; });
+    REQUIRE(applyTwice(twice, 5) == 20);
+
+    const auto negate = [](int x) { return -x; };
+    REQUIRE(applyTwice(negate, 5) == 5);
+}
@@ -0,0 +1,123 @@
+// test_parallel.cpp — tests for crlib/parallel.h (parallelFor, parallelReduce)
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+// ---------------------------------------------------------------------------
+// parallelFor
+// ---------------------------------------------------------------------------
+TEST_CASE("parallelFor visits every index exactly once", "[parallel]") {
+    ThreadPool pool(3);
+    const size_t count = 10007;
+
+    Array<int32_t> hits(count, 0);
+    parallelFor(pool, 0, count, 0, [&hits](size_t i) {
+        ++hits[i];
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        REQUIRE(hits[i] == 1);
+    }
+}
+
+TEST_CASE("parallelFor respects begin, end and explicit grain", "[parallel]") {
+    ThreadPool pool(2);
+    Array<int32_t> hits(100, 0);
+
+    for (size_t grain : { 1, 7, 64, 1000 }) {
+        parallelFor(pool, 10, 90, grain, [&hits](size_t i) {
+            ++hits[i];
+        });
+    }
+
+    for (size_t i = 0; i < hits.length(); ++i) {
+        REQUIRE(hits[i] == (i >= 10 && i < 90 ? 4 : 0));
+    }
+}
+
+TEST_CASE("parallelFor over array elements", "[parallel]") {
+    ThreadPool pool(2);
+    Array<int32_t> values;
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        values.push(i);
+    }
+    parallelFor(pool, values, 16, [](int32_t &value) {
+        value *= 2;
+    });
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        REQUIRE(values[i] == i * 2);
+    }
+}
+
+TEST_CASE("parallelFor handles empty range and pool without workers", "[parallel]") {
+    ThreadPool idle;
+    int32_t calls = 0;
+
+    parallelFor(idle, 5, 5, 0, [&calls](size_t) {
+        ++calls;
+    });
+    REQUIRE(calls == 0);
+
+    parallelFor(idle, 0, 50, 3, [&calls](size_t) {
+        ++calls;
+    });
+    REQUIRE(calls == 50);
+}
+
+TEST_CASE("parallelFor may be nested inside pool jobs", "[parallel]") {
+    ThreadPool pool(2);
+    Atomic<int32_t> total;
+
+    parallelFor(pool, 0, 8, 1, [&](size_t) {
+        parallelFor(pool, 0, 100, 10, [&total](size_t) {
+            total.fetchAdd(1, MemoryOrder::Relaxed);
+        });
+    });
+    REQUIRE(total.load() == 800);
+}
+
+// ---------------------------------------------------------------------------
+// parallelReduce
+// ---------------------------------------------------------------------------
+TEST_CASE("parallelReduce sums range", "[parallel]") {
+    ThreadPool pool(3);
+
+    const auto sum = parallelReduce(pool, 1, 100001, 0, static_cast<int64_t>(0), [](size_t i) {
+        return static_cast<int64_t>(i);
+    }, [](int64_t a, int64_t b) {
+        return a + b;
+    });
+    REQUIRE(sum == 5000050000ll);
+}
+
+TEST_CASE("parallelReduce combines chunks in index order", "[parallel]") {
+    ThreadPool pool(2);
+
+    const auto text = parallelReduce(pool, 0, 26, 3, String(), [](size_t i) {
+        return String(static_cast<char>('a' + i));
+    }, [](String a, const String &b) {
+        return a += b;
+    });
+    REQUIRE(text == "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST_CASE("parallelReduce over array elements and empty range", "[parallel]") {
+    ThreadPool pool(2);
+    Array<int32_t> values;
+
+    for (int32_t i = 0; i < 500; ++i) {
+        values.push(i % 37);
+    }
+    const auto best = parallelReduce(pool, values, 10, 0, [](const int32_t &value) {
+        return value;
+    }, [](int32_t a, int32_t b) {
+        return cr::max(a, b);
+    });
+    REQUIRE(best == 36);
+
+    Array<int32_t> empty;
+    REQUIRE(parallelReduce(pool, empty, 0, -1, [](const int32_t &value) { return value; }, [](int32_t a, int32_t b) { return a + b; }) == -1);
+}
@@ -0,0 +1,202 @@
+// test_pool.cpp — tests for crlib/pool.h (ObjectPool, pooled UniquePtr)
+#include <crlib/crlib.h>
+#include "catch2/catch_amalgamated.hpp"
+
+using namespace cr;
+
+namespace {
+    struct Counted {
+        static inline int alive = 0;
+        int value;
+
+        explicit Counted(int v) : value(v) { ++alive; }
+        ~Counted() { --alive; }
+    };
+}
+
+// ---------------------------------------------------------------------------
+// ObjectPool — acquire / recycle
+// ---------------------------------------------------------------------------
+TEST_CASE("ObjectPool acquire constructs and recycle destroys", "[pool]") {
+    ObjectPool<Counted> pool;
+
+    auto a = pool.acquire(1);
+    auto b = pool.acquire(2);
+    REQUIRE(Counted::alive == 2);
+    REQUIRE(a->value == 1);
+    REQUIRE(b->value == 2);
+    REQUIRE(a != b);
+
+    pool.recycle(a);
+    pool.recycle(b);
+    pool.recycle(nullptr);
+    REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("ObjectPool reuses recycled memory", "[pool]") {
+    ObjectPool<int> pool;
+
+    auto first = pool.acquire(10);
+    pool.recycle(first);
+
+    auto second = pool.acquire(20);
+    REQUIRE(second == first);
+    REQUIRE(*second == 20);
+    pool.recycle(second);
+}
+
+TEST_CASE("ObjectPool grows by whole slabs", "[pool]") {
+    ObjectPool<int, PoolPolicy::Local, 16> pool;
+    REQUIRE(pool.capacity() == 0u);
+
+    Array<int *> objects;
+    for (int i = 0; i < 40; ++i) {
+        objects.push(pool.acquire(i));
+    }
+    REQUIRE(pool.capacity() == 48u);
+
+    for (int i = 0; i < 40; ++i) {
+        REQUIRE(*objects[i] == i);
+        pool.recycle(objects[i]);
+    }
+    pool.reserve(100);
+    REQUIRE(pool.capacity() == 112u);
+}
+
+// ---------------------------------------------------------------------------
+// Pooled UniquePtr
+// ---------------------------------------------------------------------------
+TEST_CASE("Pooled pointer recycles the object on destruction", "[pool]") {
+    ObjectPool<Counted> pool;
+    {
+        auto ptr = pool.make(5);
+        REQUIRE(ptr);
+        REQUIRE(ptr->value == 5);
+        REQUIRE(Counted::alive == 1);
+
+        PooledPtr<Counted> moved = cr::move(ptr);
+        REQUIRE_FALSE(ptr);
+        REQUIRE(moved->value == 5);
+    }
+    REQUIRE(Counted::alive == 0);
+
+    auto again = makePooled(pool, 7);
+    again.reset();
+    REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("Default UniquePtr deleter keeps pointer size", "[pool]") {
+    REQUIRE(sizeof(UniquePtr<int>) == sizeof(int *));
+    REQUIRE(sizeof(UniquePtr<int[]>) == sizeof(int *));
+}
+
+// ---------------------------------------------------------------------------
+// Shared / cached pools used from many threads
+// ---------------------------------------------------------------------------
+template <PoolPolicy P> static void stressPool() {
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 20000;
+
+    ObjectPool<int, P> pool;
+    Array<Thread> threads;
+
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace([&pool, t]() {
+            Array<PooledPtr<int, P>> held;
+
+            for (int i = 0; i < kIterations; ++i) {
+                held.push(pool.make(t * kIterations + i));
+
+                if (held.length() > 50) {
+                    held.clear();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    REQUIRE(pool.capacity() < static_cast<size_t>(kThreads * 200));
+}
+
+TEST_CASE("Shared ObjectPool works across threads", "[pool]") {
+    stressPool<PoolPolicy::Shared>();
+}
+
+TEST_CASE("Cached ObjectPool works across threads", "[pool]") {
+    stressPool<PoolPolicy::Cached>();
+}
+
+TEST_CASE("Cached ObjectPool passes objects between threads", "[pool]") {
+    ObjectPool<int, PoolPolicy::Cached> pool;
+    Array<int *> objects;
+
+    for (int i = 0; i < 100; ++i) {
+        objects.push(pool.acquire(i));
+    }
+    Thread releaser([&]() {
+        for (auto &object : objects) {
+            pool.recycle(object);
+        }
+    });
+    releaser.join();
+
+    for (int i = 0; i < 100; ++i) {
+        pool.recycle(pool.acquire(i));
+    }
+    REQUIRE(pool.capacity() <= 256u);
+}
+
+TEST_CASE("Cached ObjectPool takes over thread cache of a pool destroyed elsewhere", "[pool]") {
+    struct Item {
+        int value;
+    };
+    using Pool = ObjectPool<Item, PoolPolicy::Cached, 4>;
+
+    // claims this thread's cache, then dies on another thread, so the cache isn't released right away
+    auto dead = makeUnique<Pool>();
+    dead->recycle(dead->acquire(Item { 1 }));
+
+    Thread destroyer([&dead]() {
+        dead.reset();
+    });
+    destroyer.join();
+
+    // caching pool refills half of the cache at once, uncached one carves just a single slab
+    Pool pool;
+    auto item = pool.acquire(Item { 2 });
+
+    REQUIRE(item->value == 2);
+    REQUIRE(pool.capacity() > 4u);
+
+    pool.recycle(item);
+}
+
+TEST_CASE("Cached ObjectPool gets objects back from caches of exited threads", "[pool]") {
+    struct Item {
+        int value;
+    };
+    ObjectPool<Item, PoolPolicy::Cached, 4> pool;
+
+    // every thread fills its own cache, and exits with it still full
+    auto churn = [&pool]() {
+        Array<Item *> items;
+
+        for (int i = 0; i < 32; ++i) {
+            items.push(pool.acquire(Item { i }));
+        }
+        for (auto &item : items) {
+            pool.recycle(item);
+        }
+    };
+    Thread first(churn);
+    first.join();
+
+    const size_t capacity = pool.capacity();
+
+    for (int round = 0; round < 20; ++round) {
+        Thread thread(churn);
+        thread.join();
+    }
+    REQUIRE(pool.capacity() == capacity);
+}
@@ -756,11 +756,99 @@ TEST_CASE("String empty chars returns valid pointer", "[string]") {
 // ---------------------------------------------------------------------------
 TEST_CASE("String capacity returns allocated buffer size", "[string]") {
     String s;
-    REQUIRE(s.capacity() == 0u);
+    REQUIRE(s.capacity() == String::kInlineCapacity + 1);
     s = "hello";
     REQUIRE(s.capacity() >= 5u);
 }
 
+// ---------------------------------------------------------------------------
+// String small buffer optimization
+// ---------------------------------------------------------------------------
+TEST_CASE("String keeps short strings inline", "[string]") {
+    REQUIRE(sizeof(String) == 3 * sizeof(size_t));
+    REQUIRE(String::kInlineCapacity == sizeof(String) - 2);
+
+    const auto longest = String("abcdefghijklmnopqrstuvwxyz").substr(0, String::kInlineCapacity);
+
+    REQUIRE(longest.length() == String::kInlineCapacity);
+    REQUIRE(longest.capacity() == String::kInlineCapacity + 1);
+    REQUIRE(longest.chars()[String::kInlineCapacity] == '\0');
+    REQUIRE(reinterpret_cast<const char *>(&longest) == longest.chars());
+}
+
+TEST_CASE("String moves to the heap past inline capacity and back on move", "[string]") {
+    String s;
+    for (size_t i = 0; i < 100; ++i) {
+        s.append(static_cast<char>('a' + i % 26));
+        REQUIRE(s.length() == i + 1);
+        REQUIRE(s.chars()[i + 1] == '\0');
+    }
+    REQUIRE(s.capacity() >= 101u);
+    REQUIRE(s.startsWith("abcdefghijklmnopqrstuvwxyzabc"));
+
+    String moved = cr::move(s);
+    REQUIRE(moved.length() == 100u);
+    REQUIRE(s.empty());
+    REQUIRE(s == "");
+
+    s = "short";
+    moved = cr::move(s);
+    REQUIRE(moved == "short");
+    REQUIRE(moved.capacity() == String::kInlineCapacity + 1);
+}
+
+TEST_CASE("String stays on the heap with capacities past 16 MiB", "[string]") {
+    const size_t length = (static_cast<size_t>(1) << 24) + 5;
+
+    Array<char> source(length, 'x');
+    String s(source.data(), length);
+    REQUIRE(s.length() == length);
+    REQUIRE(s.capacity() >= length + 1);
+    REQUIRE(s.chars()[length] == '\0');
+    REQUIRE(reinterpret_cast<const char *>(&s) != s.chars());
+
+    s.append("tail");
+    REQUIRE(s.length() == length + 4);
+    REQUIRE(s.capacity() >= length + 5);
+    REQUIRE(s.endsWith("xtail"));
+
+    String copy(s);
+    REQUIRE(copy.length() == length + 4);
+    REQUIRE(copy.capacity() >= length + 5);
+    REQUIRE(copy == s);
+}
+
+TEST_CASE("String copies and substrings of short strings stay inline", "[string]") {
+    String name("bot_name");
+    String copy(name);
+    String sub = name.substr(4);
+
+    REQUIRE(copy == "bot_name");
+    REQUIRE(sub == "name");
+    REQUIRE(copy.capacity() == String::kInlineCapacity + 1);
+    REQUIRE(sub.capacity() == String::kInlineCapacity + 1);
+
+    auto parts = String("a,bb,ccc").split(",");
+    REQUIRE(parts.length() == 3u);
+    REQUIRE(parts[2] == "ccc");
+    REQUIRE(parts[2].capacity() == String::kInlineCapacity + 1);
+}
+
+TEST_CASE("String handles appending and assigning its own contents", "[string]") {
+    String s("abc");
+    s.append(s);
+    REQUIRE(s == "abcabc");
+
+    for (int i = 0; i < 3; ++i) {
+        s.append(s.chars(), s.length());
+    }
+    REQUIRE(s.length() == 48u);
+    REQUIRE(s.endsWith("abcabc"));
+
+    s.assign(s.chars() + 45, 3u);
+    REQUIRE(s == "abc");
+}
+
 TEST_CASE("String resize increases capacity when needed", "[string]") {
     String s("hello");
     size_t oldCapacity = s.capacity();
@@ -551,3 +551,700 @@ TEST_CASE("ThreadPool thread safety of public methods", "[thread]") {
     pool.shutdown();
     REQUIRE(enqueueCount == 40); // 4 clients * 10 tasks each
 }
+
+// ---------------------------------------------------------------------------
+// WorkStealingDeque
+// ---------------------------------------------------------------------------
+TEST_CASE("WorkStealingDeque pop is lifo and steal is fifo", "[thread]") {
+    WorkStealingDeque<intptr_t> deque;
+
+    for (intptr_t i = 1; i <= 3; ++i) {
+        deque.push(i);
+    }
+    REQUIRE(deque.length() == 3);
+
+    intptr_t item = 0;
+    REQUIRE(deque.pop(item));
+    REQUIRE(item == 3);
+
+    REQUIRE(deque.steal(item));
+    REQUIRE(item == 1);
+
+    REQUIRE(deque.pop(item));
+    REQUIRE(item == 2);
+
+    REQUIRE_FALSE(deque.pop(item));
+    REQUIRE_FALSE(deque.steal(item));
+    REQUIRE(deque.empty());
+}
+
+TEST_CASE("WorkStealingDeque grows past initial capacity", "[thread]") {
+    WorkStealingDeque<intptr_t> deque;
+    const intptr_t count = 1000;
+
+    for (intptr_t i = 0; i < count; ++i) {
+        deque.push(i);
+    }
+    REQUIRE(deque.length() == static_cast<size_t>(count));
+
+    for (intptr_t i = count - 1; i >= 0; --i) {
+        intptr_t item = -1;
+        REQUIRE(deque.pop(item));
+        REQUIRE(item == i);
+    }
+}
+
+TEST_CASE("WorkStealingDeque hands every item out exactly once under stealing", "[thread]") {
+    WorkStealingDeque<intptr_t> deque;
+    const intptr_t count = 20000;
+
+    Atomic<bool> done;
+    Atomic<int64_t> sum;
+    Atomic<int64_t> taken;
+    Array<Thread> thieves;
+
+    for (int i = 0; i < 3; ++i) {
+        thieves.emplace([&]() {
+            intptr_t item = 0;
+
+            while (!done.load() || !deque.empty()) {
+                if (deque.steal(item)) {
+                    sum.fetchAdd(item);
+                    taken.fetchAdd(1);
+                }
+            }
+        });
+    }
+    intptr_t item = 0;
+
+    for (intptr_t i = 1; i <= count; ++i) {
+        deque.push(i);
+
+        if (i % 3 == 0 && deque.pop(item)) {
+            sum.fetchAdd(item);
+            taken.fetchAdd(1);
+        }
+    }
+    while (deque.pop(item)) {
+        sum.fetchAdd(item);
+        taken.fetchAdd(1);
+    }
+    done.store(true);
+
+    for (auto &t : thieves) {
+        t.join();
+    }
+    REQUIRE(taken.load() == count);
+    REQUIRE(sum.load() == count * (count + 1) / 2);
+}
+
+// ---------------------------------------------------------------------------
+// ThreadPool — work stealing
+// ---------------------------------------------------------------------------
+TEST_CASE("ThreadPool runs jobs enqueued before startup", "[thread]") {
+    ThreadPool pool;
+    Atomic<int32_t> done;
+
+    for (int i = 0; i < 16; ++i) {
+        pool.enqueue([&done]() {
+            done.fetchAdd(1);
+        });
+    }
+    REQUIRE(pool.jobs() == 16);
+
+    pool.startup(2);
+    pool.shutdown();
+
+    REQUIRE(done.load() == 16);
+    REQUIRE(pool.jobs() == 0);
+}
+
+TEST_CASE("ThreadPool runs jobs enqueued from workers", "[thread]") {
+    Atomic<int32_t> done;
+    const int32_t parents = 8;
+    const int32_t children = 64;
+
+    {
+        ThreadPool pool(4);
+
+        for (int32_t i = 0; i < parents; ++i) {
+            pool.enqueue([&pool, &done]() {
+                for (int32_t j = 0; j < children; ++j) {
+                    pool.enqueue([&done]() {
+                        done.fetchAdd(1);
+                    });
+                }
+            });
+        }
+
+        while (done.load() != parents * children) {
+            testSleep(1);
+        }
+    }
+    REQUIRE(done.load() == parents * children);
+}
+
+TEST_CASE("ThreadPool shutdown drains pending jobs", "[thread]") {
+    Atomic<int32_t> done;
+    ThreadPool pool(3);
+
+    for (int i = 0; i < 1000; ++i) {
+        pool.enqueue([&done]() {
+            done.fetchAdd(1);
+        });
+    }
+    pool.shutdown();
+
+    REQUIRE(done.load() == 1000);
+    REQUIRE(pool.threadCount() == 0);
+}
+
+TEST_CASE("ThreadPool startup on running pool restarts it", "[thread]") {
+    Atomic<int32_t> done;
+    ThreadPool pool(2);
+
+    pool.startup(3);
+    REQUIRE(pool.threadCount() == 3);
+
+    for (int i = 0; i < 100; ++i) {
+        pool.enqueue([&done]() {
+            done.fetchAdd(1);
+        });
+    }
+    pool.shutdown();
+    REQUIRE(done.load() == 100);
+}
+
+TEST_CASE("ThreadPool runs move-only jobs", "[thread]") {
+    ThreadPool pool(2);
+    Atomic<int32_t> sum;
+
+    for (int32_t i = 0; i < 100; ++i) {
+        auto value = makeUnique<int32_t>(i);
+
+        pool.enqueue([value = cr::move(value), &sum]() {
+            sum.fetchAdd(*value);
+        });
+    }
+    auto owned = makeUnique<int32_t>(7);
+
+    auto future = pool.submit([owned = cr::move(owned)]() {
+        return *owned * 6;
+    });
+    REQUIRE(future.get() == 42);
+
+    pool.shutdown();
+    REQUIRE(sum.load() == 4950);
+}
+
+TEST_CASE("ThreadPool and TaskGroup run mutable move-only jobs", "[thread]") {
+    ThreadPool pool(2);
+
+    auto counter = pool.submit([c = 0]() mutable {
+        return ++c;
+    });
+    REQUIRE(counter.get() == 1);
+
+    auto future = pool.submit([owned = makeUnique<int32_t>(20)]() mutable {
+        *owned += 1;
+        return *owned * 2;
+    });
+    REQUIRE(future.get() == 42);
+
+    Atomic<int32_t> sum;
+    {
+        TaskGroup group(pool);
+
+        for (int32_t i = 0; i < 10; ++i) {
+            group.run([value = makeUnique<int32_t>(i), &sum]() mutable {
+                *value *= 2;
+                sum.fetchAdd(*value);
+            });
+        }
+        group.wait();
+    }
+    pool.shutdown();
+    REQUIRE(sum.load() == 90);
+}
+
+TEST_CASE("ThreadPool recycles job nodes across many rounds", "[thread]") {
+    ThreadPool pool(3);
+    Atomic<int32_t> done;
+    String text("long enough to live on the heap, so the job has a destructor to run");
+
+    for (int32_t round = 0; round < 20; ++round) {
+        for (int32_t i = 0; i < 500; ++i) {
+            pool.enqueue([text, &done]() {
+                done.fetchAdd(text.empty() ? 0 : 1);
+            });
+        }
+
+        while (pool.jobs() != 0) {
+            pool.runPending();
+        }
+    }
+    pool.shutdown();
+    REQUIRE(done.load() == 20 * 500);
+}
+
+// ---------------------------------------------------------------------------
+// Future / submit
+// ---------------------------------------------------------------------------
+TEST_CASE("ThreadPool submit returns value through future", "[thread]") {
+    ThreadPool pool(2);
+
+    auto future = pool.submit([]() {
+        return 6 * 7;
+    });
+    REQUIRE(future.valid());
+    REQUIRE(future.get() == 42);
+    REQUIRE(future.ready());
+}
+
+TEST_CASE("ThreadPool submit works with void jobs and non-trivial results", "[thread]") {
+    ThreadPool pool(2);
+    Atomic<int32_t> ran;
+
+    auto done = pool.submit([&ran]() {
+        ran.store(1);
+    });
+    done.wait();
+    REQUIRE(ran.load() == 1);
+
+    auto text = pool.submit([]() {
+        return String("a string long enough to live on the heap");
+    });
+    REQUIRE(text.get() == "a string long enough to live on the heap");
+}
+
+TEST_CASE("Future of pool without workers runs job on waiting thread", "[thread]") {
+    ThreadPool pool;
+
+    auto future = pool.submit([]() {
+        return 5;
+    });
+    REQUIRE_FALSE(future.ready());
+    REQUIRE(future.get() == 5);
+    REQUIRE(pool.jobs() == 0);
+}
+
+TEST_CASE("Future dropped before completion does not leak or crash", "[thread]") {
+    ThreadPool pool(1);
+
+    for (int i = 0; i < 100; ++i) {
+        auto future = pool.submit([i]() {
+            return String().assignf("%d", i);
+        });
+        (void)future;
+    }
+    pool.shutdown();
+    REQUIRE(pool.jobs() == 0);
+}
+
+TEST_CASE("Future is movable", "[thread]") {
+    ThreadPool pool(1);
+
+    Future<int> moved;
+    REQUIRE_FALSE(moved.valid());
+
+    auto future = pool.submit([]() {
+        return 3;
+    });
+    moved = cr::move(future);
+
+    REQUIRE_FALSE(future.valid());
+    REQUIRE(moved.get() == 3);
+}
+
+// ---------------------------------------------------------------------------
+// TaskGroup
+// ---------------------------------------------------------------------------
+TEST_CASE("TaskGroup wait joins all jobs", "[thread]") {
+    ThreadPool pool(3);
+    TaskGroup group(pool);
+    Atomic<int32_t> done;
+
+    for (int i = 0; i < 500; ++i) {
+        group.run([&done]() {
+            done.fetchAdd(1);
+        });
+    }
+    group.wait();
+
+    REQUIRE(group.done());
+    REQUIRE(group.pending() == 0);
+    REQUIRE(done.load() == 500);
+}
+
+TEST_CASE("TaskGroup jobs may run nested jobs in the same group", "[thread]") {
+    ThreadPool pool(2);
+    TaskGroup group(pool);
+    Atomic<int32_t> done;
+
+    for (int i = 0; i < 10; ++i) {
+        group.run([&group, &done]() {
+            for (int j = 0; j < 10; ++j) {
+                group.run([&done]() {
+                    done.fetchAdd(1);
+                });
+            }
+        });
+    }
+    group.wait();
+    REQUIRE(done.load() == 100);
+}
+
+TEST_CASE("TaskGroup can be reused after wait and works without workers", "[thread]") {
+    ThreadPool pool;
+    TaskGroup group(pool);
+    int32_t done = 0;
+
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int i = 0; i < 10; ++i) {
+            group.run([&done]() {
+                ++done;
+            });
+        }
+        group.wait();
+        REQUIRE(done == (frame + 1) * 10);
+    }
+}
+
+TEST_CASE("TaskGroup waited from inside pool job does not deadlock", "[thread]") {
+    ThreadPool pool(1);
+
+    auto total = pool.submit([&pool]() {
+        TaskGroup inner(pool);
+        Atomic<int32_t> sum;
+
+        for (int i = 1; i <= 10; ++i) {
+            inner.run([&sum, i]() {
+                sum.fetchAdd(i);
+            });
+        }
+        inner.wait();
+        return sum.load();
+    });
+    REQUIRE(total.get() == 55);
+}
+
+// ---------------------------------------------------------------------------
+// SpinLock / AdaptiveMutex / SharedMutex
+// ---------------------------------------------------------------------------
+namespace {
+    template <typename Lock> int32_t hammerLock(Lock &lock) {
+        int32_t counter = 0;
+        Array<Thread> threads;
+
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace([&lock, &counter]() {
+                for (int j = 0; j < 20000; ++j) {
+                    ScopedLock<Lock> guard(lock);
+                    ++counter;
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        return counter;
+    }
+}
+
+TEST_CASE("SpinLock tryLock fails while held", "[thread]") {
+    SpinLock lock;
+
+    REQUIRE(lock.tryLock());
+    REQUIRE_FALSE(lock.tryLock());
+    lock.unlock();
+
+    {
+        SpinScopedLock guard(lock);
+        REQUIRE_FALSE(lock.tryLock());
+    }
+    REQUIRE(lock.tryLock());
+    lock.unlock();
+}
+
+TEST_CASE("SpinLock provides mutual exclusion", "[thread]") {
+    SpinLock lock;
+    REQUIRE(hammerLock(lock) == 80000);
+}
+
+TEST_CASE("AdaptiveMutex provides mutual exclusion", "[thread]") {
+    AdaptiveMutex lock;
+    REQUIRE(hammerLock(lock) == 80000);
+
+    REQUIRE(lock.tryLock());
+    lock.unlock();
+}
+
+TEST_CASE("SharedMutex exclusive lock provides mutual exclusion", "[thread]") {
+    SharedMutex lock;
+    REQUIRE(hammerLock(lock) == 80000);
+}
+
+TEST_CASE("SharedMutex allows many readers but no writer alongside them", "[thread]") {
+    SharedMutex lock;
+
+    lock.lockShared();
+    REQUIRE(lock.tryLockShared());
+    REQUIRE_FALSE(lock.tryLock());
+
+    lock.unlockShared();
+    lock.unlockShared();
+
+    REQUIRE(lock.tryLock());
+    REQUIRE_FALSE(lock.tryLockShared());
+    lock.unlock();
+}
+
+TEST_CASE("ScopedSharedLock readers see consistent state written under exclusive lock", "[thread]") {
+    SharedMutex lock;
+    int32_t a = 0, b = 0;
+    Atomic<int32_t> torn;
+    Array<Thread> threads;
+
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace([&]() {
+            for (int j = 0; j < 20000; ++j) {
+                ScopedSharedLock<SharedMutex> guard(lock);
+
+                if (a != b) {
+                    torn.fetchAdd(1);
+                }
+            }
+        });
+    }
+    threads.emplace([&]() {
+        for (int j = 0; j < 20000; ++j) {
+            ScopedLock<SharedMutex> guard(lock);
+            ++a;
+            ++b;
+        }
+    });
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(torn.load() == 0);
+    REQUIRE(a == 20000);
+}
+
+// ---------------------------------------------------------------------------
+// Thread options
+// ---------------------------------------------------------------------------
+namespace {
+    String currentThreadName() {
+#if defined(CR_LINUX)
+        char name[32] {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        return name;
+#else
+        return "";
+#endif
+    }
+}
+
+TEST_CASE("Thread applies name from options", "[thread]") {
+    String seen;
+    char name[32] = "crlib-named";
+
+    ThreadOptions options;
+    options.name = name;
+
+    Thread thread([&seen]() {
+        seen = currentThreadName();
+    }, options);
+
+    // the name is copied at start
+    name[0] = '\0';
+    thread.join();
+
+#if defined(CR_LINUX)
+    REQUIRE(seen == "crlib-named");
+#endif
+}
+
+TEST_CASE("Thread runs with custom stack size", "[thread]") {
+    ThreadOptions options;
+    options.stackSize = 1024 * 1024;
+
+    int32_t depth = 0;
+    Thread thread([&depth]() {
+        volatile uint8_t block[256 * 1024] {};
+        block[0] = 1;
+        depth = block[0];
+    }, options);
+    thread.join();
+
+    REQUIRE(depth == 1);
+}
+
+TEST_CASE("Thread applies affinity and lower priority", "[thread]") {
+    ThreadOptions options;
+    options.affinity = 1;
+    options.priority = ThreadPriority::Low;
+
+#if defined(CR_LINUX)
+    // pin to the first cpu, process is allowed to run on
+    cpu_set_t allowed;
+    REQUIRE(sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+
+    for (uint64_t cpu = 0; cpu < 64; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            options.affinity = static_cast<uint64_t>(1) << cpu;
+            break;
+        }
+    }
+#endif
+
+    bool configured = false;
+    Thread thread([&configured, &options]() {
+        configured = Thread::configure(options);
+    }, options);
+    thread.join();
+
+#if defined(CR_LINUX) || defined(CR_WINDOWS)
+    REQUIRE(configured);
+#endif
+}
+
+TEST_CASE("ThreadPool names workers with their index", "[thread]") {
+    ThreadOptions options;
+    options.name = "crlib-pool";
+
+    ThreadPool pool(2, options);
+    REQUIRE(pool.threadCount() == 2);
+
+    auto name = pool.submit([]() {
+        return currentThreadName();
+    });
+    auto seen = name.get();
+
+#if defined(CR_LINUX)
+    // may also run on this thread while it waits
+    REQUIRE((seen == "crlib-pool-0" || seen == "crlib-pool-1" || seen == currentThreadName()));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// ThreadPool — delayed and periodic jobs
+// ---------------------------------------------------------------------------
+TEST_CASE("ThreadPool enqueueAfter runs job once delay has passed", "[thread]") {
+    ThreadPool pool(2);
+    Atomic<uint64_t> ranAt;
+
+    const auto start = plat.monotonicMillis();
+    auto job = pool.enqueueAfter(50, [&ranAt]() {
+        ranAt.store(plat.monotonicMillis());
+    });
+    REQUIRE(job.valid());
+    REQUIRE(pool.scheduled() == 1);
+
+    while (job.runs() == 0) {
+        testSleep(1);
+    }
+    REQUIRE(ranAt.load() >= start + 50);
+    REQUIRE(pool.scheduled() == 0);
+}
+
+TEST_CASE("ThreadPool enqueueAt runs jobs in deadline order", "[thread]") {
+    ThreadPool pool(1);
+    Mutex m;
+    Array<int32_t> order;
+
+    const auto now = plat.monotonicMillis();
+    Array<ScheduledJob> jobs;
+
+    for (int32_t i : { 3, 1, 2 }) {
+        jobs.push(pool.enqueueAt(now + static_cast<uint64_t>(i) * 20, [&m, &order, i]() {
+            MutexScopedLock lock(m);
+            order.push(i);
+        }));
+    }
+
+    for (auto &job : jobs) {
+        while (job.runs() == 0) {
+            testSleep(1);
+        }
+    }
+    REQUIRE(order.length() == 3);
+    REQUIRE(order[0] == 1);
+    REQUIRE(order[1] == 2);
+    REQUIRE(order[2] == 3);
+}
+
+TEST_CASE("ThreadPool cancelled delayed job never runs", "[thread]") {
+    ThreadPool pool(1);
+    Atomic<int32_t> ran;
+
+    auto job = pool.enqueueAfter(30, [&ran]() {
+        ran.store(1);
+    });
+    job.cancel();
+    REQUIRE(job.cancelled());
+
+    testSleep(80);
+    REQUIRE(ran.load() == 0);
+    REQUIRE(job.runs() == 0);
+}
+
+TEST_CASE("ThreadPool enqueueEvery repeats until cancelled", "[thread]") {
+    ThreadPool pool(2);
+    Atomic<int32_t> ticks;
+
+    auto job = pool.enqueueEvery(5, [&ticks]() {
+        ticks.fetchAdd(1);
+    });
+
+    while (job.runs() < 3) {
+        testSleep(1);
+    }
+    job.cancel();
+
+    // a run may be in flight while cancelling, after that nothing more starts
+    testSleep(20);
+    const auto stopped = ticks.load();
+
+    testSleep(50);
+    REQUIRE(ticks.load() == stopped);
+    REQUIRE(stopped >= 3);
+}
+
+TEST_CASE("ThreadPool delayed job handle may be dropped and pool shut down early", "[thread]") {
+    Atomic<int32_t> ran;
+    {
+        ThreadPool pool(1);
+
+        pool.enqueueAfter(10, [&ran]() {
+            ran.fetchAdd(1);
+        });
+        pool.enqueueAfter(60000, [&ran]() {
+            ran.fetchAdd(100);
+        });
+        pool.enqueueEvery(5, [&ran]() {
+            ran.fetchAdd(0);
+        });
+
+        while (ran.load() == 0) {
+            testSleep(1);
+        }
+    }
+    // job far in the future was dropped with the pool
+    REQUIRE(ran.load() == 1);
+}
+
+TEST_CASE("ThreadPool delayed jobs reach pool without workers through helping", "[thread]") {
+    ThreadPool pool;
+    Atomic<int32_t> ran;
+
+    auto job = pool.enqueueAfter(5, [&ran]() {
+        ran.store(1);
+    });
+
+    pool.helpUntil([&ran]() {
+        return ran.load() == 1;
+    });
+    REQUIRE(job.runs() == 1);
+}
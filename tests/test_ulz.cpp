@@ -321,3 +321,682 @@ TEST_CASE("ULZ uncompress with exact match at end of buffer", "[ulz]") {
     REQUIRE(decompLen == 128);
     REQUIRE(memcmp(input, restored, 128) == 0);
 }
+
+// ---------------------------------------------------------------------------
+// Worst case bound
+// ---------------------------------------------------------------------------
+TEST_CASE("ULZ bound covers incompressible input", "[ulz]") {
+    const int32_t dataLen = 100000;
+    Array<uint8_t> input(static_cast<size_t>(dataLen), 0);
+    Array<uint8_t> compressed(static_cast<size_t>(ULZ::bound(dataLen)), 0);
+
+    uint32_t seed = 7;
+    for (auto &byte : input) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(seed >> 24);
+    }
+    const auto compLen = ULZ::instance().compress(input.data(), dataLen, compressed.data());
+
+    REQUIRE(compLen > dataLen);
+    REQUIRE(compLen <= ULZ::bound(dataLen));
+}
+
+// ---------------------------------------------------------------------------
+// Framed stream (ULZEncoder / ULZDecoder)
+// ---------------------------------------------------------------------------
+static Array<uint8_t> makeStreamContent(size_t length, bool compressible) {
+    Array<uint8_t> data(length, 0);
+    uint32_t seed = 12345;
+
+    for (size_t i = 0; i < length; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const auto noise = static_cast<uint8_t>(seed >> 24);
+
+        // text with a typo now and then, like real level data, compresses a few times
+        data[i] = compressible && noise > 8 ? static_cast<uint8_t>("navmesh graph data "[i % 19]) : noise;
+    }
+    return data;
+}
+
+static Array<uint8_t> encodeStream(const Array<uint8_t> &content, const ULZStreamOptions &options, size_t chunk) {
+    Array<uint8_t> stream;
+
+    ULZEncoder encoder([&stream](const uint8_t *data, size_t length) {
+        stream.insert(stream.length(), data, length);
+        return true;
+    }, options);
+
+    for (size_t offset = 0; offset < content.length(); offset += chunk) {
+        REQUIRE(encoder.write(content.data() + offset, cr::min(chunk, content.length() - offset)));
+    }
+    REQUIRE(encoder.finish());
+    REQUIRE(encoder.consumed() == content.length());
+    REQUIRE(encoder.produced() == stream.length());
+
+    return stream;
+}
+
+// reader, that hands out at most step bytes at a time, like a socket or a pipe would
+static ULZDecoder::Reader streamReader(const Array<uint8_t> &stream, size_t &position, size_t step) {
+    return [&stream, &position, step](uint8_t *data, size_t length) {
+        const auto count = cr::min(cr::min(length, step), stream.length() - position);
+        memcpy(data, stream.data() + position, count);
+        position += count;
+
+        return count;
+    };
+}
+
+static Array<uint8_t> decodeStream(ULZDecoder &decoder, size_t chunk) {
+    Array<uint8_t> content;
+    Array<uint8_t> buffer(chunk, 0);
+
+    for (size_t got; (got = decoder.read(buffer.data(), chunk)) > 0;) {
+        content.insert(content.length(), buffer.data(), got);
+    }
+    return content;
+}
+
+TEST_CASE("ULZ stream round-trips content in chunks of any size", "[ulz]") {
+    const auto content = makeStreamContent(100000, true);
+
+    ULZStreamOptions options;
+    options.blockSize = 4096;
+
+    for (size_t writeChunk : { 1u, 333u, 4096u, 10000u, 100000u }) {
+        const auto stream = encodeStream(content, options, writeChunk);
+        REQUIRE(stream.length() < content.length() / 2);
+
+        for (size_t readChunk : { 7u, 4096u, 65536u }) {
+            size_t position = 0;
+            ULZDecoder decoder(streamReader(stream, position, 1000));
+
+            const auto restored = decodeStream(decoder, readChunk);
+
+            REQUIRE(decoder.finished());
+            REQUIRE(restored.length() == content.length());
+            REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+        }
+    }
+}
+
+TEST_CASE("ULZ stream stores incompressible blocks as is", "[ulz]") {
+    const auto content = makeStreamContent(50000, false);
+
+    ULZStreamOptions options;
+    options.blockSize = 8192;
+
+    const auto stream = encodeStream(content, options, 50000);
+    REQUIRE(stream.length() <= content.length() + 64);
+
+    size_t position = 0;
+    ULZDecoder decoder(streamReader(stream, position, stream.length()));
+    const auto restored = decodeStream(decoder, 1000);
+
+    REQUIRE(decoder.finished());
+    REQUIRE(restored.length() == content.length());
+    REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+}
+
+TEST_CASE("ULZ stream of empty content", "[ulz]") {
+    Array<uint8_t> empty;
+    const auto stream = encodeStream(empty, {}, 1);
+
+    size_t position = 0;
+    ULZDecoder decoder(streamReader(stream, position, 64));
+    uint8_t buffer[16];
+
+    REQUIRE(decoder.read(buffer, sizeof(buffer)) == 0);
+    REQUIRE(decoder.finished());
+}
+
+TEST_CASE("ULZ stream declares and verifies content size", "[ulz]") {
+    const auto content = makeStreamContent(20000, true);
+
+    ULZStreamOptions options;
+    options.contentSize = content.length();
+
+    const auto stream = encodeStream(content, options, 3000);
+
+    size_t position = 0;
+    ULZDecoder decoder(streamReader(stream, position, 512));
+    REQUIRE(decoder.contentSize() == content.length());
+
+    const auto restored = decodeStream(decoder, 4096);
+    REQUIRE(decoder.finished());
+    REQUIRE(restored.length() == content.length());
+
+    // encoder refuses to finish, when declared size doesn't match
+    Array<uint8_t> sink;
+    ULZEncoder encoder([&sink](const uint8_t *data, size_t length) {
+        sink.insert(sink.length(), data, length);
+        return true;
+    }, options);
+
+    REQUIRE(encoder.write(content.data(), 100));
+    REQUIRE_FALSE(encoder.finish());
+    REQUIRE(encoder.failed());
+}
+
+TEST_CASE("ULZ stream detects corruption and truncation", "[ulz]") {
+    const auto content = makeStreamContent(30000, true);
+
+    ULZStreamOptions options;
+    options.blockSize = 4096;
+
+    const auto stream = encodeStream(content, options, 30000);
+
+    SECTION("flipped content byte fails checksum or decoding") {
+        Array<uint8_t> corrupted;
+        corrupted.insert(0, stream.data(), stream.length());
+        corrupted[stream.length() / 2] ^= 0x5a;
+
+        size_t position = 0;
+        ULZDecoder decoder(streamReader(corrupted, position, 4096));
+        decodeStream(decoder, 4096);
+
+        REQUIRE(decoder.failed());
+        REQUIRE_FALSE(decoder.finished());
+    }
+
+    SECTION("truncated stream fails") {
+        Array<uint8_t> truncated;
+        truncated.insert(0, stream.data(), stream.length() - 3);
+
+        size_t position = 0;
+        ULZDecoder decoder(streamReader(truncated, position, 4096));
+        decodeStream(decoder, 4096);
+
+        REQUIRE(decoder.failed());
+    }
+
+    SECTION("wrong magic fails") {
+        Array<uint8_t> wrong;
+        wrong.insert(0, stream.data(), stream.length());
+        wrong[0] = 'X';
+
+        size_t position = 0;
+        ULZDecoder decoder(streamReader(wrong, position, 4096));
+        uint8_t buffer[64];
+
+        REQUIRE(decoder.read(buffer, sizeof(buffer)) == 0);
+        REQUIRE(decoder.failed());
+    }
+}
+
+TEST_CASE("ULZ stream goes through File and MemFile", "[ulz]") {
+    const char *fname = "crlib_test_ulz_stream.tmp";
+    const auto content = makeStreamContent(300000, true);
+
+    {
+        File out(fname, "wb");
+        REQUIRE(out);
+
+        ULZStreamOptions options;
+        options.blockSize = 65536;
+
+        ULZEncoder encoder(out, options);
+
+        for (size_t offset = 0; offset < content.length(); offset += 10000) {
+            REQUIRE(encoder.write(content.data() + offset, cr::min<size_t>(10000, content.length() - offset)));
+        }
+        REQUIRE(encoder.finish());
+    }
+
+    {
+        File in(fname, "rb");
+        REQUIRE(in);
+
+        ULZDecoder decoder(in);
+        const auto restored = decodeStream(decoder, 8192);
+
+        REQUIRE(decoder.finished());
+        REQUIRE(restored.length() == content.length());
+        REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+    }
+
+    {
+        MemFileStorage::instance().initialize(MemFileStorage::defaultLoad, MemFileStorage::defaultUnload);
+
+        MemFile in(fname);
+        REQUIRE(in);
+
+        ULZDecoder decoder(in);
+        const auto restored = decodeStream(decoder, 100000);
+
+        REQUIRE(decoder.finished());
+        REQUIRE(restored.length() == content.length());
+        REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+    }
+    plat.removeFile(fname);
+}
+
+static void requireSame(const Array<uint8_t> &restored, const Array<uint8_t> &content) {
+    REQUIRE(restored.length() == content.length());
+    REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+}
+
+TEST_CASE("ULZ parallel round-trips content on any number of threads", "[ulz]") {
+    const auto content = makeStreamContent(300000, true);
+
+    ULZStreamOptions options;
+    options.blockSize = 16384;
+
+    for (size_t threads : { 0u, 1u, 4u }) {
+        ThreadPool pool;
+        pool.startup(threads);
+
+        Array<uint8_t> stream;
+        REQUIRE(ULZParallel::compress(pool, content.data(), content.length(), stream, options));
+        REQUIRE(stream.length() < content.length() / 2);
+
+        Array<uint8_t> restored;
+        REQUIRE(ULZParallel::uncompress(pool, stream.data(), stream.length(), restored));
+        requireSame(restored, content);
+
+        // indexed frame is an ordinary frame for sequential decoder
+        size_t position = 0;
+        ULZDecoder decoder(streamReader(stream, position, 1000));
+
+        requireSame(decodeStream(decoder, 5000), content);
+        REQUIRE(decoder.finished());
+        REQUIRE(decoder.contentSize() == content.length());
+
+        pool.shutdown();
+    }
+}
+
+TEST_CASE("ULZ parallel output doesn't depend on thread count", "[ulz]") {
+    const auto content = makeStreamContent(200000, true);
+
+    ULZStreamOptions options;
+    options.blockSize = 8192;
+
+    ThreadPool serial;
+    ThreadPool pool;
+    pool.startup(4);
+
+    Array<uint8_t> first, second;
+    REQUIRE(ULZParallel::compress(serial, content.data(), content.length(), first, options));
+    REQUIRE(ULZParallel::compress(pool, content.data(), content.length(), second, options));
+
+    REQUIRE(first.length() == second.length());
+    REQUIRE(memcmp(first.data(), second.data(), first.length()) == 0);
+
+    pool.shutdown();
+}
+
+TEST_CASE("ULZ parallel decodes frames with and without index", "[ulz]") {
+    const auto content = makeStreamContent(100000, true);
+
+    ThreadPool pool;
+    pool.startup(2);
+
+    ULZStreamOptions options;
+    options.blockSize = 4096;
+
+    for (bool index : { false, true }) {
+        for (size_t length : { 0u, 1u, 4096u, 50000u, 100000u }) {
+            Array<uint8_t> part;
+            part.insert(0, content.data(), length);
+
+            options.index = index;
+            const auto stream = encodeStream(part, options, 777);
+
+            Array<uint8_t> restored;
+            REQUIRE(ULZParallel::uncompress(pool, stream.data(), stream.length(), restored));
+            requireSame(restored, part);
+        }
+    }
+    pool.shutdown();
+}
+
+TEST_CASE("ULZ parallel stores incompressible blocks and combines checksums", "[ulz]") {
+    auto content = makeStreamContent(40000, false);
+    const auto text = makeStreamContent(40000, true);
+    content.insert(content.length(), text.data(), text.length());
+
+    ThreadPool pool;
+    pool.startup(3);
+
+    ULZStreamOptions options;
+    options.blockSize = 4096;
+
+    Array<uint8_t> stream;
+    REQUIRE(ULZParallel::compress(pool, content.data(), content.length(), stream, options));
+    REQUIRE(stream.length() < content.length());
+
+    // checksum combined from blocks matches the one computed over whole content
+    detail::ULZChecksum checksum;
+    checksum.update(content.data(), content.length());
+
+    size_t position = 0;
+    ULZDecoder decoder(streamReader(stream, position, 4096));
+
+    requireSame(decodeStream(decoder, 4096), content);
+    REQUIRE(decoder.finished());
+
+    const auto end = stream.length() - 8 - (content.length() + 4095) / 4096 * 12;
+    REQUIRE(detail::ULZFrame::get32(stream.data() + end - 4) == checksum.value());
+
+    pool.shutdown();
+}
+
+TEST_CASE("ULZ parallel detects corruption and truncation", "[ulz]") {
+    const auto content = makeStreamContent(60000, true);
+
+    ThreadPool pool;
+    pool.startup(2);
+
+    ULZStreamOptions options;
+    options.blockSize = 4096;
+
+    Array<uint8_t> stream;
+    REQUIRE(ULZParallel::compress(pool, content.data(), content.length(), stream, options));
+
+    Array<uint8_t> restored;
+
+    for (size_t length : { 0u, 5u, 13u, 100u, 5000u }) {
+        REQUIRE_FALSE(ULZParallel::uncompress(pool, stream.data(), cr::min(length, stream.length() - 1), restored));
+    }
+    REQUIRE_FALSE(ULZParallel::uncompress(pool, stream.data(), stream.length() - 1, restored));
+
+    // every byte of the frame matters, flipping any of them fails the decoding
+    for (size_t offset = 0; offset < stream.length(); offset += 97) {
+        stream[offset] ^= 0x5a;
+        REQUIRE_FALSE(ULZParallel::uncompress(pool, stream.data(), stream.length(), restored));
+        stream[offset] ^= 0x5a;
+    }
+    REQUIRE(ULZParallel::uncompress(pool, stream.data(), stream.length(), restored));
+    requireSame(restored, content);
+
+    pool.shutdown();
+}
+
+static Array<uint8_t> compressWith(ULZContext &context, const Array<uint8_t> &content, ULZLevel level = ULZLevel::Default) {
+    Array<uint8_t> packed(static_cast<size_t>(ULZContext::bound(static_cast<int32_t>(content.length()))), 0);
+    const auto length = context.compress(content.data(), static_cast<int32_t>(content.length()), packed.data(), level);
+
+    packed.resize(static_cast<size_t>(length));
+    return packed;
+}
+
+TEST_CASE("ULZ context reused for inputs of any size packs them like a fresh one", "[ulz]") {
+    ULZContext reused;
+
+    for (size_t length : { 200u, 300000u, 50u, 4096u, 7u, 140000u, 1u, 2000u }) {
+        const auto content = makeStreamContent(length, true);
+        const auto packed = compressWith(reused, content);
+
+        ULZContext fresh;
+        const auto expected = compressWith(fresh, content);
+
+        REQUIRE(packed.length() == expected.length());
+        REQUIRE(memcmp(packed.data(), expected.data(), packed.length()) == 0);
+
+        Array<uint8_t> restored(length, 0);
+        REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(length)) == static_cast<int32_t>(length));
+        REQUIRE(memcmp(restored.data(), content.data(), length) == 0);
+    }
+}
+
+TEST_CASE("ULZ context doesn't match against previous input", "[ulz]") {
+    ULZContext context;
+
+    // the second input is a copy of the first one, leftovers of the first must not turn into matches
+    const auto content = makeStreamContent(3000, false);
+    compressWith(context, content);
+
+    const auto packed = compressWith(context, content);
+    REQUIRE(packed.length() >= content.length());
+
+    Array<uint8_t> restored(content.length(), 0);
+    REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(content.length())) == static_cast<int32_t>(content.length()));
+    REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+}
+
+TEST_CASE("ULZ contexts compress concurrently on their own threads", "[ulz]") {
+    const auto content = makeStreamContent(100000, true);
+
+    ULZContext reference;
+    const auto expected = compressWith(reference, content);
+
+    ThreadPool pool;
+    pool.startup(4);
+
+    Array<int32_t> matched(8, 0);
+
+    parallelFor(pool, 0, matched.length(), 1, [&](size_t i) {
+        ULZContext context;
+
+        for (size_t round = 0; round < 3; ++round) {
+            const auto packed = compressWith(context, content);
+            matched[i] += packed.length() == expected.length() && memcmp(packed.data(), expected.data(), packed.length()) == 0;
+        }
+    });
+
+    for (const auto &count : matched) {
+        REQUIRE(count == 3);
+    }
+    pool.shutdown();
+}
+
+TEST_CASE("ULZ levels produce the same format and rank by ratio", "[ulz]") {
+    const auto content = makeStreamContent(200000, true);
+    ULZContext context;
+
+    size_t sizes[3] {};
+
+    for (auto level : { ULZLevel::Fast, ULZLevel::Default, ULZLevel::High }) {
+        Array<uint8_t> packed(static_cast<size_t>(ULZContext::bound(static_cast<int32_t>(content.length()))), 0);
+        const auto length = context.compress(content.data(), static_cast<int32_t>(content.length()), packed.data(), level);
+
+        REQUIRE(length > 0);
+        sizes[level] = static_cast<size_t>(length);
+
+        Array<uint8_t> restored(content.length(), 0);
+        REQUIRE(ULZContext::uncompress(packed.data(), length, restored.data(), static_cast<int32_t>(content.length())) == static_cast<int32_t>(content.length()));
+        REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+    }
+    REQUIRE(sizes[ULZLevel::Default] <= sizes[ULZLevel::Fast]);
+    REQUIRE(sizes[ULZLevel::High] < sizes[ULZLevel::Default]);
+}
+
+TEST_CASE("ULZ levels round-trip edge cases and stay within bound", "[ulz]") {
+    ULZContext context;
+
+    const Array<uint8_t> zeros(70000, 0);
+    const auto noise = makeStreamContent(70000, false);
+    const auto text = makeStreamContent(70000, true);
+
+    for (auto level : { ULZLevel::Fast, ULZLevel::Default, ULZLevel::High }) {
+        for (const auto *content : { &zeros, &noise, &text }) {
+            for (size_t length : { 0u, 1u, 3u, 4u, 5u, 17u, 300u, 70000u }) {
+                const auto inputLength = static_cast<int32_t>(length);
+
+                Array<uint8_t> packed(static_cast<size_t>(ULZContext::bound(inputLength)), 0);
+                const auto packedLength = context.compress(content->data(), inputLength, packed.data(), level);
+
+                REQUIRE(packedLength <= ULZContext::bound(inputLength));
+
+                Array<uint8_t> restored(length + 1, 0);
+                REQUIRE(ULZContext::uncompress(packed.data(), packedLength, restored.data(), inputLength) == inputLength);
+                REQUIRE(memcmp(restored.data(), content->data(), length) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("ULZ high level parses large inputs in windows without losing matches", "[ulz]") {
+    ULZContext context;
+    const auto noise = makeStreamContent(1000, false);
+
+    // period doesn't divide the window, so matches run across every window boundary
+    Array<uint8_t> content;
+    for (size_t i = 0; i < 300000; ++i) {
+        content.push(noise[i % noise.length()]);
+    }
+    const auto packed = compressWith(context, content, ULZLevel::High);
+
+    REQUIRE(packed.length() < 4000u);
+
+    Array<uint8_t> restored(content.length(), 0);
+    REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(content.length())) == static_cast<int32_t>(content.length()));
+    REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+
+    // literal run spanning several windows is emitted once, and stays within bound
+    const auto noisy = makeStreamContent(200000, false);
+    const auto packedNoise = compressWith(context, noisy, ULZLevel::High);
+
+    REQUIRE(packedNoise.length() <= static_cast<size_t>(ULZContext::bound(static_cast<int32_t>(noisy.length()))));
+
+    Array<uint8_t> restoredNoise(noisy.length(), 0);
+    REQUIRE(ULZContext::uncompress(packedNoise.data(), static_cast<int32_t>(packedNoise.length()), restoredNoise.data(), static_cast<int32_t>(noisy.length())) == static_cast<int32_t>(noisy.length()));
+    REQUIRE(memcmp(restoredNoise.data(), noisy.data(), noisy.length()) == 0);
+}
+
+TEST_CASE("ULZ stream and parallel frames honor compression level", "[ulz]") {
+    const auto content = makeStreamContent(100000, true);
+
+    ULZStreamOptions options;
+    options.blockSize = 16384;
+
+    ThreadPool pool;
+    pool.startup(2);
+
+    size_t defaultLength = 0;
+
+    for (auto level : { ULZLevel::Default, ULZLevel::High }) {
+        options.level = level;
+
+        const auto stream = encodeStream(content, options, 10000);
+
+        Array<uint8_t> frame;
+        REQUIRE(ULZParallel::compress(pool, content.data(), content.length(), frame, options));
+
+        size_t position = 0;
+        ULZDecoder decoder(streamReader(stream, position, 1000));
+
+        requireSame(decodeStream(decoder, 4096), content);
+        REQUIRE(decoder.finished());
+
+        Array<uint8_t> restored;
+        REQUIRE(ULZParallel::uncompress(pool, frame.data(), frame.length(), restored));
+        requireSame(restored, content);
+
+        if (level == ULZLevel::Default) {
+            defaultLength = stream.length();
+        }
+        else {
+            REQUIRE(stream.length() < defaultLength);
+        }
+    }
+    pool.shutdown();
+}
+
+TEST_CASE("ULZ matches of every distance and length round-trip", "[ulz]") {
+    ULZContext context;
+    const auto noise = makeStreamContent(4096, false);
+
+    // periodic runs make matches at the period distance, covering byte, eight and sixteen byte copies
+    for (size_t dist = 1; dist <= 40; ++dist) {
+        for (size_t run : { 4u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, 33u, 300u }) {
+            Array<uint8_t> content;
+            content.insert(0, noise.data(), 64);
+
+            for (size_t i = 0; i < run + dist; ++i) {
+                content.push(noise[100 + i % dist]);
+            }
+            content.insert(content.length(), noise.data() + 1000, 23);
+
+            for (auto level : { ULZLevel::Fast, ULZLevel::Default, ULZLevel::High }) {
+                const auto packed = compressWith(context, content, level);
+
+                Array<uint8_t> restored(content.length(), 0);
+                REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(content.length())) == static_cast<int32_t>(content.length()));
+                REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("ULZ matches ending at every offset within a word are found in full", "[ulz]") {
+    ULZContext context;
+    const auto noise = makeStreamContent(1024, false);
+
+    // second copy of the prefix differs right after length bytes, so the match is exactly length long
+    for (size_t length = 4; length <= 40; ++length) {
+        Array<uint8_t> content;
+        content.insert(0, noise.data(), 48);
+        content.insert(content.length(), noise.data(), length);
+        content.push(static_cast<uint8_t>(noise[length] ^ 0xff));
+        content.insert(content.length(), noise.data() + 500, 30);
+
+        const auto packed = compressWith(context, content);
+
+        // one match replaces the copy, literals are everything else
+        REQUIRE(packed.length() <= content.length() - length + 8);
+
+        Array<uint8_t> restored(content.length(), 0);
+        REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(content.length())) == static_cast<int32_t>(content.length()));
+        REQUIRE(memcmp(restored.data(), content.data(), content.length()) == 0);
+    }
+}
+
+TEST_CASE("ULZ uncompress never writes past exact-size output", "[ulz]") {
+    ULZContext context;
+    const auto text = makeStreamContent(5000, true);
+
+    for (size_t length : { 1u, 15u, 16u, 17u, 100u, 1000u, 4999u, 5000u }) {
+        Array<uint8_t> content;
+        content.insert(0, text.data(), length);
+
+        const auto packed = compressWith(context, content);
+
+        // guard bytes right after the output have to survive the copies with overshoot
+        Array<uint8_t> restored(length + 64, 0xcd);
+        REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), restored.data(), static_cast<int32_t>(length)) == static_cast<int32_t>(length));
+        REQUIRE(memcmp(restored.data(), content.data(), length) == 0);
+
+        for (size_t i = length; i < restored.length(); ++i) {
+            REQUIRE(restored[i] == 0xcd);
+        }
+
+        // too short output fails, and still nothing is written past it
+        const auto shorter = length / 2;
+        Array<uint8_t> truncated(length + 64, 0xcd);
+
+        REQUIRE(ULZContext::uncompress(packed.data(), static_cast<int32_t>(packed.length()), truncated.data(), static_cast<int32_t>(shorter)) == ULZ::UncompressFailure);
+
+        for (size_t i = shorter; i < truncated.length(); ++i) {
+            REQUIRE(truncated[i] == 0xcd);
+        }
+    }
+}
+
+TEST_CASE("ULZ parallel doesn't trust block lengths of crafted frames", "[ulz]") {
+    ThreadPool pool;
+
+    // a kilobyte of headers, each claiming a full block of 16 MB, but decoding to nothing
+    auto craft = [](bool withSize, uint64_t contentSize) {
+        Array<uint8_t> frame(detail::ULZFrame::kMaxHeaderSize, 0);
+        frame.resize(detail::ULZFrame::putHeader(frame.data(), withSize ? detail::ULZFrame::kContentSizeFlag : 0, detail::ULZFrame::kMaxBlockBits, contentSize));
+
+        for (size_t i = 0; i < 200; ++i) {
+            const uint8_t block[] = { 1, 0, 0, 0, 0xff };
+            frame.insert(frame.length(), block, sizeof(block));
+        }
+        const uint8_t end[] = { 0, 0, 0, 0 };
+        frame.insert(frame.length(), end, sizeof(end));
+
+        return frame;
+    };
+    Array<uint8_t> restored;
+
+    const auto unsized = craft(false, 0);
+    REQUIRE_FALSE(ULZParallel::uncompress(pool, unsized.data(), unsized.length(), restored));
+    REQUIRE(restored.capacity() <= (static_cast<size_t>(64) << 20));
+
+    const auto sized = craft(true, static_cast<uint64_t>(1) << 40);
+    REQUIRE_FALSE(ULZParallel::uncompress(pool, sized.data(), sized.length(), restored));
+}